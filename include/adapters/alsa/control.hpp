@@ -28,6 +28,7 @@ namespace alsa {
     bool wait(int timeout = -1);
     bool test_device_plugged();
     void process_events();
+    vector<int> get_poll_fds();
 
    private:
     int m_numid{0};
@@ -4,7 +4,6 @@
 #include <cstdlib>
 
 #include <arpa/inet.h>
-#include <ifaddrs.h>
 
 #include "common.hpp"
 #include "settings.hpp"
@@ -16,6 +15,7 @@
 #include <net/if.h>
 
 struct nl_msg;
+struct nl_sock;
 struct nlattr;
 #else
 #include <iwlib.h>
@@ -30,9 +30,12 @@ struct nlattr;
 #endif
 #endif
 
+struct nlmsghdr;
+
 POLYBAR_NS
 
 class file_descriptor;
+class sampled_file;
 
 namespace net {
   DEFINE_ERROR(network_error);
@@ -53,7 +56,7 @@ namespace net {
     }
   };
 
-  using bytes_t = unsigned int;
+  using bytes_t = unsigned long long;
 
   struct link_activity {
     bytes_t transmitted{0};
@@ -71,14 +74,25 @@ namespace net {
   // }}}
   // class : network {{{
 
+  /**
+   * Network interface
+   *
+   * The state and addresses of the interface are tracked with a route netlink
+   * socket. They are only queried again after the kernel announced a change,
+   * which is signaled by the file descriptor of the network. The traffic
+   * counters are read from sysfs with persistent file descriptors
+   */
   class network {
    public:
     explicit network(string interface);
-    virtual ~network() {}
+    virtual ~network();
 
     virtual bool query(bool accumulate = false);
     virtual bool connected() const = 0;
-    virtual bool ping() const;
+    virtual bool ping(const string& host, std::chrono::duration<double> timeout) const;
+
+    int get_file_descriptor() const;
+    bool process_events();
 
     string ip() const;
     string ip6() const;
@@ -88,17 +102,38 @@ namespace net {
 
    protected:
     void check_tuntap_or_bridge();
+    virtual bool resolve_index();
     bool test_interface() const;
     string format_speedrate(float bytes_diff, int minwidth) const;
-    void query_ip6();
+
+    bool request(int type, const void* payload, size_t size, bool dump);
+    void parse_link(const struct nlmsghdr* msg);
+    void parse_address(const struct nlmsghdr* msg);
 
     const logger& m_log;
     unique_ptr<file_descriptor> m_socketfd;
     link_status m_status{};
     string m_interface;
+    unsigned int m_ifindex{0};
     bool m_tuntap{false};
     bool m_bridge{false};
     bool m_unknown_up{false};
+
+    /**
+     * Route netlink sockets, one subscribed to changes and one for requests
+     */
+    unique_ptr<file_descriptor> m_eventfd;
+    unique_ptr<file_descriptor> m_requestfd;
+    unsigned int m_sequence{0};
+    vector<char> m_buffer;
+
+    bool m_linkchanged{true};
+    bool m_addrchanged{true};
+    unsigned char m_operstate{0};
+
+    shared_ptr<sampled_file> m_rxbytes;
+    shared_ptr<sampled_file> m_txbytes;
+    shared_ptr<sampled_file> m_netdev;
   };
 
   // }}}
@@ -121,9 +156,18 @@ namespace net {
 #if WITH_LIBNL
   // class : wireless_network {{{
 
+  /**
+   * Wireless interface
+   *
+   * Uses a persistent generic netlink session with nl80211. The access point
+   * is looked up in the scan results once and again after the kernel announced
+   * a (dis)connect or roam, in between only the station of the access point is
+   * queried for the signal strength
+   */
   class wireless_network : public network {
    public:
-    wireless_network(string interface) : network(interface), m_ifid(if_nametoindex(interface.c_str())){};
+    explicit wireless_network(string interface);
+    ~wireless_network() override;
 
     bool query(bool accumulate = false) override;
     bool connected() const override;
@@ -131,17 +175,39 @@ namespace net {
     int signal() const;
     int quality() const;
 
+    int get_nl80211_descriptor() const;
+    bool process_nl80211_events();
+
    protected:
     static int scan_cb(struct nl_msg* msg, void* instance);
+    static int station_cb(struct nl_msg* msg, void* instance);
+    static int event_cb(struct nl_msg* msg, void* instance);
+
+    bool open_sockets();
+    bool send_request(struct nl_msg* msg, int (*callback)(struct nl_msg*, void*));
+    bool resolve_index() override;
+    bool query_scan();
+    bool query_station();
 
     bool associated_or_joined(struct nlattr** bss);
     void parse_essid(struct nlattr** bss);
     void parse_frequency(struct nlattr** bss);
     void parse_quality(struct nlattr** bss);
     void parse_signal(struct nlattr** bss);
+    void set_signal(int dbm);
 
    private:
-    unsigned int m_ifid{};
+    struct nl_sock* m_nlsock{nullptr};
+    struct nl_sock* m_nlevents{nullptr};
+    int m_driverid{-1};
+
+    /**
+     * \brief Set once the access point has to be looked up in the scan results again
+     */
+    bool m_bsschanged{true};
+    bool m_eventchanged{false};
+
+    vector<unsigned char> m_bssid{};
     string m_essid{};
     int m_frequency{};
     quality_range m_signalstrength{};
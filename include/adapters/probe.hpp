@@ -0,0 +1,76 @@
+#pragma once
+
+#include <sys/socket.h>
+
+#include <chrono>
+
+#include "common.hpp"
+#include "errors.hpp"
+
+POLYBAR_NS
+
+class file_descriptor;
+
+namespace net {
+  DEFINE_ERROR(probe_error);
+
+  namespace chrono = std::chrono;
+
+  /**
+   * Non-blocking connectivity probe
+   *
+   * Sends ICMP echo requests over an unprivileged datagram socket or, if a
+   * port is given, checks if a TCP connection to the host can be established.
+   * The result is cached for the given time to live.
+   *
+   * The host has to be a numeric address, a name lookup would block
+   */
+  class probe {
+   public:
+    using duration_t = chrono::duration<double>;
+    using clock = chrono::steady_clock;
+
+    explicit probe(string host, unsigned short port, string interface, duration_t timeout, duration_t ttl);
+    ~probe();
+
+    bool start();
+    bool process();
+    void close();
+    void invalidate();
+
+    bool running() const;
+    bool online() const;
+    duration_t timeout() const;
+
+    int get_file_descriptor() const;
+    unsigned int get_events() const;
+
+   protected:
+    bool connect_to();
+    bool send_echo(int family);
+    bool receive_echo(int family);
+    void finish(bool online);
+
+   private:
+    string m_host;
+    unsigned short m_port;
+    string m_interface;
+    duration_t m_timeout;
+    duration_t m_ttl;
+
+    sockaddr_storage m_address{};
+    socklen_t m_addresslen{0};
+    int m_family{0};
+
+    unique_ptr<file_descriptor> m_fd;
+    unsigned short m_sequence{0};
+    clock::time_point m_deadline{};
+    bool m_pending{false};
+
+    bool m_online{false};
+    bool m_cached{false};
+    clock::time_point m_finished{};
+  };
+}  // namespace net
+
+POLYBAR_NS_END
@@ -35,6 +35,7 @@ class pulseaudio {
     const string& get_name();
 
     bool wait();
+    int get_event_fd() const;
     int process_events();
 
     int get_volume();
@@ -69,6 +70,7 @@ class pulseaudio {
     pa_threaded_mainloop* m_mainloop{nullptr};
 
     queue m_events;
+    int m_eventfd{-1};
 
     // specified sink name
     string spec_s_name;
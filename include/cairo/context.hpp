@@ -14,6 +14,7 @@
 #include "components/logger.hpp"
 #include "components/types.hpp"
 #include "errors.hpp"
+#include "utils/cache.hpp"
 #include "utils/color.hpp"
 #include "utils/string.hpp"
 
@@ -145,86 +146,37 @@ namespace cairo {
       double x, y;
       position(&x, &y);
 
-      // Prioritize the preferred font
-      vector<shared_ptr<font>> fns(m_fonts.begin(), m_fonts.end());
-
-      if (t.font > 0 && t.font <= std::distance(fns.begin(), fns.end())) {
-        std::iter_swap(fns.begin(), fns.begin() + t.font - 1);
+      // Most of the bar text doesn't change between redraws, so font fallback
+      // and shaping are only done the first time a text is drawn
+      auto key = make_pair(t.font, t.contents);
+      auto runs = m_textcache.find(key);
+      if (runs == nullptr) {
+        runs = &m_textcache.insert(key, shape(t));
       }
 
-      string utf8 = string(t.contents);
-      utils::unicode_charlist chars;
-      utils::utf8_to_ucs4((const unsigned char*)utf8.c_str(), chars);
-
-      while (!chars.empty()) {
-        auto remaining = chars.size();
-        for (auto&& f : fns) {
-          unsigned int matches = 0;
-
-          // Match as many glyphs as possible if the default/preferred font
-          // is being tested. Otherwise test one glyph at a time against
-          // the remaining fonts. Roll back to the top of the font list
-          // when a glyph has been found.
-          if (f == fns.front() && (matches = f->match(chars)) == 0) {
-            continue;
-          } else if (f != fns.front() && (matches = f->match(chars.front())) == 0) {
-            continue;
-          }
-
-          string subset;
-          auto end = chars.begin();
-          while (matches-- && end != chars.end()) {
-            subset += utf8.substr(end->offset, end->length);
-            end++;
-          }
-
-          // Use the font
-          f->use();
-
-          // Get subset extents
-          cairo_text_extents_t extents;
-          f->textwidth(subset, &extents);
-
-          // Draw the background
-          if (t.bg_rect.h != 0.0) {
-            save();
-            cairo_set_operator(m_c, t.bg_operator);
-            *this << t.bg;
-            cairo_rectangle(m_c, t.bg_rect.x + *t.x_advance, t.bg_rect.y + *t.y_advance,
-                t.bg_rect.w + extents.x_advance, t.bg_rect.h);
-            cairo_fill(m_c);
-            restore();
-          }
-
-          // Render subset
-          auto fontextents = f->extents();
-          f->render(subset, x, y - (fontextents.descent / 2 - fontextents.height / 4) + f->offset());
-
-          // Get updated position
-          position(&x, nullptr);
-
-          // Increase position
-          *t.x_advance += extents.x_advance;
-          *t.y_advance += extents.y_advance;
-
-          chars.erase(chars.begin(), end);
-          break;
+      for (auto&& run : *runs) {
+        run.face->use();
+
+        // Draw the background
+        if (t.bg_rect.h != 0.0) {
+          save();
+          cairo_set_operator(m_c, t.bg_operator);
+          *this << t.bg;
+          cairo_rectangle(m_c, t.bg_rect.x + *t.x_advance, t.bg_rect.y + *t.y_advance,
+              t.bg_rect.w + run.extents.x_advance, t.bg_rect.h);
+          cairo_fill(m_c);
+          restore();
         }
 
-        if (chars.empty()) {
-          break;
-        } else if (remaining != chars.size()) {
-          continue;
-        }
+        // Render run
+        run.face->render(run, x, y + run.y_offset);
 
-        char unicode[6]{'\0'};
-        utils::ucs4_to_utf8(unicode, chars.begin()->codepoint);
-        m_log.warn("Dropping unmatched character %s (U+%04x) in '%s'", unicode, chars.begin()->codepoint, t.contents);
-        utf8.erase(chars.begin()->offset, chars.begin()->length);
-        for (auto&& c : chars) {
-          c.offset -= chars.begin()->length;
-        }
-        chars.erase(chars.begin(), ++chars.begin());
+        // Get updated position
+        position(&x, nullptr);
+
+        // Increase position
+        *t.x_advance += run.extents.x_advance;
+        *t.y_advance += run.extents.y_advance;
       }
 
       return *this;
@@ -232,6 +184,7 @@ namespace cairo {
 
     context& operator<<(shared_ptr<font>&& f) {
       m_fonts.emplace_back(forward<decltype(f)>(f));
+      m_textcache.clear();
       return *this;
     }
 
@@ -347,12 +300,90 @@ namespace cairo {
       return *this;
     }
 
+   protected:
+    /**
+     * Split the text into runs of the fonts that contain its characters
+     *
+     * The preferred font is tested first, characters that it doesn't contain
+     * are looked up one at a time in the remaining fonts
+     */
+    vector<glyph_run> shape(const textblock& t) {
+      vector<glyph_run> runs;
+
+      // Prioritize the preferred font
+      vector<shared_ptr<font>> fns(m_fonts.begin(), m_fonts.end());
+
+      if (t.font > 0 && t.font <= std::distance(fns.begin(), fns.end())) {
+        std::iter_swap(fns.begin(), fns.begin() + t.font - 1);
+      }
+
+      const string& utf8 = t.contents;
+      utils::unicode_charlist chars;
+      utils::utf8_to_ucs4((const unsigned char*)utf8.c_str(), chars);
+
+      auto begin = chars.cbegin();
+
+      while (begin != chars.cend()) {
+        auto remaining = begin;
+        for (auto&& f : fns) {
+          size_t matches = 0;
+
+          // Match as many glyphs as possible if the default/preferred font
+          // is being tested. Otherwise test one glyph at a time against
+          // the remaining fonts. Roll back to the top of the font list
+          // when a glyph has been found.
+          if (f == fns.front() && (matches = f->match(begin, chars.cend())) == 0) {
+            continue;
+          } else if (f != fns.front() && (matches = f->match(*begin)) == 0) {
+            continue;
+          }
+
+          auto end = begin + matches;
+          auto last = end - 1;
+
+          runs.emplace_back();
+          runs.back().face = f;
+          f->shape(utf8.substr(begin->offset, last->offset + last->length - begin->offset), runs.back());
+
+          begin = end;
+          break;
+        }
+
+        if (begin == chars.cend()) {
+          break;
+        } else if (remaining != begin) {
+          continue;
+        }
+
+        char unicode[6]{'\0'};
+        utils::ucs4_to_utf8(unicode, begin->codepoint);
+        m_log.warn("Dropping unmatched character %s (U+%04x) in '%s'", unicode, begin->codepoint, t.contents);
+        begin++;
+      }
+
+      return runs;
+    }
+
+    /**
+     * \brief Hash of the font index and contents of a text block
+     */
+    struct textblock_hash {
+      size_t operator()(const pair<int, string>& key) const {
+        return std::hash<string>()(key.second) ^ std::hash<int>()(key.first);
+      }
+    };
+
    protected:
     cairo_t* m_c;
     const logger& m_log;
     vector<shared_ptr<font>> m_fonts;
     std::deque<pair<double, double>> m_points;
     int m_activegroups{0};
+
+    /**
+     * \brief Shaped runs of recently drawn text, keyed by preferred font and contents
+     */
+    lru_cache<vector<glyph_run>, pair<int, string>, textblock_hash> m_textcache{256};
   };
 }  // namespace cairo
 
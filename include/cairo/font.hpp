@@ -2,6 +2,9 @@
 
 #include <cairo/cairo-ft.h>
 
+#include <map>
+#include <mutex>
+
 #include "cairo/types.hpp"
 #include "cairo/utils.hpp"
 #include "common.hpp"
@@ -19,6 +22,28 @@ namespace cairo {
    */
   static FT_Library g_ftlib;
 
+  class font;
+
+  /**
+   * \brief Text shaped with a single font
+   *
+   * Glyph positions are relative to the origin of the run so that the run can
+   * be drawn again at any position without shaping the text again
+   */
+  struct glyph_run {
+    shared_ptr<font> face;
+    string utf8;
+    vector<cairo_glyph_t> glyphs;
+    vector<cairo_text_cluster_t> clusters;
+    cairo_text_cluster_flags_t cluster_flags;
+    // Extents of the whole text, including characters without glyphs
+    cairo_text_extents_t extents;
+    // Horizontal advance of the drawn glyphs
+    double advance;
+    // Vertical offset used to center the run on the baseline
+    double y_offset;
+  };
+
   /**
    * \brief Abstract font face
    */
@@ -38,10 +63,10 @@ namespace cairo {
       cairo_set_font_face(m_cairo, cairo_font_face_reference(m_font_face));
     }
 
-    virtual size_t match(utils::unicode_character& character) = 0;
-    virtual size_t match(utils::unicode_charlist& charlist) = 0;
-    virtual size_t render(const string& text, double x = 0.0, double y = 0.0) = 0;
-    virtual void textwidth(const string& text, cairo_text_extents_t* extents) = 0;
+    virtual size_t match(const utils::unicode_character& character) = 0;
+    virtual size_t match(utils::unicode_charlist::const_iterator begin, utils::unicode_charlist::const_iterator end) = 0;
+    virtual void shape(const string& text, glyph_run& run) = 0;
+    virtual void render(const glyph_run& run, double x = 0.0, double y = 0.0) = 0;
 
    protected:
     cairo_t* m_cairo;
@@ -50,12 +75,36 @@ namespace cairo {
     double m_offset{0.0};
   };
 
+  /**
+   * \brief Matched pattern and scaled font of a fontconfig font
+   *
+   * Shared by the fonts of all bars in the process that load the same font
+   * with the same dpi, see make_font()
+   */
+  struct font_fc_data {
+    ~font_fc_data() {
+      if (scaled != nullptr) {
+        cairo_scaled_font_destroy(scaled);
+      }
+      if (pattern != nullptr) {
+        FcPatternDestroy(pattern);
+      }
+    }
+
+    FcPattern* pattern{nullptr};
+    cairo_scaled_font_t* scaled{nullptr};
+    utils::unicode_coverage coverage;
+  };
+
   /**
    * \brief Font based on fontconfig/freetype
    */
   class font_fc : public font {
    public:
-    explicit font_fc(cairo_t* cairo, FcPattern* pattern, double offset, double dpi_x, double dpi_y) : font(cairo, offset), m_pattern(pattern) {
+    explicit font_fc(cairo_t* cairo, FcPattern* pattern, double offset, double dpi_x, double dpi_y)
+        : font(cairo, offset), m_data(make_shared<font_fc_data>()), m_pattern(pattern) {
+      m_data->pattern = pattern;
+
       cairo_matrix_t fm;
       cairo_matrix_t ctm;
       cairo_matrix_init_scale(&fm, size(dpi_x), size(dpi_y));
@@ -63,7 +112,7 @@ namespace cairo {
 
       auto fontface = cairo_ft_font_face_create_for_pattern(m_pattern);
       auto opts = cairo_font_options_create();
-      m_scaled = cairo_scaled_font_create(fontface, &fm, &ctm, opts);
+      m_data->scaled = m_scaled = cairo_scaled_font_create(fontface, &fm, &ctm, opts);
       cairo_font_options_destroy(opts);
       cairo_font_face_destroy(fontface);
 
@@ -75,24 +124,34 @@ namespace cairo {
       auto lock = make_unique<utils::ft_face_lock>(m_scaled);
       auto face = static_cast<FT_Face>(*lock);
 
-      if (FT_Select_Charmap(face, FT_ENCODING_UNICODE) == FT_Err_Ok) {
-        return;
-      } else if (FT_Select_Charmap(face, FT_ENCODING_BIG5) == FT_Err_Ok) {
-        return;
-      } else if (FT_Select_Charmap(face, FT_ENCODING_SJIS) == FT_Err_Ok) {
-        return;
+      if (FT_Select_Charmap(face, FT_ENCODING_UNICODE) != FT_Err_Ok &&
+          FT_Select_Charmap(face, FT_ENCODING_BIG5) != FT_Err_Ok) {
+        FT_Select_Charmap(face, FT_ENCODING_SJIS);
+      }
+
+      /*
+       * Look up the supported characters once, so that font fallback doesn't
+       * need to lock the face. Fall back to the charmap of the face if
+       * fontconfig doesn't provide the charset
+       */
+      FcCharSet* charset{nullptr};
+      if (FcPatternGetCharSet(m_pattern, FC_CHARSET, 0, &charset) == FcResultMatch && charset != nullptr) {
+        m_data->coverage.add(charset);
+      } else {
+        m_data->coverage.add(face);
       }
 
       lock.reset();
     }
 
-    ~font_fc() override {
-      if (m_scaled != nullptr) {
-        cairo_scaled_font_destroy(m_scaled);
-      }
-      if (m_pattern != nullptr) {
-        FcPatternDestroy(m_pattern);
-      }
+    /**
+     * Create a font for another cairo context from already loaded font data
+     */
+    explicit font_fc(cairo_t* cairo, shared_ptr<font_fc_data> data, double offset)
+        : font(cairo, offset), m_data(move(data)), m_scaled(m_data->scaled), m_pattern(m_data->pattern) {}
+
+    const shared_ptr<font_fc_data>& data() const {
+      return m_data;
     }
 
     cairo_font_extents_t extents() override {
@@ -187,36 +246,32 @@ namespace cairo {
       cairo_set_scaled_font(m_cairo, m_scaled);
     }
 
-    size_t match(utils::unicode_character& character) override {
-      auto lock = make_unique<utils::ft_face_lock>(m_scaled);
-      auto face = static_cast<FT_Face>(*lock);
-      return FT_Get_Char_Index(face, character.codepoint) ? 1 : 0;
+    size_t match(const utils::unicode_character& character) override {
+      return m_data->coverage.has(character.codepoint) ? 1 : 0;
     }
 
-    size_t match(utils::unicode_charlist& charlist) override {
-      auto lock = make_unique<utils::ft_face_lock>(m_scaled);
-      auto face = static_cast<FT_Face>(*lock);
+    size_t match(utils::unicode_charlist::const_iterator begin, utils::unicode_charlist::const_iterator end) override {
       size_t available_chars = 0;
-      for (auto&& c : charlist) {
-        if (FT_Get_Char_Index(face, c.codepoint)) {
-          available_chars++;
-        } else {
-          break;
-        }
+      for (; begin != end && m_data->coverage.has(begin->codepoint); begin++) {
+        available_chars++;
       }
 
       return available_chars;
     }
 
-    size_t render(const string& text, double x = 0.0, double y = 0.0) override {
+    /**
+     * Convert the text into glyphs
+     *
+     * Only the glyphs up to the first character missing in this font are kept,
+     * the extents cover the whole text
+     */
+    void shape(const string& text, glyph_run& run) override {
       cairo_glyph_t* glyphs{nullptr};
       cairo_text_cluster_t* clusters{nullptr};
-      cairo_text_cluster_flags_t cf{};
       int nglyphs = 0, nclusters = 0;
 
-      string utf8 = string(text);
-      auto status = cairo_scaled_font_text_to_glyphs(
-          m_scaled, x, y, utf8.c_str(), utf8.size(), &glyphs, &nglyphs, &clusters, &nclusters, &cf);
+      auto status = cairo_scaled_font_text_to_glyphs(m_scaled, 0.0, 0.0, text.c_str(), text.size(), &glyphs, &nglyphs,
+          &clusters, &nclusters, &run.cluster_flags);
 
       if (status != CAIRO_STATUS_SUCCESS) {
         throw application_error(sstream() << "cairo_scaled_font_text_to_glyphs()" << cairo_status_to_string(status));
@@ -235,36 +290,51 @@ namespace cairo {
         cairo_glyph_free(glyphs);
         cairo_text_cluster_free(clusters);
 
-        utf8 = text.substr(0, bytes);
-        auto status = cairo_scaled_font_text_to_glyphs(
-            m_scaled, x, y, utf8.c_str(), utf8.size(), &glyphs, &nglyphs, &clusters, &nclusters, &cf);
+        status = cairo_scaled_font_text_to_glyphs(m_scaled, 0.0, 0.0, text.c_str(), bytes, &glyphs, &nglyphs, &clusters,
+            &nclusters, &run.cluster_flags);
 
         if (status != CAIRO_STATUS_SUCCESS) {
           throw application_error(sstream() << "cairo_scaled_font_text_to_glyphs()" << cairo_status_to_string(status));
         }
       }
 
+      run.utf8 = text.substr(0, bytes);
+      run.glyphs.clear();
+      run.clusters.clear();
+      run.advance = 0.0;
+
       if (bytes) {
-        // auto lock = make_unique<utils::device_lock>(cairo_surface_get_device(cairo_get_target(m_cairo)));
-        // if (lock.get()) {
-        //   cairo_glyph_path(m_cairo, glyphs, nglyphs);
-        // }
-
-        cairo_text_extents_t extents{};
-        cairo_scaled_font_glyph_extents(m_scaled, glyphs, nglyphs, &extents);
-        cairo_show_text_glyphs(m_cairo, utf8.c_str(), utf8.size(), glyphs, nglyphs, clusters, nclusters, cf);
-        cairo_fill(m_cairo);
-        cairo_move_to(m_cairo, x + extents.x_advance, 0.0);
+        cairo_text_extents_t glyph_extents{};
+        cairo_scaled_font_glyph_extents(m_scaled, glyphs, nglyphs, &glyph_extents);
+        run.glyphs.assign(glyphs, glyphs + nglyphs);
+        run.clusters.assign(clusters, clusters + nclusters);
+        run.advance = glyph_extents.x_advance;
       }
 
       cairo_glyph_free(glyphs);
       cairo_text_cluster_free(clusters);
 
-      return bytes;
+      auto fontextents = extents();
+      cairo_scaled_font_text_extents(m_scaled, text.c_str(), &run.extents);
+      run.y_offset = m_offset - (fontextents.descent / 2 - fontextents.height / 4);
     }
 
-    void textwidth(const string& text, cairo_text_extents_t* extents) override {
-      cairo_scaled_font_text_extents(m_scaled, text.c_str(), extents);
+    void render(const glyph_run& run, double x = 0.0, double y = 0.0) override {
+      if (run.glyphs.empty()) {
+        return;
+      }
+
+      // Move the glyphs to the target position, reusing the buffer between calls
+      m_glyphs.assign(run.glyphs.begin(), run.glyphs.end());
+      for (auto&& glyph : m_glyphs) {
+        glyph.x += x;
+        glyph.y += y;
+      }
+
+      cairo_show_text_glyphs(m_cairo, run.utf8.c_str(), run.utf8.size(), m_glyphs.data(), m_glyphs.size(),
+          run.clusters.data(), run.clusters.size(), run.cluster_flags);
+      cairo_fill(m_cairo);
+      cairo_move_to(m_cairo, x + run.advance, 0.0);
     }
 
    protected:
@@ -292,14 +362,32 @@ namespace cairo {
     }
 
    private:
+    shared_ptr<font_fc_data> m_data;
     cairo_scaled_font_t* m_scaled{nullptr};
     FcPattern* m_pattern{nullptr};
+    vector<cairo_glyph_t> m_glyphs;
   };
 
   /**
    * Match and create font from given fontconfig pattern
+   *
+   * The matched font is cached, other bars of the process loading the same
+   * font with the same dpi and transformation reuse it
    */
   inline decltype(auto) make_font(cairo_t* cairo, string&& fontname, double offset, double dpi_x, double dpi_y) {
+    static std::mutex cache_lock;
+    static std::map<string, std::weak_ptr<font_fc_data>> cache;
+    std::lock_guard<std::mutex> guard(cache_lock);
+
+    cairo_matrix_t ctm;
+    cairo_get_matrix(cairo, &ctm);
+    string key{sstream() << fontname << ';' << dpi_x << ';' << dpi_y << ';' << ctm.xx << ';' << ctm.yx << ';' << ctm.xy
+                         << ';' << ctm.yy};
+
+    if (auto data = cache[key].lock()) {
+      return make_shared<font_fc>(cairo, move(data), offset);
+    }
+
     static bool fc_init{false};
     if (!fc_init && !(fc_init = FcInit())) {
       throw application_error("Could not load fontconfig");
@@ -334,7 +422,9 @@ namespace cairo {
     FcPatternPrint(match);
 #endif
 
-    return make_shared<font_fc>(cairo, match, offset, dpi_x, dpi_y);
+    auto font = make_shared<font_fc>(cairo, match, offset, dpi_x, dpi_y);
+    cache[key] = font->data();
+    return font;
   }
 }
 
@@ -1,7 +1,8 @@
 #pragma once
 
 #include <cairo/cairo-ft.h>
-#include <list>
+#include <array>
+#include <bitset>
 
 #include "common.hpp"
 
@@ -48,7 +49,33 @@ namespace cairo {
       int offset;
       int length;
     };
-    using unicode_charlist = std::list<unicode_character>;
+    using unicode_charlist = vector<unicode_character>;
+
+    /**
+     * \brief Set of codepoints supported by a font
+     *
+     * Stores one bitset per unicode plane, planes without any supported
+     * codepoint are not allocated
+     */
+    class unicode_coverage {
+     public:
+      static constexpr unsigned long PLANE_SIZE{0x10000};
+      static constexpr unsigned long PLANE_COUNT{17};
+
+      void add(unsigned long codepoint);
+      void add(const FcCharSet* charset);
+      void add(FT_Face face);
+
+      bool has(unsigned long codepoint) const {
+        auto plane = codepoint / PLANE_SIZE;
+        return plane < PLANE_COUNT && m_planes[plane] && m_planes[plane]->test(codepoint % PLANE_SIZE);
+      }
+
+      bool empty() const;
+
+     private:
+      array<unique_ptr<std::bitset<PLANE_SIZE>>, PLANE_COUNT> m_planes;
+    };
 
     /**
      * \see <cairo/cairo.h>
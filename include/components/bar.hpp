@@ -5,6 +5,7 @@
 #include <mutex>
 
 #include "common.hpp"
+#include "components/display_list.hpp"
 #include "components/types.hpp"
 #include "errors.hpp"
 #include "events/signal_fwd.hpp"
@@ -17,10 +18,10 @@
 POLYBAR_NS
 
 // fwd {{{
+class background_manager;
 class config;
 class connection;
 class logger;
-class parser;
 class renderer;
 class screen;
 class taskqueue;
@@ -58,15 +59,17 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
 		> {
  public:
   using make_type = unique_ptr<bar>;
-  static make_type make(bool only_initialize_values = false);
+  static make_type make(
+      connection& conn, signal_emitter& emitter, const config& conf, bool only_initialize_values = false);
 
-  explicit bar(connection&, signal_emitter&, const config&, const logger&, unique_ptr<screen>&&,
-      unique_ptr<tray_manager>&&, unique_ptr<parser>&&, unique_ptr<taskqueue>&&, bool only_initialize_values);
+  explicit bar(connection&, signal_emitter&, const config&, const logger&, unique_ptr<background_manager>&&,
+      unique_ptr<screen>&&, unique_ptr<tray_manager>&&, unique_ptr<taskqueue>&&, bool only_initialize_values);
   ~bar();
 
   const bar_settings settings() const;
 
-  void parse(string&& data, bool force = false);
+  void draw(display_list&& contents, bool force = false);
+  void draw(vector<bar_segment>&& segments, bool force = false);
 
   void hide();
   void show();
@@ -80,6 +83,9 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
   void reconfigure_struts();
   void reconfigure_wm_hints();
   void broadcast_visibility();
+  xcb_rectangle_t content_area() const;
+  bool skip_update(bool force, bool unchanged) const;
+  bool has_dblclick_actions() const;
 
   void handle(const evt::client_message& evt);
   void handle(const evt::destroy_notify& evt);
@@ -105,15 +111,16 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
   signal_emitter& m_sig;
   const config& m_conf;
   const logger& m_log;
+  unique_ptr<background_manager> m_background;
   unique_ptr<screen> m_screen;
   unique_ptr<tray_manager> m_tray;
   unique_ptr<renderer> m_renderer;
-  unique_ptr<parser> m_parser;
   unique_ptr<taskqueue> m_taskqueue;
 
   bar_settings m_opts{};
 
-  string m_lastinput{};
+  display_list m_lastinput{};
+  vector<bar_segment> m_lastsegments{};
   std::mutex m_mutex{};
   std::atomic<bool> m_dblclicks{false};
 
@@ -3,6 +3,8 @@
 #include <map>
 
 #include "common.hpp"
+#include "components/display_list.hpp"
+#include "components/parser.hpp"
 #include "components/types.hpp"
 
 POLYBAR_NS
@@ -17,9 +19,11 @@ class builder {
   explicit builder(const bar_settings& bar);
 
   void reset();
-  string flush();
+  display_list flush();
   void append(string text);
+  void append(const display_list& list);
   void node(string str);
+  void node(const display_list& list);
   void node(string str, int font_index);
   void node(const label_t& label);
   void node_repeat(const string& str, size_t n);
@@ -55,14 +59,15 @@ class builder {
   string background_hex();
   string foreground_hex();
 
-  void tag_open(syntaxtag tag, const string& value);
+  void tag_open(syntaxtag tag);
   void tag_open(attribute attr);
   void tag_close(syntaxtag tag);
   void tag_close(attribute attr);
 
  private:
   const bar_settings m_bar;
-  string m_output;
+  display_list m_output;
+  parser m_parser;
 
   map<syntaxtag, int> m_tags{};
   map<syntaxtag, string> m_colors{};
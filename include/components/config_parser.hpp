@@ -101,6 +101,12 @@ class config_parser {
    */
   config::make_type parse();
 
+  /**
+   * \brief Same as parse() but populates the given instance instead of the
+   *        process wide one, so that every bar can have a config of its own
+   */
+  void parse(config& result);
+
  protected:
   /**
    * \brief Converts the `lines` vector to a proper sectionmap
@@ -5,6 +5,7 @@
 #include <thread>
 
 #include "common.hpp"
+#include "components/display_list.hpp"
 #include "components/types.hpp"
 #include "events/signal_fwd.hpp"
 #include "events/signal_receiver.hpp"
@@ -34,22 +35,30 @@ namespace modules {
 using module_t = shared_ptr<modules::module_interface>;
 using modulemap_t = std::map<alignment, vector<module_t>>;
 
+/**
+ * Modules of all bars hosted in the process, keyed by controller::module_key()
+ */
+using module_registry = std::map<string, module_t>;
+
 // }}}
 
 class controller
     : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eventqueue::exit_terminate,
           signals::eventqueue::exit_reload, signals::eventqueue::notify_change, signals::eventqueue::notify_forcechange,
           signals::eventqueue::check_state, signals::ipc::action, signals::ipc::command, signals::ipc::hook,
-          signals::ui::ready, signals::ui::button_press, signals::ui::update_background> {
+          signals::ipc::stats, signals::ui::ready, signals::ui::button_press, signals::ui::update_background> {
  public:
   using make_type = unique_ptr<controller>;
-  static make_type make(unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch);
+  static make_type make(connection& conn, signal_emitter& emitter, const config& conf, shared_ptr<ipc> ipc,
+      unique_ptr<inotify_watch>&& config_watch, module_registry* registry = nullptr);
 
-  explicit controller(connection&, signal_emitter&, const logger&, const config&, unique_ptr<bar>&&, unique_ptr<ipc>&&,
-      unique_ptr<inotify_watch>&&);
+  explicit controller(connection&, signal_emitter&, const logger&, const config&, unique_ptr<bar>&&, shared_ptr<ipc>,
+      unique_ptr<inotify_watch>&&, module_registry*);
   ~controller();
 
   bool run(bool writeback, string snapshot_dst);
+  void start(bool writeback, string snapshot_dst);
+  void stop();
 
   bool enqueue(event&& evt);
   bool enqueue(string&& input_data);
@@ -59,6 +68,7 @@ class controller
   void process_eventqueue();
   void process_inputdata();
   bool process_update(bool force);
+  string stats_snapshot() const;
 
   bool on(const signals::eventqueue::notify_change& evt);
   bool on(const signals::eventqueue::notify_forcechange& evt);
@@ -70,17 +80,26 @@ class controller
   bool on(const signals::ipc::action& evt);
   bool on(const signals::ipc::command& evt);
   bool on(const signals::ipc::hook& evt);
+  bool on(const signals::ipc::stats& evt);
   bool on(const signals::ui::update_background& evt);
 
  private:
   size_t setup_modules(alignment align);
+  string module_key(const string& type, const string& module_name) const;
+  vector<module_t> bar_modules() const;
 
   connection& m_connection;
   signal_emitter& m_sig;
+
+  /**
+   * \brief Process wide emitter the modules, the ticker and ipc report to
+   */
+  signal_emitter& m_modsig;
+
   const logger& m_log;
   const config& m_conf;
   unique_ptr<bar> m_bar;
-  unique_ptr<ipc> m_ipc;
+  shared_ptr<ipc> m_ipc;
   unique_ptr<inotify_watch> m_confwatch;
   unique_ptr<command<output_policy::IGNORED>> m_command;
 
@@ -107,29 +126,75 @@ class controller
   moodycamel::BlockingConcurrentQueue<event> m_queue;
 
   /**
-   * \brief Loaded modules
+   * \brief Modules created by this bar, the bar starts and stops them
    */
   vector<module_t> m_modules;
 
   /**
-   * \brief Loaded modules grouped by block
+   * \brief Modules shown by this bar grouped by block, including the ones shared with other bars
    */
   modulemap_t m_blocks;
 
+  /**
+   * \brief Modules of all bars in the process, null if the bar is the only one
+   */
+  module_registry* m_registry{nullptr};
+
   /**
    * \brief Module input handlers
    */
   vector<modules::input_handler*> m_inputhandlers;
 
   /**
-   * \brief Maximum number of subsequent events to swallow
+   * \brief Separator placed between modules
+   */
+  display_list m_separator;
+
+  /**
+   * \brief Minimum time between two redraws
+   */
+  std::chrono::milliseconds m_frame_interval{16};
+
+  /**
+   * \brief Maximum time an update waits for its frame
+   */
+  std::chrono::milliseconds m_frame_latency{16};
+
+  /**
+   * \brief Time of the last redraw
+   */
+  std::chrono::steady_clock::time_point m_lastframe;
+
+  /**
+   * \brief Number of drawn frames
+   */
+  std::atomic<uint64_t> m_frames{0};
+
+  /**
+   * \brief Time spent collecting the module output, in nanoseconds
+   */
+  std::atomic<uint64_t> m_buildtime{0};
+
+  /**
+   * \brief Time spent drawing the bar, in nanoseconds
+   */
+  std::atomic<uint64_t> m_rendertime{0};
+
+  /**
+   * \brief Build and render time of the last frame, in nanoseconds
    */
-  size_t m_swallow_limit{5U};
+  std::atomic<uint64_t> m_lastbuildtime{0};
+  std::atomic<uint64_t> m_lastrendertime{0};
 
   /**
-   * \brief Time to wait for subsequent events
+   * \brief Frames per second, measured over windows of at least a second
+   *
+   * The window start is stored in nanoseconds of the steady clock so that
+   * stats_snapshot() can read it from the ipc thread
    */
-  std::chrono::milliseconds m_swallow_update{10};
+  std::atomic<double> m_fps{0.0};
+  std::atomic<int64_t> m_fpswindow{0};
+  std::atomic<uint64_t> m_fpsframes{0};
 
   /**
    * \brief Time to throttle input events
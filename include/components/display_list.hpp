@@ -0,0 +1,114 @@
+#pragma once
+
+#include "common.hpp"
+#include "components/types.hpp"
+
+POLYBAR_NS
+
+/**
+ * Operations that can be stored in a display list
+ *
+ * Each operation corresponds to one of the formatting tags (%{...})
+ */
+enum class display_op : unsigned char {
+  TEXT = 0,
+  BACKGROUND,        // %{B}
+  FOREGROUND,        // %{F}
+  UNDERLINE,         // %{u}
+  OVERLINE,          // %{o}
+  FONT,              // %{T}
+  ALIGNMENT,         // %{l}, %{c}, %{r}
+  REVERSE,           // %{R}
+  OFFSET,            // %{O}
+  ATTRIBUTE_SET,     // %{+u}, %{+o}
+  ATTRIBUTE_UNSET,   // %{-u}, %{-o}
+  ATTRIBUTE_TOGGLE,  // %{!u}, %{!o}
+  ACTION_BEGIN,      // %{A1:...:}
+  ACTION_END,        // %{A}
+  CONTROL,           // %{P...}
+};
+
+/**
+ * Single display list operation
+ *
+ * value holds the color, font index or pixel offset of the operation, or the
+ * underlying value of the alignment, attribute, mouse button or control tag.
+ * Text runs and action commands are stored in the string pool of the list
+ * and referenced by pos and len.
+ *
+ * reset is set for color and font operations that restore the bar default
+ * (%{F-}), value then holds the default
+ */
+struct display_item {
+  display_op op;
+  bool reset;
+  unsigned int value;
+  size_t pos;
+  size_t len;
+
+  bool operator==(const display_item& other) const {
+    return op == other.op && reset == other.reset && value == other.value && pos == other.pos && len == other.len;
+  }
+};
+
+/**
+ * Formatted bar contents in the form the renderer consumes them
+ *
+ * The builder writes into display lists directly, the formatting tag syntax
+ * is only parsed for raw strings (e.g. format definitions and script output)
+ * and only produced again for --stdout
+ */
+class display_list {
+ public:
+  using const_iterator = vector<display_item>::const_iterator;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+  size_t size() const;
+  bool empty() const;
+  void clear();
+
+  string str(const display_item& item) const;
+
+  void text(const string& text);
+  void text(size_t count, char c);
+  void color(display_op op, unsigned int color, bool reset = false);
+  void font(int index, bool reset = false);
+  void align(alignment align);
+  void reverse();
+  void offset(int pixels);
+  void attr(display_op op, attribute attr);
+  void action_begin(mousebtn btn, const string& command);
+  void action_end(mousebtn btn = mousebtn::NONE);
+  void control(controltag tag);
+
+  bool remove_trailing(size_t count, char c);
+
+  string to_string() const;
+
+  display_list& operator+=(const display_list& other);
+  bool operator==(const display_list& other) const;
+  bool operator!=(const display_list& other) const;
+
+ protected:
+  void push(display_op op, unsigned int value = 0U, bool reset = false);
+
+ private:
+  vector<display_item> m_items;
+  string m_strings;
+};
+
+/**
+ * Output of a single module, including the separator and margins preceding
+ * it, used when only the changed parts of the bar are redrawn
+ */
+struct bar_segment {
+  alignment align{alignment::NONE};
+  display_list contents{};
+
+  bool operator==(const bar_segment& other) const {
+    return align == other.align && contents == other.contents;
+  }
+};
+
+POLYBAR_NS_END
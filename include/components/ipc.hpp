@@ -6,7 +6,7 @@
 
 POLYBAR_NS
 
-class file_descriptor;
+class config;
 class logger;
 class signal_emitter;
 
@@ -16,31 +16,84 @@ class signal_emitter;
 static constexpr const char* ipc_command_prefix{"cmd:"};
 static constexpr const char* ipc_hook_prefix{"hook:"};
 static constexpr const char* ipc_action_prefix{"action:"};
+static constexpr const char* ipc_stats_prefix{"stats:"};
+
+/**
+ * Prefix of the optional first line of a request, only the bar with the given name handles it
+ */
+static constexpr const char* ipc_bar_prefix{"bar:"};
+
+/**
+ * Replies
+ */
+static constexpr const char* ipc_reply_ok{"ok"};
+static constexpr const char* ipc_reply_error{"error"};
+static constexpr const char* ipc_reply_skip{"skip"};
+
+/**
+ * Maximum size of a request or reply packet
+ */
+static constexpr size_t ipc_max_packet_size{65536};
+
+/**
+ * Payload of the stats message
+ *
+ * The snapshot is written to the path or, without a path, sent back to the client
+ */
+struct ipc_stats_request {
+  string path;
+  string snapshot;
+};
 
 /**
  * Component used for inter-process communication.
  *
- * A unique messaging channel will be setup for each
- * running process which will allow messages and
- * events to be sent to the process externally.
+ * Each running process listens on a SOCK_SEQPACKET unix socket. Every packet
+ * sent by a client is a request made of one or more newline separated
+ * messages, which are handled in order. The reply packet contains one line
+ * per message: "ok", "ok:<data>" or "error:<reason>". A request whose first
+ * line addresses another bar is answered with a single "skip" line.
+ *
+ * A process hosting several bars registers them with add_bar(). Commands then
+ * go to the addressed bar or to all of them, actions and stats to the
+ * addressed or the first bar. Hooks always go to the process wide emitter,
+ * since the modules are shared by the bars.
  */
 class ipc {
  public:
   using make_type = unique_ptr<ipc>;
-  static make_type make();
+  static make_type make(const config& conf);
 
-  explicit ipc(signal_emitter& emitter, const logger& logger);
+  explicit ipc(signal_emitter& emitter, const logger& logger, string bar_name, string path);
   ~ipc();
 
+  void add_bar(string name, signal_emitter& emitter);
+
   void receive_message();
   int get_file_descriptor() const;
 
+ protected:
+  void accept_clients();
+  bool receive_requests(int fd);
+  void close_client(int fd);
+  string handle_request(const string& request);
+  string handle_message(const string& message, signal_emitter* bar);
+
  private:
   signal_emitter& m_sig;
   const logger& m_log;
 
-  string m_path{};
-  unique_ptr<file_descriptor> m_fd;
+  string m_barname;
+
+  /**
+   * \brief Emitters of the bars hosted in the process, in the order they were added
+   */
+  vector<pair<string, signal_emitter*>> m_bars;
+
+  string m_path;
+  int m_socketfd{-1};
+  int m_epollfd{-1};
+  vector<int> m_clients;
 };
 
 POLYBAR_NS_END
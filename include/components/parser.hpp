@@ -5,7 +5,7 @@
 
 POLYBAR_NS
 
-class signal_emitter;
+class display_list;
 enum class attribute;
 enum class controltag;
 enum class mousebtn;
@@ -14,32 +14,31 @@ struct bar_settings;
 DEFINE_ERROR(parser_error);
 DEFINE_CHILD_ERROR(unrecognized_token, parser_error);
 DEFINE_CHILD_ERROR(unrecognized_attribute, parser_error);
-DEFINE_CHILD_ERROR(unclosed_actionblocks, parser_error);
 
+/**
+ * Translates the formatting tag syntax into display list operations
+ */
 class parser {
  public:
   using make_type = unique_ptr<parser>;
   static make_type make();
 
  public:
-  explicit parser(signal_emitter& emitter);
-  void parse(const bar_settings& bar, string data);
+  void parse(const bar_settings& bar, const string& data, display_list& output);
 
  protected:
-  void codeblock(string&& data, const bar_settings& bar);
-  size_t text(string&& data);
+  void codeblock(const string& data, size_t pos, size_t end, const bar_settings& bar, display_list& output);
 
+  static bool is_reset(const string& s);
   static unsigned int parse_color(const string& s, unsigned int fallback = 0);
   static int parse_fontindex(const string& s);
   static attribute parse_attr(const char attr);
-  mousebtn parse_action_btn(const string& data);
-  static string parse_action_cmd(string&& data);
+  mousebtn parse_action_btn(const char btn);
+  static string parse_action_cmd(const string& data, size_t pos = 0, size_t end = string::npos);
   static controltag parse_control(const string& data);
 
  private:
-  signal_emitter& m_sig;
   vector<int> m_actions;
-  unique_ptr<parser> m_parser;
 };
 
 POLYBAR_NS_END
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <sys/epoll.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "common.hpp"
+#include "errors.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+using namespace std::chrono_literals;
+
+// fwd
+class logger;
+
+DEFINE_ERROR(reactor_error);
+
+/**
+ * Event loop running callbacks on a fixed pool of worker threads
+ *
+ * Callbacks are attached to file descriptors or timers. A single thread
+ * waits for all of them using epoll and hands the ready callbacks to the
+ * workers. The callback of a source never runs concurrently with itself, so
+ * a module can use a source the same way it used its own thread.
+ *
+ * Sources whose callbacks may block for long (e.g. network requests) are
+ * marked with set_blocking(). They run on a separate set of threads that
+ * grows on demand, so they can't hold up the shared workers.
+ */
+class reactor : non_copyable_mixin<reactor> {
+ public:
+  using make_type = reactor&;
+  static make_type make();
+
+  using handle_t = size_t;
+  using callback_t = function<void()>;
+  using duration_t = chrono::duration<double>;
+
+  explicit reactor(const logger& logger, size_t workers);
+  ~reactor();
+
+  handle_t add_fd(int fd, callback_t&& callback, unsigned int events = EPOLLIN);
+  handle_t add_timer(duration_t timeout, duration_t interval, callback_t&& callback);
+  handle_t add_aligned_timer(duration_t interval, callback_t&& callback);
+  void set_timer(handle_t handle, duration_t timeout, duration_t interval = duration_t::zero());
+  void set_blocking(handle_t handle, bool blocking = true);
+  void trigger(handle_t handle);
+  void remove(handle_t handle);
+
+  static handle_t current();
+
+ protected:
+  struct source {
+    int fd{-1};
+    bool timer{false};
+    duration_t aligned{0};
+    unsigned int events{0};
+    callback_t callback{};
+    bool blocking{false};
+    bool queued{false};
+    bool running{false};
+    bool pending{false};
+    bool removed{false};
+  };
+
+  handle_t add(int fd, bool timer, unsigned int events, callback_t&& callback,
+      duration_t aligned = duration_t::zero());
+  void align(int fd, duration_t interval);
+  void arm(handle_t handle, const source& src);
+  void enqueue(handle_t handle, source& src);
+
+  void poll();
+  void work(bool blocking);
+
+ private:
+  const logger& m_log;
+
+  int m_epollfd{-1};
+  int m_wakeupfd{-1};
+  bool m_running{true};
+
+  std::mutex m_lock;
+  std::condition_variable m_queued;
+  std::condition_variable m_finished;
+
+  handle_t m_nexthandle{1};
+  std::map<handle_t, source> m_sources;
+  std::deque<handle_t> m_queue;
+
+  std::thread m_pollthread;
+  vector<std::thread> m_workers;
+
+  /**
+   * \brief Queue of the blocking sources and the threads that run them
+   */
+  std::deque<handle_t> m_blockingqueue;
+  std::condition_variable m_blockingqueued;
+  vector<std::thread> m_blockingworkers;
+  size_t m_idleblocking{0};
+};
+
+POLYBAR_NS_END
@@ -6,6 +6,7 @@
 
 #include "cairo/fwd.hpp"
 #include "common.hpp"
+#include "components/display_list.hpp"
 #include "components/types.hpp"
 #include "events/signal_fwd.hpp"
 #include "events/signal_receiver.hpp"
@@ -30,16 +31,25 @@ struct alignment_block {
   double y;
 };
 
-class renderer
-    : public signal_receiver<SIGN_PRIORITY_RENDERER, signals::ui::request_snapshot, signals::parser::change_background,
-          signals::parser::change_foreground, signals::parser::change_underline, signals::parser::change_overline,
-          signals::parser::change_font, signals::parser::change_alignment, signals::parser::reverse_colors,
-          signals::parser::offset_pixel, signals::parser::attribute_set, signals::parser::attribute_unset,
-          signals::parser::attribute_toggle, signals::parser::action_begin, signals::parser::action_end,
-          signals::parser::text, signals::parser::control> {
+/**
+ * Cached rendering of a single bar segment
+ *
+ * The position and the action blocks are relative to the start of the
+ * alignment block
+ */
+struct segment_block {
+  display_list contents{};
+  cairo_pattern_t* pattern{nullptr};
+  double x{0.0};
+  double w{0.0};
+  vector<action_block> actions{};
+};
+
+class renderer : public signal_receiver<SIGN_PRIORITY_RENDERER, signals::ui::request_snapshot> {
  public:
   using make_type = unique_ptr<renderer>;
-  static make_type make(const bar_settings& bar);
+  static make_type make(connection& conn, signal_emitter& sig, const config& conf, const bar_settings& bar,
+      background_manager& background_manager);
 
   explicit renderer(connection& conn, signal_emitter& sig, const config&, const logger& logger, const bar_settings& bar,
       background_manager& background_manager);
@@ -48,10 +58,14 @@ class renderer
   xcb_window_t window() const;
   const vector<action_block> actions() const;
 
-  void begin(xcb_rectangle_t rect);
+  void begin(xcb_rectangle_t rect, bool incremental = false);
+  void render(const display_list& list);
   void end();
   void flush();
 
+  bool begin_segment(alignment a, const display_list& contents);
+  bool end_segment();
+
 #if 0
   void reserve_space(edge side, unsigned int w);
 #endif
@@ -70,22 +84,26 @@ class renderer
   void flush(alignment a);
   void highlight_clickable_areas();
 
+  void paint_segment(const segment_block& segment);
+  void damage(alignment a, double x1, double x2);
+  void clear_segments();
+
+  void change_background(unsigned int color);
+  void change_foreground(unsigned int color);
+  void change_underline(unsigned int color);
+  void change_overline(unsigned int color);
+  void change_font(int font);
+  void change_alignment(alignment align);
+  void reverse_colors();
+  void offset_pixel(int pixels);
+  void attribute_set(attribute attr);
+  void attribute_unset(attribute attr);
+  void attribute_toggle(attribute attr);
+  void action_begin(mousebtn btn, string&& command);
+  void action_end(mousebtn btn);
+  void control(controltag tag);
+
   bool on(const signals::ui::request_snapshot& evt);
-  bool on(const signals::parser::change_background& evt);
-  bool on(const signals::parser::change_foreground& evt);
-  bool on(const signals::parser::change_underline& evt);
-  bool on(const signals::parser::change_overline& evt);
-  bool on(const signals::parser::change_font& evt);
-  bool on(const signals::parser::change_alignment& evt);
-  bool on(const signals::parser::reverse_colors&);
-  bool on(const signals::parser::offset_pixel& evt);
-  bool on(const signals::parser::attribute_set& evt);
-  bool on(const signals::parser::attribute_unset& evt);
-  bool on(const signals::parser::attribute_toggle& evt);
-  bool on(const signals::parser::action_begin& evt);
-  bool on(const signals::parser::action_end& evt);
-  bool on(const signals::parser::text& evt);
-  bool on(const signals::parser::control& evt);
 
  protected:
   struct reserve_area {
@@ -136,6 +154,29 @@ class renderer
 
   bool m_fixedcenter;
   string m_snapshot_dst;
+
+  map<alignment, vector<segment_block>> m_segments;
+  segment_block* m_segment{nullptr};
+  map<alignment, size_t> m_segmentcount;
+  size_t m_segment_actions{0U};
+  bool m_segment_escaped{false};
+  bool m_segmented{false};
+  bool m_incremental{false};
+
+  /**
+   * \brief Damaged range of each alignment block, relative to the block
+   */
+  map<alignment, pair<double, double>> m_damage;
+
+  /**
+   * \brief Block widths of the previous frame
+   */
+  map<alignment, double> m_blockwidths;
+
+  /**
+   * \brief Area of the pixmap that will be copied onto the window
+   */
+  xcb_rectangle_t m_flusharea{0, 0, 0U, 0U};
 };
 
 POLYBAR_NS_END
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+
+#include "common.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+/**
+ * Immutable copy of the contents of a sampled file
+ */
+struct sample {
+  chrono::steady_clock::time_point time{};
+  string data{};
+};
+
+using sample_t = shared_ptr<const sample>;
+
+/**
+ * A procfs or sysfs file that is kept open and re-read with pread
+ */
+class sampled_file : non_copyable_mixin<sampled_file> {
+ public:
+  using duration_t = chrono::duration<double>;
+
+  explicit sampled_file(string path);
+  ~sampled_file();
+
+  const string& path() const;
+  sample_t read(duration_t max_age = duration_t::zero());
+
+ protected:
+  void refresh(sample& s);
+  void reopen();
+
+ private:
+  string m_path;
+  int m_fd{-1};
+
+  std::mutex m_lock;
+  shared_ptr<sample> m_sample;
+};
+
+/**
+ * Shared access to procfs and sysfs files
+ *
+ * Modules that sample the same file share one open descriptor and, if they
+ * read it within the max age they accept, the same snapshot of its contents.
+ * E.g. two cpu modules that update on the same aligned tick only read
+ * /proc/stat once. The file is closed once the last module releases it.
+ */
+class sampler : non_copyable_mixin<sampler> {
+ public:
+  using make_type = sampler&;
+  static make_type make();
+
+  explicit sampler() = default;
+
+  shared_ptr<sampled_file> open(const string& path);
+
+ private:
+  std::mutex m_lock;
+  std::map<string, std::weak_ptr<sampled_file>> m_files;
+};
+
+POLYBAR_NS_END
@@ -4,7 +4,9 @@
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
+#include <queue>
 #include <thread>
+#include <unordered_map>
 
 #include "common.hpp"
 #include "utils/mixins.hpp"
@@ -17,17 +19,17 @@ using namespace std::chrono_literals;
 class taskqueue : non_copyable_mixin<taskqueue> {
  public:
   struct deferred {
-    using clock = chrono::high_resolution_clock;
+    using clock = chrono::steady_clock;
     using duration = chrono::milliseconds;
     using timepoint = chrono::time_point<clock, duration>;
     using callback = function<void(size_t remaining)>;
 
-    explicit deferred(string id, timepoint now, duration wait, callback fn, size_t count)
-        : id(move(id)), func(move(fn)), now(move(now)), wait(move(wait)), count(move(count)) {}
+    explicit deferred(string id, timepoint when, duration wait, callback fn, size_t count)
+        : id(move(id)), func(move(fn)), when(move(when)), wait(move(wait)), count(move(count)) {}
 
     const string id;
     const callback func;
-    timepoint now;
+    timepoint when;
     duration wait;
     size_t count;
   };
@@ -48,15 +50,29 @@ class taskqueue : non_copyable_mixin<taskqueue> {
   bool purge(const string& id);
 
  protected:
-  void tick();
+  using handle_t = size_t;
+  using entry_t = pair<deferred::timepoint, handle_t>;
+
+  void add(string&& id, deferred::duration ms, deferred::callback&& fn, deferred::duration offset, size_t count);
+  void schedule(handle_t handle, deferred::timepoint when);
+  size_t remove(const string& id);
+  void tick(std::unique_lock<std::mutex>& guard);
 
  private:
   std::thread m_thread;
   std::mutex m_lock{};
   std::condition_variable m_hold;
-  std::atomic_bool m_active{true};
+  bool m_active{true};
+
+  handle_t m_nexthandle{0};
+  std::unordered_map<handle_t, unique_ptr<deferred>> m_tasks;
+  std::unordered_multimap<string, handle_t> m_ids;
 
-  vector<unique_ptr<deferred>> m_deferred;
+  /**
+   * Due times, entries of purged or rescheduled tasks are dropped when they
+   * reach the top
+   */
+  std::priority_queue<entry_t, vector<entry_t>, std::greater<entry_t>> m_queue;
 };
 
 POLYBAR_NS_END
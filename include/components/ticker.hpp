@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "common.hpp"
+#include "components/reactor.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+// fwd
+class signal_emitter;
+
+/**
+ * Shared wall clock ticks for periodic updates
+ *
+ * All callbacks with the same interval run one after another on a single
+ * reactor timer that is aligned to the wall clock, e.g. on every full second.
+ * If any of them reports a change, the controller is notified once per tick
+ * so the updates end up in the same redraw.
+ */
+class ticker : non_copyable_mixin<ticker> {
+ public:
+  using make_type = ticker&;
+  static make_type make();
+
+  using handle_t = size_t;
+  using callback_t = function<bool()>;
+  using duration_t = reactor::duration_t;
+
+  explicit ticker(reactor& reactor, signal_emitter& emitter);
+  ~ticker();
+
+  handle_t add(duration_t interval, callback_t&& callback);
+  void remove(handle_t handle);
+
+ protected:
+  struct entry {
+    callback_t callback{};
+    chrono::milliseconds interval{0};
+    bool running{false};
+    bool removed{false};
+    std::thread::id runner{};
+  };
+
+  struct group {
+    reactor::handle_t timer{0};
+    vector<handle_t> entries{};
+  };
+
+  void tick(chrono::milliseconds interval);
+
+ private:
+  reactor& m_reactor;
+  signal_emitter& m_sig;
+
+  std::mutex m_lock;
+  std::condition_variable m_finished;
+
+  handle_t m_nexthandle{1};
+  std::map<handle_t, entry> m_entries;
+  std::map<chrono::milliseconds, group> m_groups;
+};
+
+POLYBAR_NS_END
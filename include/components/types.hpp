@@ -181,6 +181,8 @@ struct bar_settings {
   bool dimmed{false};
   double dimvalue{1.0};
 
+  bool damage_tracking{false};
+
   bool shaded{false};
   struct size shade_size {
     1U, 1U
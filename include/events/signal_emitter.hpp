@@ -6,14 +6,12 @@
 
 POLYBAR_NS
 
-/**
- * \brief Holds all signal receivers attached to the emitter
- */
-extern signal_receivers_t g_signal_receivers;
-
 /**
  * Wrapper used to delegate emitted signals
  * to attached signal receivers
+ *
+ * Every emitter has its own receivers, each bar gets an emitter of its own
+ * while modules report to the process wide one returned by make()
  */
 class signal_emitter {
  public:
@@ -23,21 +21,27 @@ class signal_emitter {
   explicit signal_emitter() = default;
   virtual ~signal_emitter() {}
 
+  /**
+   * Deliver the signal to all attached receivers in order of priority
+   *
+   * Returns true if any of the receivers handled the signal
+   */
   template <typename Signal>
   bool emit(const Signal& sig) {
+    bool handled{false};
+
     try {
-      if (g_signal_receivers.find(id<Signal>()) != g_signal_receivers.end()) {
-        for (auto&& item : g_signal_receivers.at(id<Signal>())) {
-          if (item.second->on(sig)) {
-            return true;
-          }
-        }
+      auto& slots = m_receivers[id<Signal>()];
+
+      // Receivers may attach or detach others while handling the signal
+      for (size_t i = 0; i < slots.size(); i++) {
+        handled = slots[i].callback(slots[i].handler, &sig) || handled;
       }
     } catch (const std::exception& e) {
       logger::make().err(e.what());
     }
 
-    return false;
+    return handled;
   }
 
   template <typename Signal, typename Next, typename... Signals>
@@ -57,23 +61,32 @@ class signal_emitter {
 
  protected:
   template <typename Signal>
-  std::type_index id() const {
-    return typeid(Signal);
+  static constexpr size_t id() {
+    return signals::id<Signal>::value;
   }
 
   template <typename Receiver, typename Signal>
   void attach(Receiver* s) {
-    attach(s, id<Signal>());
+    attach(id<Signal>(), signal_slot{s->priority(), s, static_cast<signal_receiver_impl<Signal>*>(s),
+                             &signal_slot::call<Signal>});
   }
 
   template <typename Receiver, typename Signal, typename Next, typename... Signals>
   void attach(Receiver* s) {
-    attach(s, id<Signal>());
+    attach<Receiver, Signal>(s);
     attach<Receiver, Next, Signals...>(s);
   }
 
-  void attach(signal_receiver_interface* s, std::type_index id) {
-    g_signal_receivers[id].emplace(s->priority(), s);
+  void attach(size_t id, signal_slot&& slot) {
+    auto& slots = m_receivers[id];
+
+    // Receivers with the same priority are called in the order they were attached
+    auto it = slots.begin();
+    while (it != slots.end() && it->priority <= slot.priority) {
+      ++it;
+    }
+
+    slots.emplace(it, forward<signal_slot>(slot));
   }
 
   template <typename Receiver, typename Signal>
@@ -87,21 +100,19 @@ class signal_emitter {
     detach<Receiver, Next, Signals...>(s);
   }
 
-  void detach(signal_receiver_interface* d, std::type_index id) {
-    try {
-      auto& prio_map = g_signal_receivers.at(id);
-      const auto& prio_sink_pair = prio_map.equal_range(d->priority());
-
-      for (auto it = prio_sink_pair.first; it != prio_sink_pair.second;) {
-        if (d == it->second) {
-          it = prio_map.erase(it);
-        } else {
-          ++it;
-        }
+  void detach(signal_receiver_interface* d, size_t id) {
+    auto& slots = m_receivers[id];
+
+    for (auto it = slots.begin(); it != slots.end();) {
+      if (d == it->receiver) {
+        it = slots.erase(it);
+      } else {
+        ++it;
       }
-    } catch (...) {
     }
   }
+
+  signal_receivers_t m_receivers;
 };
 
 POLYBAR_NS_END
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <type_traits>
+
 #include "common.hpp"
 
 POLYBAR_NS
@@ -12,7 +14,22 @@ class signal_receiver;
 namespace signals {
   namespace detail {
     class signal;
-  }
+
+    template <typename... Signals>
+    struct signal_list {
+      static constexpr size_t size{sizeof...(Signals)};
+    };
+
+    template <typename Signal, typename List>
+    struct signal_index;
+
+    template <typename Signal, typename... Tail>
+    struct signal_index<Signal, signal_list<Signal, Tail...>> : std::integral_constant<size_t, 0> {};
+
+    template <typename Signal, typename Head, typename... Tail>
+    struct signal_index<Signal, signal_list<Head, Tail...>>
+        : std::integral_constant<size_t, 1 + signal_index<Signal, signal_list<Tail...>>::value> {};
+  }  // namespace detail
 
   namespace eventqueue {
     struct start;
@@ -26,6 +43,7 @@ namespace signals {
     struct command;
     struct hook;
     struct action;
+    struct stats;
   }  // namespace ipc
   namespace ui {
     struct ready;
@@ -44,23 +62,24 @@ namespace signals {
   namespace ui_tray {
     struct mapped_clients;
   }
-  namespace parser {
-    struct change_background;
-    struct change_foreground;
-    struct change_underline;
-    struct change_overline;
-    struct change_font;
-    struct change_alignment;
-    struct reverse_colors;
-    struct offset_pixel;
-    struct attribute_set;
-    struct attribute_unset;
-    struct attribute_toggle;
-    struct action_begin;
-    struct action_end;
-    struct text;
-    struct control;
-  }  // namespace parser
+
+  /**
+   * All signals that can be emitted
+   *
+   * The position of a signal in this list is its index in the receiver table
+   * of the emitter, new signals have to be added here
+   */
+  using all = detail::signal_list<eventqueue::start, eventqueue::exit_terminate, eventqueue::exit_reload,
+      eventqueue::notify_change, eventqueue::notify_forcechange, eventqueue::check_state, ipc::command, ipc::hook,
+      ipc::action, ipc::stats, ui::ready, ui::changed, ui::tick, ui::button_press, ui::cursor_change, ui::visibility_change,
+      ui::dim_window, ui::shade_window, ui::unshade_window, ui::request_snapshot, ui::update_background,
+      ui::update_geometry, ui_tray::mapped_clients>;
+
+  /**
+   * Compile-time index of the given signal
+   */
+  template <typename Signal>
+  struct id : detail::signal_index<Signal, all> {};
 }  // namespace signals
 
 POLYBAR_NS_END
@@ -1,22 +1,17 @@
 #pragma once
 
-#include <map>
-#include <unordered_map>
-#include <typeindex>
-#include <typeinfo>
+#include <array>
 
 #include "common.hpp"
+#include "events/signal_fwd.hpp"
 
 POLYBAR_NS
 
 class signal_receiver_interface {
  public:
   using prio = int;
-  using prio_map = std::multimap<prio, signal_receiver_interface*>;
   virtual ~signal_receiver_interface() {}
   virtual prio priority() const = 0;
-  template <typename Signal>
-  bool on(const Signal& signal);
 };
 
 template <typename Signal>
@@ -26,17 +21,6 @@ class signal_receiver_impl {
   virtual bool on(const Signal&) = 0;
 };
 
-template <typename Signal>
-bool signal_receiver_interface::on(const Signal& s) {
-  auto event_sink = dynamic_cast<signal_receiver_impl<Signal>*>(this);
-
-  if (event_sink != nullptr && event_sink->on(s)) {
-    return true;
-  } else {
-    return false;
-  }
-}
-
 template <int Priority, typename Signal, typename... Signals>
 class signal_receiver : public signal_receiver_interface,
                         public signal_receiver_impl<Signal>,
@@ -47,6 +31,27 @@ class signal_receiver : public signal_receiver_interface,
   }
 };
 
-using signal_receivers_t = std::unordered_map<std::type_index, signal_receiver_interface::prio_map>;
+/**
+ * Receiver attached to a single signal
+ *
+ * The receiver is cast to the handler interface of the signal when it is
+ * attached, so that emitting a signal doesn't need any RTTI lookups
+ */
+struct signal_slot {
+  signal_receiver_interface::prio priority;
+  signal_receiver_interface* receiver;
+  void* handler;
+  bool (*callback)(void* handler, const void* signal);
+
+  template <typename Signal>
+  static bool call(void* handler, const void* signal) {
+    return static_cast<signal_receiver_impl<Signal>*>(handler)->on(*static_cast<const Signal*>(signal));
+  }
+};
+
+/**
+ * Receivers of each signal, ordered by priority and indexed by signals::id
+ */
+using signal_receivers_t = array<vector<signal_slot>, signals::all::size>;
 
 POLYBAR_NS_END
@@ -18,12 +18,11 @@ namespace modules {
       string m_path;
     };
 
-    string get_output();
+    display_list get_output();
 
    public:
     explicit backlight_module(const bar_settings&, string);
 
-    void idle();
     bool on_event(inotify_event* event);
     bool build(builder* builder, const string& tag) const;
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "common.hpp"
+#include "components/sampler.hpp"
 #include "modules/meta/inotify_module.hpp"
+#include "utils/uevent.hpp"
 
 POLYBAR_NS
 
@@ -48,19 +50,20 @@ namespace modules {
     explicit battery_module(const bar_settings&, string);
 
     void start();
-    void teardown();
-    void idle();
     bool on_event(inotify_event* event);
+    bool update(bool force);
     string get_format() const;
     bool build(builder* builder, const string& tag) const;
 
    protected:
+    void refresh(bool force);
+    void read_uevents();
     state current_state();
     int current_percentage();
     int clamp_percentage(int percentage, state state) const;
     string current_time();
     string current_consumption();
-    void subthread();
+    void animate();
 
    private:
     static constexpr const char* FORMAT_CHARGING{"format-charging"};
@@ -90,12 +93,25 @@ namespace modules {
     progressbar_t m_bar_capacity;
     ramp_t m_ramp_capacity;
 
+    /**
+     * \brief Kernel events of the power supplies, the sysfs files are watched with inotify without it
+     */
+    unique_ptr<uevent_socket> m_uevents;
+    string m_adapter;
+    string m_battery;
+
     string m_fstate;
     string m_fcapnow;
     string m_fcapfull;
     string m_frate;
     string m_fvoltage;
 
+    shared_ptr<sampled_file> m_state_file;
+    shared_ptr<sampled_file> m_capnow_file;
+    shared_ptr<sampled_file> m_capfull_file;
+    shared_ptr<sampled_file> m_rate_file;
+    shared_ptr<sampled_file> m_voltage_file;
+
     state m_state{state::DISCHARGING};
     int m_percentage{0};
 
@@ -103,8 +119,6 @@ namespace modules {
     string m_timeformat;
     size_t m_unchanged{SKIP_N_UNCHANGED};
     chrono::duration<double> m_interval{};
-    chrono::system_clock::time_point m_lastpoll;
-    thread m_subthread;
   };
 }
 
@@ -42,10 +42,11 @@ namespace modules {
    public:
     explicit bspwm_module(const bar_settings&, string);
 
-    void stop();
+    void teardown();
     bool has_event();
+    vector<int> get_poll_fds();
     bool update();
-    string get_output();
+    display_list get_output();
     bool build(builder* builder, const string& tag) const;
 
    protected:
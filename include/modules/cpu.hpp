@@ -1,22 +1,13 @@
 #pragma once
 
+#include "components/sampler.hpp"
+#include "utils/proc.hpp"
 #include "settings.hpp"
 #include "modules/meta/timer_module.hpp"
 
 POLYBAR_NS
 
 namespace modules {
-  struct cpu_time {
-    unsigned long long user;
-    unsigned long long nice;
-    unsigned long long system;
-    unsigned long long idle;
-    unsigned long long steal;
-    unsigned long long total;
-  };
-
-  using cpu_time_t = unique_ptr<cpu_time>;
-
   class cpu_module : public timer_module<cpu_module> {
    public:
     explicit cpu_module(const bar_settings&, string);
@@ -40,8 +31,10 @@ namespace modules {
     label_t m_label;
     int m_ramp_padding;
 
-    vector<cpu_time_t> m_cputimes;
-    vector<cpu_time_t> m_cputimes_prev;
+    shared_ptr<sampled_file> m_stat;
+
+    vector<proc_util::cpu_time> m_cputimes;
+    vector<proc_util::cpu_time> m_cputimes_prev;
 
     float m_total = 0;
     vector<float> m_load;
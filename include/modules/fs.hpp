@@ -1,6 +1,9 @@
 #pragma once
 
+#include <unordered_map>
+
 #include "components/config.hpp"
+#include "components/sampler.hpp"
 #include "settings.hpp"
 #include "modules/meta/timer_module.hpp"
 
@@ -37,11 +40,17 @@ namespace modules {
    public:
     explicit fs_module(const bar_settings&, string);
 
+    void start();
+    void teardown();
     bool update();
     string get_format() const;
-    string get_output();
+    display_list get_output();
     bool build(builder* builder, const string& tag) const;
 
+   protected:
+    void update_mounts();
+    void mounts_changed();
+
    private:
     static constexpr auto FORMAT_MOUNTED = "format-mounted";
     static constexpr auto FORMAT_UNMOUNTED = "format-unmounted";
@@ -57,8 +66,19 @@ namespace modules {
     progressbar_t m_barfree;
     ramp_t m_rampcapacity;
 
-    vector<string> m_mountpoints;
     vector<fs_mount_t> m_mounts;
+    shared_ptr<sampled_file> m_mountinfo;
+
+    /**
+     * \brief Configured mountpoints, indexed for the lookup of the mountinfo entries
+     */
+    std::unordered_map<string, fs_mount*> m_mountindex;
+
+    /**
+     * \brief Descriptor of mountinfo that signals POLLPRI when the mount table changed
+     */
+    unique_ptr<file_descriptor> m_mountwatch;
+    bool m_mountschanged{true};
     bool m_fixed{false};
     bool m_remove_unmounted{false};
     int m_spacing{2};
@@ -33,28 +33,52 @@ namespace modules {
       URGENT,
     };
 
+    /**
+     * Cached state of a workspace, its label is only created again once the state changed
+     */
     struct workspace {
-      explicit workspace(string name, enum state state_, label_t&& label)
-          : name(name), state(state_), label(forward<label_t>(label)) {}
+      explicit workspace(string name, string output, int num) : name(move(name)), output(move(output)), num(num) {}
 
       operator bool();
 
       string name;
-      enum state state;
+      string output;
+      int num;
+
+      bool focused{false};
+      bool urgent{false};
+      bool visible{false};
+
+      enum state state { state::NONE };
       label_t label;
+
+      /**
+       * \brief Name shown in the label and its icon
+       */
+      string display_name;
+      label_t icon;
     };
 
    public:
     explicit i3_module(const bar_settings&, string);
 
-    void stop();
+    void teardown();
     bool has_event();
+    vector<int> get_poll_fds();
     bool update();
     bool build(builder* builder, const string& tag) const;
 
    protected:
     bool input(string&& cmd);
 
+    void on_workspace_event(const i3ipc::workspace_event_t& event);
+    void refresh_workspaces();
+    void update_label(workspace& ws);
+    workspace* find_workspace(const string& name) const;
+
+    template <typename Func>
+    decltype(auto) with_command(Func&& func);
+
    private:
     static string make_workspace_command(const string& workspace);
 
@@ -93,6 +117,19 @@ namespace modules {
     bool m_fuzzy_match{false};
 
     unique_ptr<i3_util::connection_t> m_ipc;
+    bool m_connected{true};
+
+    /**
+     * \brief Connection for queries and commands, kept open between events
+     */
+    unique_ptr<i3_util::connection_t> m_command;
+    mutex m_commandlock;
+
+    /**
+     * \brief Set if an event couldn't be applied to the cached workspaces
+     */
+    bool m_refresh{true};
+    bool m_changed{false};
   };
 }  // namespace modules
 
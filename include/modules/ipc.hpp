@@ -2,6 +2,7 @@
 
 #include "modules/meta/static_module.hpp"
 #include "utils/command.hpp"
+#include "utils/io.hpp"
 
 POLYBAR_NS
 
@@ -11,6 +12,9 @@ namespace modules {
    * received ipc messages. The hook will execute the defined
    * shell script and the resulting output will be used
    * as the module content.
+   *
+   * Hooks run on the reactor, a newer message cancels the
+   * hook that is still running.
    */
   class ipc_module : public static_module<ipc_module> {
    public:
@@ -27,17 +31,39 @@ namespace modules {
     explicit ipc_module(const bar_settings&, string);
 
     void start();
+    void teardown();
     void update() {}
-    string get_output();
+    display_list get_output();
     bool build(builder* builder, const string& tag) const;
     void on_message(const string& message);
 
+   protected:
+    void run_hook();
+    void cancel_hook();
+    void read_output();
+    void read_exit();
+
    private:
     static constexpr const char* TAG_OUTPUT{"<output>"};
     vector<unique_ptr<hook>> m_hooks;
     map<mousebtn, string> m_actions;
     string m_output;
     size_t m_initial;
+
+    /**
+     * Index of the next hook to run, starting at 1
+     */
+    atomic<size_t> m_pending{0};
+    reactor::handle_t m_runner{0};
+
+    /**
+     * Running hook, its output and exit sources and the output read so far
+     */
+    unique_ptr<command<output_policy::REDIRECTED>> m_command;
+    reactor::handle_t m_reader{0};
+    reactor::handle_t m_exit{0};
+    unique_ptr<io_util::line_reader> m_lines;
+    string m_lastline;
   };
 }
 
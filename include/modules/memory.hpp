@@ -1,5 +1,6 @@
 #pragma once
 
+#include "components/sampler.hpp"
 #include "modules/meta/timer_module.hpp"
 #include "settings.hpp"
 
@@ -39,6 +40,8 @@ namespace modules {
     int m_perc_swap_free{0};
     ramp_t m_ramp_swapused;
     ramp_t m_ramp_swapfree;
+
+    shared_ptr<sampled_file> m_meminfo;
   };
 }
 
@@ -7,12 +7,15 @@
 #include <mutex>
 
 #include "common.hpp"
+#include "components/display_list.hpp"
+#include "components/reactor.hpp"
 #include "components/types.hpp"
 #include "errors.hpp"
 #include "utils/concurrency.hpp"
 #include "utils/functional.hpp"
 #include "utils/inotify.hpp"
 #include "utils/string.hpp"
+#include "utils/time.hpp"
 
 POLYBAR_NS
 
@@ -72,7 +75,7 @@ namespace modules {
     int offset{0};
     int font{0};
 
-    string decorate(builder* builder, string output);
+    display_list decorate(builder* builder, const display_list& output);
   };
 
   // }}}
@@ -95,6 +98,46 @@ namespace modules {
 
   // }}}
 
+  // class definition : module_stats {{{
+
+  /**
+   * Performance counters of a module, reported by the `stats` ipc message
+   *
+   * Times are accumulated in nanoseconds
+   */
+  struct module_stats {
+    /**
+     * \brief Calls to update()
+     */
+    atomic<uint64_t> updates{0};
+
+    /**
+     * \brief Notifications sent to the controller
+     */
+    atomic<uint64_t> broadcasts{0};
+
+    /**
+     * \brief Rebuilds of the module output
+     */
+    atomic<uint64_t> builds{0};
+
+    /**
+     * \brief Time spent building the output in get_output()
+     */
+    atomic<uint64_t> build_time{0};
+
+    /**
+     * \brief Time spent in update() and has_event()
+     */
+    atomic<uint64_t> update_time{0};
+
+    /**
+     * \brief CPU time of the module callbacks
+     */
+    atomic<uint64_t> cpu_time{0};
+  };
+
+  // }}}
   // class definition : module_interface {{{
 
   struct module_interface {
@@ -107,7 +150,8 @@ namespace modules {
     virtual void start() = 0;
     virtual void stop() = 0;
     virtual void halt(string error_message) = 0;
-    virtual string contents() = 0;
+    virtual display_list contents() = 0;
+    virtual const module_stats& stats() const = 0;
   };
 
   // }}}
@@ -124,39 +168,61 @@ namespace modules {
     void stop();
     void halt(string error_message);
     void teardown();
-    string contents();
+    display_list contents();
+    const module_stats& stats() const;
 
    protected:
     void broadcast();
-    void idle();
-    void sleep(chrono::duration<double> duration);
+    void invalidate();
     void wakeup();
+    reactor::handle_t add_timer(reactor::duration_t timeout, reactor::duration_t interval, reactor::callback_t&& callback);
+    reactor::handle_t add_fd(int fd, reactor::callback_t&& callback, unsigned int events = EPOLLIN);
+    void remove_source(reactor::handle_t handle);
+    void set_blocking();
+    template <typename Func>
+    decltype(auto) timed(Func&& func);
+    template <typename Func>
+    decltype(auto) timed_update(Func&& func);
     string get_format() const;
-    string get_output();
+    display_list get_output();
 
    protected:
     signal_emitter& m_sig;
+    reactor& m_reactor;
     const bar_settings m_bar;
     const logger& m_log;
     const config& m_conf;
 
     mutex m_buildlock;
     mutex m_updatelock;
-    mutex m_sleeplock;
-    std::condition_variable m_sleephandler;
 
     string m_name;
     unique_ptr<builder> m_builder;
     unique_ptr<module_formatter> m_formatter;
-    vector<thread> m_threads;
-    thread m_mainthread;
 
     bool m_handle_events{true};
 
+    /**
+     * \brief Run the callbacks on the blocking threads of the reactor, see set_blocking()
+     */
+    atomic<bool> m_blocking{false};
+
+    module_stats m_stats;
+
    private:
+    reactor::callback_t accounted(reactor::callback_t&& callback);
+
+    mutex m_sourcelock;
+    vector<reactor::handle_t> m_sources;
+
     atomic<bool> m_enabled{true};
     atomic<bool> m_changed{true};
-    string m_cache;
+
+    /**
+     * \brief Guards the cache, contents() is called by the controller of every bar showing the module
+     */
+    mutex m_cachelock;
+    display_list m_cache;
   };
 
   // }}}
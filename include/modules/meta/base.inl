@@ -13,6 +13,7 @@ namespace modules {
   template <typename Impl>
   module<Impl>::module(const bar_settings bar, string name)
       : m_sig(signal_emitter::make())
+      , m_reactor(reactor::make())
       , m_bar(bar)
       , m_log(logger::make())
       , m_conf(config::make())
@@ -25,13 +26,8 @@ namespace modules {
   module<Impl>::~module() noexcept {
     m_log.trace("%s: Deconstructing", name());
 
-    for (auto&& thread_ : m_threads) {
-      if (thread_.joinable()) {
-        thread_.join();
-      }
-    }
-    if (m_mainthread.joinable()) {
-      m_mainthread.join();
+    for (auto&& handle : m_sources) {
+      m_reactor.remove(handle);
     }
   }
 
@@ -47,12 +43,21 @@ namespace modules {
 
   template <typename Impl>
   void module<Impl>::stop() {
-    if (!static_cast<bool>(m_enabled)) {
+    if (!m_enabled.exchange(false)) {
       return;
     }
 
     m_log.info("%s: Stopping", name());
-    m_enabled = false;
+
+    // Wait for running callbacks, no new sources are added once the module is disabled
+    vector<reactor::handle_t> sources;
+    {
+      std::lock_guard<std::mutex> guard(m_sourcelock);
+      sources.swap(m_sources);
+    }
+    for (auto&& handle : sources) {
+      m_reactor.remove(handle);
+    }
 
     std::lock(m_buildlock, m_updatelock);
     std::lock_guard<std::mutex> guard_a(m_buildlock, std::adopt_lock);
@@ -76,8 +81,9 @@ namespace modules {
   void module<Impl>::teardown() {}
 
   template <typename Impl>
-  string module<Impl>::contents() {
-    if (m_changed) {
+  display_list module<Impl>::contents() {
+    std::lock_guard<std::mutex> guard(m_cachelock);
+    if (m_changed.exchange(false)) {
       m_log.info("%s: Rebuilding cache", name());
       m_cache = CAST_MOD(Impl)->get_output();
       // Make sure builder is really empty
@@ -87,39 +93,127 @@ namespace modules {
         m_builder->control(controltag::R);
         m_cache += m_builder->flush();
       }
-      m_changed = false;
     }
     return m_cache;
   }
 
+  template <typename Impl>
+  const module_stats& module<Impl>::stats() const {
+    return m_stats;
+  }
+
   // }}}
   // module<Impl> protected {{{
 
   template <typename Impl>
   void module<Impl>::broadcast() {
+    m_stats.broadcasts++;
     m_changed = true;
     m_sig.emit(signals::eventqueue::notify_change{});
   }
 
+  /**
+   * Mark the output as changed without notifying the controller
+   *
+   * Used when the notification is sent once for a batch of modules
+   */
   template <typename Impl>
-  void module<Impl>::idle() {
-    if (running()) {
-      CAST_MOD(Impl)->sleep(25ms);
+  void module<Impl>::invalidate() {
+    m_changed = true;
+  }
+
+  /**
+   * Run the callbacks of all sources of the module as soon as possible
+   */
+  template <typename Impl>
+  void module<Impl>::wakeup() {
+    std::lock_guard<std::mutex> guard(m_sourcelock);
+    for (auto&& handle : m_sources) {
+      m_reactor.trigger(handle);
     }
   }
 
+  /**
+   * Run the callback on the reactor after the timeout and then every interval
+   *
+   * The source is removed when the module stops. Returns 0 if the module has
+   * already been stopped
+   */
   template <typename Impl>
-  void module<Impl>::sleep(chrono::duration<double> sleep_duration) {
-    if (running()) {
-      std::unique_lock<std::mutex> lck(m_sleeplock);
-      m_sleephandler.wait_for(lck, sleep_duration);
+  reactor::handle_t module<Impl>::add_timer(
+      reactor::duration_t timeout, reactor::duration_t interval, reactor::callback_t&& callback) {
+    std::lock_guard<std::mutex> guard(m_sourcelock);
+    if (!running()) {
+      return 0;
+    }
+    m_sources.emplace_back(m_reactor.add_timer(timeout, interval, accounted(forward<reactor::callback_t>(callback))));
+    if (m_blocking) {
+      m_reactor.set_blocking(m_sources.back());
     }
+    return m_sources.back();
   }
 
+  /**
+   * Run the callback on the reactor whenever the fd is readable
+   *
+   * The source is removed when the module stops. Returns 0 if the module has
+   * already been stopped
+   */
   template <typename Impl>
-  void module<Impl>::wakeup() {
-    m_log.trace("%s: Release sleep lock", name());
-    m_sleephandler.notify_all();
+  reactor::handle_t module<Impl>::add_fd(int fd, reactor::callback_t&& callback, unsigned int events) {
+    std::lock_guard<std::mutex> guard(m_sourcelock);
+    if (!running()) {
+      return 0;
+    }
+    m_sources.emplace_back(m_reactor.add_fd(fd, accounted(forward<reactor::callback_t>(callback)), events));
+    if (m_blocking) {
+      m_reactor.set_blocking(m_sources.back());
+    }
+    return m_sources.back();
+  }
+
+  template <typename Impl>
+  void module<Impl>::remove_source(reactor::handle_t handle) {
+    {
+      std::lock_guard<std::mutex> guard(m_sourcelock);
+      m_sources.erase(std::remove(m_sources.begin(), m_sources.end(), handle), m_sources.end());
+    }
+    m_reactor.remove(handle);
+  }
+
+  /**
+   * Move the callbacks of the module off the shared reactor workers
+   *
+   * For modules that wait on the network or on other processes, so they only
+   * hold up their own updates, like they did with a thread of their own
+   */
+  template <typename Impl>
+  void module<Impl>::set_blocking() {
+    std::lock_guard<std::mutex> guard(m_sourcelock);
+    m_blocking = true;
+    for (auto&& handle : m_sources) {
+      m_reactor.set_blocking(handle);
+    }
+  }
+
+  /**
+   * Call into the module implementation and add the elapsed time to its update time
+   */
+  template <typename Impl>
+  template <typename Func>
+  decltype(auto) module<Impl>::timed(Func&& func) {
+    time_util::stopwatch watch{m_stats.update_time};
+    return func();
+  }
+
+  /**
+   * Same as timed(), counted as an update of the module
+   */
+  template <typename Impl>
+  template <typename Func>
+  decltype(auto) module<Impl>::timed_update(Func&& func) {
+    m_stats.updates++;
+    return timed(forward<Func>(func));
   }
 
   template <typename Impl>
@@ -128,8 +222,10 @@ namespace modules {
   }
 
   template <typename Impl>
-  string module<Impl>::get_output() {
+  display_list module<Impl>::get_output() {
     std::lock_guard<std::mutex> guard(m_buildlock);
+    time_util::stopwatch watch{m_stats.build_time};
+    m_stats.builds++;
     auto format_name = CONST_MOD(Impl).get_format();
     auto format = m_formatter->get(format_name);
     bool no_tag_built{true};
@@ -179,6 +275,20 @@ namespace modules {
     return format->decorate(&*m_builder, m_builder->flush());
   }
 
+  // }}}
+  // module<Impl> private {{{
+
+  /**
+   * Wrap a reactor callback so that its CPU time is added to the module counters
+   */
+  template <typename Impl>
+  reactor::callback_t module<Impl>::accounted(reactor::callback_t&& callback) {
+    return [this, callback = move(callback)] {
+      time_util::stopwatch watch{m_stats.cpu_time, true};
+      callback();
+    };
+  }
+
   // }}}
 }  // namespace modules
 
@@ -1,44 +1,122 @@
 #pragma once
 
+#include <sys/epoll.h>
+#include <unistd.h>
+
 #include "modules/meta/base.hpp"
 
 POLYBAR_NS
 
 namespace modules {
+  /**
+   * Module driven by the file descriptors it reports through get_poll_fds()
+   *
+   * The fds are collected in an epoll set that is attached to the reactor, so
+   * has_event() is only called once one of them is readable. Modules that need
+   * to be checked without any fd activity (e.g. to reconnect) report a timeout
+   * through get_poll_timeout()
+   */
   template <class Impl>
   class event_module : public module<Impl> {
    public:
     using module<Impl>::module;
 
+    ~event_module() {
+      if (m_epollfd != -1) {
+        close(m_epollfd);
+      }
+    }
+
     void start() {
-      this->m_mainthread = thread(&event_module::runner, this);
+      if ((m_epollfd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+        throw system_error("Failed to create epoll instance");
+      }
+
+      this->add_fd(m_epollfd, [this] { runner(false); });
+      this->add_timer(0s, 0s, [this] {
+        m_timer = reactor::current();
+        runner(true);
+      });
     }
 
    protected:
-    void runner() {
-      this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
+    void runner(bool timeout) {
       try {
-        // warm up module output before entering the loop
         std::unique_lock<std::mutex> guard(this->m_updatelock);
-        CAST_MOD(Impl)->update();
-        CAST_MOD(Impl)->broadcast();
-        guard.unlock();
+        bool changed{false};
 
-        const auto check = [&]() -> bool {
-          std::lock_guard<std::mutex> guard(this->m_updatelock);
-          return CAST_MOD(Impl)->has_event() && CAST_MOD(Impl)->update();
-        };
+        if (!m_warmedup) {
+          // warm up module output
+          m_warmedup = true;
+          this->timed_update([this] { return CAST_MOD(Impl)->update(); });
+          changed = true;
+        } else if (timeout ? (m_fds.empty() || m_timeout.count() > 0) : readable()) {
+          changed = this->timed([this] { return CAST_MOD(Impl)->has_event(); }) && this->timed_update([this] { return CAST_MOD(Impl)->update(); });
+        }
+
+        watch(CAST_MOD(Impl)->get_poll_fds());
+
+        if ((m_timeout = CAST_MOD(Impl)->get_poll_timeout()).count() == 0 && m_fds.empty()) {
+          // Nothing to wait for, check again to give the module a chance to reconnect
+          m_timeout = 1s;
+        }
+        if (m_timeout.count() > 0 && m_timer) {
+          this->m_reactor.set_timer(m_timer, m_timeout);
+        }
+
+        guard.unlock();
 
-        while (this->running()) {
-          if (check()) {
-            CAST_MOD(Impl)->broadcast();
-          }
-          CAST_MOD(Impl)->idle();
+        if (changed) {
+          CAST_MOD(Impl)->broadcast();
         }
       } catch (const exception& err) {
         CAST_MOD(Impl)->halt(err.what());
       }
     }
+
+    /**
+     * Time until the module is checked again without fd activity, 0 waits for the fds only
+     */
+    chrono::duration<double> get_poll_timeout() {
+      return chrono::duration<double>::zero();
+    }
+
+   private:
+    bool readable() const {
+      epoll_event event{};
+      return epoll_wait(m_epollfd, &event, 1, 0) > 0;
+    }
+
+    /**
+     * Update the epoll set with the current fds of the module
+     *
+     * The fds are added again on every call since a reconnected socket can
+     * reuse the number of the closed one, which epoll has dropped already
+     */
+    void watch(vector<int>&& fds) {
+      for (auto&& fd : m_fds) {
+        if (std::find(fds.begin(), fds.end(), fd) == fds.end()) {
+          epoll_ctl(m_epollfd, EPOLL_CTL_DEL, fd, nullptr);
+        }
+      }
+
+      for (auto&& fd : fds) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, fd, &event) == -1 && errno != EEXIST) {
+          throw system_error("Failed to add fd " + to_string(fd) + " to epoll");
+        }
+      }
+
+      m_fds = forward<vector<int>>(fds);
+    }
+
+    int m_epollfd{-1};
+    vector<int> m_fds;
+    atomic<reactor::handle_t> m_timer{0};
+    chrono::duration<double> m_timeout{0};
+    bool m_warmedup{false};
   };
 }
 
@@ -12,81 +12,85 @@ namespace modules {
     using module<Impl>::module;
 
     void start() {
-      this->m_mainthread = thread(&inotify_module::runner, this);
-    }
+      // Warm up module output
+      this->add_timer(0s, 0s, [this] {
+        try {
+          std::unique_lock<std::mutex> guard(this->m_updatelock);
+          this->timed_update([this] { return CAST_MOD(Impl)->on_event(nullptr); });
+          guard.unlock();
+          CAST_MOD(Impl)->broadcast();
+        } catch (const exception& err) {
+          CAST_MOD(Impl)->halt(err.what());
+        }
+      });
 
-   protected:
-    void runner() {
-      this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
       try {
-        // Warm up module output before entering the loop
-        std::unique_lock<std::mutex> guard(this->m_updatelock);
-        CAST_MOD(Impl)->on_event(nullptr);
-        CAST_MOD(Impl)->broadcast();
-        guard.unlock();
+        for (auto&& w : m_watchlist) {
+          m_watches.emplace_back(inotify_util::make_watch(w.first));
+          m_watches.back()->attach(w.second);
+        }
+      } catch (const system_error& e) {
+        this->m_log.err("%s: Error while creating inotify watch (what: %s)", this->name(), e.what());
+      }
 
-        while (this->running()) {
-          std::lock_guard<std::mutex> guard(this->m_updatelock);
-          CAST_MOD(Impl)->poll_events();
+      for (auto&& w : m_watches) {
+        if (w->get_file_descriptor() != -1) {
+          auto* watch = w.get();
+          this->add_fd(watch->get_file_descriptor(), [this, watch] { poll_events(watch); });
         }
-      } catch (const module_error& err) {
-        CAST_MOD(Impl)->halt(err.what());
-      } catch (const std::exception& err) {
-        CAST_MOD(Impl)->halt(err.what());
       }
     }
 
+   protected:
     void watch(string path, int mask = IN_ALL_EVENTS) {
       this->m_log.trace("%s: Attach inotify at %s", this->name(), path);
       m_watchlist.insert(make_pair(path, mask));
     }
 
-    void idle() {
-      this->sleep(200ms);
-    }
-
-    void poll_events() {
-      vector<unique_ptr<inotify_watch>> watches;
+    /**
+     * Handle the events reported by one of the watches
+     *
+     * The watches stay attached while the module reads the tracked files,
+     * so the events caused by on_event() itself are discarded afterwards
+     */
+    void poll_events(inotify_watch* watch) {
+      bool changed{false};
 
       try {
-        for (auto&& w : m_watchlist) {
-          watches.emplace_back(inotify_util::make_watch(w.first));
-          watches.back()->attach(w.second);
+        std::unique_lock<std::mutex> guard(this->m_updatelock);
+
+        if (!this->running() || !watch->poll(0)) {
+          return;
         }
-      } catch (const system_error& e) {
-        watches.clear();
-        this->m_log.err("%s: Error while creating inotify watch (what: %s)", this->name(), e.what());
-        CAST_MOD(Impl)->sleep(0.1s);
-        return;
-      }
 
-      while (this->running()) {
-        for (auto&& w : watches) {
-          this->m_log.trace_x("%s: Poll inotify watch %s", this->name(), w->path());
+        this->m_log.trace_x("%s: Poll inotify watch %s", this->name(), watch->path());
+        auto event = watch->get_event();
 
-          if (w->poll(1000 / watches.size())) {
-            auto event = w->get_event();
+        if (event->mask & IN_IGNORED) {
+          // The watched file has been removed or replaced
+          watch->attach(m_watchlist.at(watch->path()));
+        }
 
-            for (auto&& w : watches) {
-              w->remove(true);
-            }
+        changed = this->timed_update([&] { return CAST_MOD(Impl)->on_event(event.get()); });
 
-            if (CAST_MOD(Impl)->on_event(event.get())) {
-              CAST_MOD(Impl)->broadcast();
-            }
-            CAST_MOD(Impl)->idle();
-            return;
+        for (auto&& w : m_watches) {
+          while (w->poll(0)) {
+            w->get_event();
           }
-
-          if (!this->running())
-            break;
         }
-        CAST_MOD(Impl)->idle();
+      } catch (const exception& err) {
+        CAST_MOD(Impl)->halt(err.what());
+        return;
+      }
+
+      if (changed) {
+        CAST_MOD(Impl)->broadcast();
       }
     }
 
    private:
     map<string, int> m_watchlist;
+    vector<unique_ptr<inotify_watch>> m_watches;
   };
 }
 
@@ -11,9 +11,8 @@ namespace modules {
     using module<Impl>::module;
 
     void start() {
-      this->m_mainthread = thread([&] {
-        this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
-        CAST_MOD(Impl)->update();
+      this->add_timer(0s, 0s, [this] {
+        this->timed_update([this] { return CAST_MOD(Impl)->update(); });
         CAST_MOD(Impl)->broadcast();
       });
     }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "components/config.hpp"
+#include "components/ticker.hpp"
 #include "modules/meta/base.hpp"
 
 POLYBAR_NS
@@ -10,39 +12,88 @@ namespace modules {
   template <class Impl>
   class timer_module : public module<Impl> {
    public:
-    using module<Impl>::module;
+    timer_module(const bar_settings bar, string name) : module<Impl>(bar, move(name)), m_ticker(ticker::make()) {
+      m_align = this->m_conf.get(
+          this->name(), "align-interval", this->m_conf.get("settings", "align-intervals", m_align));
+    }
 
     void start() {
-      this->m_mainthread = thread(&timer_module::runner, this);
+      // Blocking updates would hold up the other modules on the same tick
+      if (!m_align || this->m_blocking) {
+        this->add_timer(0s, m_interval, [this] { runner(); });
+        return;
+      }
+
+      // Warm up module output, wakeup() runs it again
+      m_runner = this->add_timer(0s, 0s, [this] { runner(); });
+      m_tick = m_ticker.add(m_interval, [this] { return tick(); });
+    }
+
+    void stop() {
+      m_ticker.remove(m_tick);
+      module<Impl>::stop();
     }
 
    protected:
     void runner() {
-      this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
-
-      const auto check = [&]() -> bool {
+      try {
         std::unique_lock<std::mutex> guard(this->m_updatelock);
-        return CAST_MOD(Impl)->update();
-      };
+        bool changed{this->running() && this->timed_update([this] { return CAST_MOD(Impl)->update(); })};
+        guard.unlock();
+
+        // Always broadcast the first update to warm up the module output
+        if (changed || !m_warmedup.exchange(true)) {
+          CAST_MOD(Impl)->broadcast();
+        }
+      } catch (const exception& err) {
+        CAST_MOD(Impl)->halt(err.what());
+      }
+    }
+
+    /**
+     * Update on a shared tick, the ticker notifies the controller once for all modules
+     */
+    bool tick() {
+      // The module turned blocking after it started, update on its own source instead
+      if (this->m_blocking) {
+        this->m_reactor.trigger(m_runner);
+        return false;
+      }
+
+      time_util::stopwatch watch{this->m_stats.cpu_time, true};
 
       try {
-        // warm up module output before entering the loop
-        check();
-        CAST_MOD(Impl)->broadcast();
-
-        while (this->running()) {
-          if (check()) {
-            CAST_MOD(Impl)->broadcast();
-          }
-          CAST_MOD(Impl)->sleep(m_interval);
+        std::lock_guard<std::mutex> guard(this->m_updatelock);
+        if (this->running() && this->timed_update([this] { return CAST_MOD(Impl)->update(); })) {
+          this->invalidate();
+          return true;
         }
       } catch (const exception& err) {
         CAST_MOD(Impl)->halt(err.what());
       }
+      return false;
+    }
+
+    /**
+     * Max age of a shared sample that still counts as taken on the current tick
+     */
+    interval_t sample_age() const {
+      return m_interval / 10;
     }
 
    protected:
     interval_t m_interval{1.0};
+
+    /**
+     * Update on wall clock boundaries of the interval, shared with other modules
+     */
+    bool m_align{false};
+
+   private:
+    ticker& m_ticker;
+    ticker::handle_t m_tick{0};
+    reactor::handle_t m_runner{0};
+    atomic<bool> m_warmedup{false};
   };
 }
 
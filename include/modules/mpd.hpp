@@ -18,11 +18,12 @@ namespace modules {
 
     void teardown();
     inline bool connected() const;
-    void idle();
     bool has_event();
+    vector<int> get_poll_fds();
+    chrono::duration<double> get_poll_timeout();
     bool update();
     string get_format() const;
-    string get_output();
+    display_list get_output();
     bool build(builder* builder, const string& tag) const;
 
    protected:
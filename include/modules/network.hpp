@@ -1,6 +1,7 @@
 #pragma once
 
 #include "adapters/net.hpp"
+#include "adapters/probe.hpp"
 #include "components/config.hpp"
 #include "modules/meta/timer_module.hpp"
 
@@ -13,13 +14,18 @@ namespace modules {
    public:
     explicit network_module(const bar_settings&, string);
 
+    void start();
     void teardown();
     bool update();
     string get_format() const;
     bool build(builder* builder, const string& tag) const;
 
    protected:
-    void subthread_routine();
+    void animate_packetloss();
+    void process_events(const function<bool()>& handler);
+    net::network* get_network() const;
+    void check_connectivity(net::network* network);
+    void finish_probe();
 
    private:
     static constexpr auto FORMAT_CONNECTED = "format-connected";
@@ -35,6 +41,13 @@ namespace modules {
     net::wired_t m_wired;
     net::wireless_t m_wireless;
 
+    /**
+     * \brief Native connectivity check, the ping command is used if it's not permitted
+     */
+    unique_ptr<net::probe> m_probe;
+    reactor::handle_t m_probesource{0};
+    reactor::handle_t m_probetimer{0};
+
     ramp_t m_ramp_signal;
     ramp_t m_ramp_quality;
     animation_t m_animation_packetloss;
@@ -47,7 +60,14 @@ namespace modules {
     int m_quality{0};
     int m_counter{-1};  // -1 to ignore the first run
 
+    /**
+     * \brief Values shown by the last update
+     */
+    vector<string> m_values;
+
     string m_interface;
+    string m_ping_host;
+    interval_t m_ping_timeout{0};
     int m_ping_nth_update{0};
     int m_udspeed_minwidth{0};
     bool m_accumulate{false};
@@ -18,9 +18,10 @@ namespace modules {
 
     void teardown();
     bool has_event();
+    vector<int> get_poll_fds();
     bool update();
     string get_format() const;
-    string get_output();
+    display_list get_output();
     bool build(builder* builder, const string& tag) const;
 
    protected:
@@ -14,13 +14,21 @@ namespace modules {
 
     void start();
     void stop();
+    void teardown();
 
-    string get_output();
+    display_list get_output();
     bool build(builder* builder, const string& tag) const;
 
    protected:
     chrono::duration<double> process(const mutex_wrapper<function<chrono::duration<double>()>>& handler) const;
-    bool check_condition();
+    void run();
+    void read_condition();
+    void execute(bool condition);
+    void read_tail();
+    void publish();
+    void publish_latest();
+    void read_exit();
+    chrono::duration<double> read_output();
 
    private:
     static constexpr const char* TAG_LABEL{"<label>"};
@@ -28,6 +36,8 @@ namespace modules {
     mutex_wrapper<function<chrono::duration<double>()>> m_handler;
 
     unique_ptr<command<output_policy::REDIRECTED>> m_command;
+    unique_ptr<command<output_policy::IGNORED>> m_condition;
+    unique_ptr<io_util::line_reader> m_lines;
 
     bool m_tail;
 
@@ -42,7 +52,17 @@ namespace modules {
     string m_prev;
     int m_counter{0};
 
-    bool m_stopping{false};
+    /**
+     * Latest line of the tail command and when it may be published next
+     */
+    string m_latest;
+    chrono::duration<double> m_updateinterval{0};
+    chrono::steady_clock::time_point m_nextupdate{};
+    bool m_deferred{false};
+
+    reactor::handle_t m_timer{0};
+    reactor::handle_t m_publisher{0};
+    atomic<bool> m_stopping{false};
   };
 }
 
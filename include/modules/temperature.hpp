@@ -2,6 +2,7 @@
 
 #include <istream>
 
+#include "components/sampler.hpp"
 #include "settings.hpp"
 #include "modules/meta/timer_module.hpp"
 
@@ -28,6 +29,7 @@ namespace modules {
     ramp_t m_ramp;
 
     string m_path;
+    shared_ptr<sampled_file> m_file;
     int m_zone = 0;
     // Base temperature used for where to start the ramp
     int m_tempbase = 0;
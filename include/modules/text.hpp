@@ -11,7 +11,7 @@ namespace modules {
 
     void update() {}
     string get_format() const;
-    string get_output();
+    display_list get_output();
   };
 }
 
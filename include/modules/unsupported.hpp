@@ -26,9 +26,15 @@ namespace modules {
     void start() {}                                                                     \
     void stop() {}                                                                      \
     void halt(string) {}                                                                \
-    string contents() {                                                                 \
-      return "";                                                                        \
+    display_list contents() {                                                           \
+      return {};                                                                        \
+    }                                                                                   \
+    const module_stats& stats() const {                                                 \
+      return m_stats;                                                                   \
     }                                                                                   \
+                                                                                        \
+   private:                                                                             \
+    module_stats m_stats;                                                               \
   }
 
 #if not ENABLE_I3
@@ -32,7 +32,7 @@ namespace modules {
     explicit xbacklight_module(const bar_settings& bar, string name_);
 
     void update();
-    string get_output();
+    display_list get_output();
     bool build(builder* builder, const string& tag) const;
 
    protected:
@@ -24,7 +24,7 @@ namespace modules {
    public:
     explicit xkeyboard_module(const bar_settings& bar, string name_);
 
-    string get_output();
+    display_list get_output();
     void update();
     bool build(builder* builder, const string& tag) const;
 
@@ -65,7 +65,7 @@ extern const char* const PATH_BACKLIGHT;
 extern const char* const PATH_BATTERY;
 extern const char* const PATH_CPU_INFO;
 extern const char* const PATH_MEMORY_INFO;
-extern const char* const PATH_MESSAGING_FIFO;
+extern const char* const PATH_MESSAGING_SOCKET;
 extern const char* const PATH_TEMPERATURE_INFO;
 extern const char* const WIRELESS_LIB;
 
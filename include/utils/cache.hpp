@@ -1,5 +1,6 @@
 #pragma once
 
+#include <list>
 #include <unordered_map>
 
 #include "common.hpp"
@@ -32,4 +33,64 @@ class cache {
   safe_map_type m_cache;
 };
 
+/**
+ * Cache holding at most `capacity` values, evicting the least recently used
+ * value when full
+ *
+ * Not thread-safe
+ */
+template <typename ValueType, typename KeyType, typename Hash = std::hash<KeyType>>
+class lru_cache {
+ public:
+  explicit lru_cache(size_t capacity) : m_capacity(capacity) {}
+
+  /**
+   * Get the cached value for the given key and mark it as recently used
+   *
+   * Returns nullptr if the key is not cached
+   */
+  ValueType* find(const KeyType& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+      return nullptr;
+    }
+    m_items.splice(m_items.begin(), m_items, it->second);
+    return &it->second->second;
+  }
+
+  /**
+   * Cache the value for the given key, replacing any existing value
+   */
+  ValueType& insert(const KeyType& key, ValueType&& value) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+      m_items.erase(it->second);
+      m_index.erase(it);
+    } else if (m_index.size() >= m_capacity && !m_items.empty()) {
+      m_index.erase(m_items.back().first);
+      m_items.pop_back();
+    }
+
+    m_items.emplace_front(key, forward<ValueType>(value));
+    m_index.emplace(key, m_items.begin());
+    return m_items.front().second;
+  }
+
+  void clear() {
+    m_index.clear();
+    m_items.clear();
+  }
+
+  size_t size() const {
+    return m_index.size();
+  }
+
+ private:
+  using list_type = std::list<pair<KeyType, ValueType>>;
+
+  size_t m_capacity;
+  list_type m_items;
+  std::unordered_map<KeyType, typename list_type::iterator, Hash> m_index;
+};
+
 POLYBAR_NS_END
@@ -16,6 +16,7 @@ DEFINE_ERROR(command_error);
 /**
  * Wrapper used to execute command in a subprocess.
  * In-/output streams are opened to enable ipc.
+ * The process is spawned with process_util::spawn(), see there for when the shell is used.
  * If the command is created using command_util::make_command<output_policy::REDIRECTED>, the child streams are
  * redirected and you can read the program output or write into the program input.
  *
@@ -70,6 +71,7 @@ class command<output_policy::IGNORED> {
 
   pid_t get_pid();
   int get_exit_status();
+  int get_pidfd();
 
  protected:
   const logger& m_log;
@@ -78,6 +80,7 @@ class command<output_policy::IGNORED> {
 
   pid_t m_forkpid{};
   int m_forkstatus = - 1;
+  int m_pidfd{-1};
 };
 
 template <>
@@ -96,6 +99,7 @@ class command<output_policy::REDIRECTED> : private command<output_policy::IGNORE
 
   using command<output_policy::IGNORED>::get_pid;
   using command<output_policy::IGNORED>::get_exit_status;
+  using command<output_policy::IGNORED>::get_pidfd;
 
   void tail(callback<string> cb);
   int writeline(string data);
@@ -7,7 +7,7 @@ POLYBAR_NS
 
 class http_downloader {
  public:
-  http_downloader(int connection_timeout = 5);
+  http_downloader(int connection_timeout = 5, int timeout = 30);
   ~http_downloader();
 
   string get(const string& url, const string& user = "", const string& password = "");
@@ -22,6 +22,29 @@ namespace io_util {
 
   void set_block(int fd);
   void set_nonblock(int fd);
+
+  /**
+   * Buffered reader for the output of a process
+   *
+   * Reads everything that is available without blocking and only keeps the
+   * latest complete line, intermediate lines are dropped
+   */
+  class line_reader {
+   public:
+    explicit line_reader(int fd);
+
+    bool read();
+    bool latest(string& line);
+
+   protected:
+    void append(const char* data, size_t size);
+
+   private:
+    int m_fd;
+    string m_partial;
+    string m_line;
+    bool m_changed{false};
+  };
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+/**
+ * Parsers for procfs files
+ *
+ * They work on the contents of the file as it was read, e.g. a sample of the
+ * sampler, and don't allocate once the output vectors reached their size
+ */
+namespace proc_util {
+  /**
+   * Times spent by a core, in USER_HZ
+   */
+  struct cpu_time {
+    unsigned long long user{0};
+    unsigned long long nice{0};
+    unsigned long long system{0};
+    unsigned long long idle{0};
+    unsigned long long steal{0};
+    unsigned long long total{0};
+  };
+
+  /**
+   * Memory values of /proc/meminfo, in kB
+   */
+  struct meminfo {
+    unsigned long long total{0};
+    unsigned long long free{0};
+    unsigned long long available{0};
+    unsigned long long buffers{0};
+    unsigned long long cached{0};
+    unsigned long long sreclaimable{0};
+    unsigned long long shmem{0};
+    unsigned long long swap_total{0};
+    unsigned long long swap_free{0};
+
+    /**
+     * \brief Set if the kernel (3.14+) reports MemAvailable
+     */
+    bool has_available{false};
+  };
+
+  /**
+   * Part of the parsed buffer
+   */
+  struct field {
+    const char* data{nullptr};
+    size_t size{0};
+
+    bool operator==(const string& other) const;
+    bool operator!=(const string& other) const;
+    string str() const;
+  };
+
+  /**
+   * Line of /proc/self/mountinfo
+   *
+   * The fields point into the parsed buffer, special characters in the
+   * mountpoint are still escaped as octal sequences (e.g. \040 for a space)
+   */
+  struct mount_entry {
+    field mountpoint;
+    field type;
+    field source;
+  };
+
+  bool parse_stat(const string& data, vector<cpu_time>& cores);
+  bool parse_meminfo(const string& data, meminfo& info);
+  bool parse_net_dev(const string& data, unsigned long long& received, unsigned long long& transmitted);
+
+  /**
+   * Iterates over the entries of /proc/self/mountinfo
+   */
+  class mountinfo_parser {
+   public:
+    explicit mountinfo_parser(const string& data);
+
+    bool next(mount_entry& entry);
+
+   private:
+    const char* m_pos;
+    const char* m_end;
+  };
+}  // namespace proc_util
+
+POLYBAR_NS_END
@@ -13,6 +13,10 @@ namespace process_util {
   void exec(char* cmd, char** args);
   void exec_sh(const char* cmd);
 
+  bool split_command(const string& cmd, vector<string>& args);
+  pid_t spawn(const string& cmd, int stdin_fd = -1, int stdout_fd = -1);
+  int open_pidfd(pid_t pid);
+
   pid_t wait_for_completion(pid_t process_id, int* status_addr, int waitflags = 0);
   pid_t wait_for_completion(int* status_addr, int waitflags = 0);
   pid_t wait_for_completion(pid_t process_id);
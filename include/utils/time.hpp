@@ -1,5 +1,8 @@
 #pragma once
 
+#include <time.h>
+
+#include <atomic>
 #include <chrono>
 
 #include "common.hpp"
@@ -18,6 +21,45 @@ namespace time_util {
     auto finish = clock_t::now();
     return chrono::duration_cast<Duration>(finish - start).count();
   }
+
+  /**
+   * CPU time consumed by the calling thread
+   */
+  inline chrono::nanoseconds thread_cputime() noexcept {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return chrono::seconds{ts.tv_sec} + chrono::nanoseconds{ts.tv_nsec};
+  }
+
+  /**
+   * Adds the time elapsed during its lifetime to a nanosecond counter
+   *
+   * \brief Measures the CPU time of the calling thread instead of wall time if cputime is set
+   */
+  class stopwatch {
+   public:
+    explicit stopwatch(std::atomic<uint64_t>& counter, bool cputime = false)
+        : m_counter(counter), m_cputime(cputime), m_start(now()) {}
+
+    ~stopwatch() {
+      m_counter += static_cast<uint64_t>((now() - m_start).count());
+    }
+
+    stopwatch(const stopwatch&) = delete;
+    stopwatch& operator=(const stopwatch&) = delete;
+
+   private:
+    chrono::nanoseconds now() const noexcept {
+      if (m_cputime) {
+        return thread_cputime();
+      }
+      return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch());
+    }
+
+    std::atomic<uint64_t>& m_counter;
+    bool m_cputime;
+    chrono::nanoseconds m_start;
+  };
 }
 
 POLYBAR_NS_END
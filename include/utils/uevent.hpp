@@ -0,0 +1,46 @@
+#pragma once
+
+#include <map>
+
+#include "common.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+/**
+ * Kernel device event, e.g. "change@/devices/.../power_supply/AC"
+ */
+struct uevent {
+  string action;
+  string devpath;
+  std::map<string, string> properties;
+
+  string property(const string& key) const;
+};
+
+/**
+ * Socket receiving the device events of the kernel (NETLINK_KOBJECT_UEVENT)
+ */
+class uevent_socket {
+ public:
+  explicit uevent_socket();
+  ~uevent_socket();
+
+  bool receive(uevent& event);
+  int get_file_descriptor() const;
+
+ protected:
+  int m_fd{-1};
+  vector<char> m_buffer;
+};
+
+namespace uevent_util {
+  bool parse(const char* data, size_t size, uevent& event);
+
+  template <typename... Args>
+  decltype(auto) make_socket(Args&&... args) {
+    return factory_util::unique<uevent_socket>(forward<Args>(args)...);
+  }
+}  // namespace uevent_util
+
+POLYBAR_NS_END
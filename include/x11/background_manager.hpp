@@ -68,8 +68,8 @@ class background_manager : public signal_receiver<SIGN_PRIORITY_SCREEN, signals:
                            public xpp::event::sink<evt::property_notify>
 {
  public:
-  using make_type = background_manager&;
-  static make_type make();
+  using make_type = unique_ptr<background_manager>;
+  static make_type make(connection& conn, signal_emitter& sig);
 
   /**
    * Initializes a new background_manager that by default does not observe anything.
@@ -33,6 +33,7 @@ namespace chrono = std::chrono;
 using namespace std::chrono_literals;
 
 // fwd declarations
+class config;
 class connection;
 struct xembed_data;
 class background_manager;
@@ -71,9 +72,10 @@ class tray_manager
       public signal_receiver<SIGN_PRIORITY_TRAY, signals::ui::visibility_change, signals::ui::dim_window, signals::ui::update_background> {
  public:
   using make_type = unique_ptr<tray_manager>;
-  static make_type make();
+  static make_type make(connection& conn, signal_emitter& emitter, const config& conf, background_manager& back);
 
-  explicit tray_manager(connection& conn, signal_emitter& emitter, const logger& logger, background_manager& back);
+  explicit tray_manager(connection& conn, signal_emitter& emitter, const logger& logger, const config& conf,
+      background_manager& back);
 
   ~tray_manager();
 
@@ -140,6 +142,7 @@ class tray_manager
   connection& m_connection;
   signal_emitter& m_sig;
   const logger& m_log;
+  const config& m_conf;
   background_manager& m_background_manager;
   std::shared_ptr<bg_slice> m_bg_slice;
   vector<shared_ptr<tray_client>> m_clients;
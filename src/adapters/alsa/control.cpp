@@ -116,6 +116,22 @@ namespace alsa {
   void control::process_events() {
     wait(0);
   }
+
+  /**
+   * Get the file descriptors that become readable when the control has events
+   */
+  vector<int> control::get_poll_fds() {
+    assert(m_ctl);
+
+    vector<struct pollfd> pfds(snd_ctl_poll_descriptors_count(m_ctl));
+    int count{snd_ctl_poll_descriptors(m_ctl, pfds.data(), pfds.size())};
+
+    vector<int> fds;
+    for (int i = 0; i < count; i++) {
+      fds.emplace_back(pfds[i].fd);
+    }
+    return fds;
+  }
 }
 
 POLYBAR_NS_END
@@ -92,6 +92,22 @@ namespace alsa {
     return num_events;
   }
 
+  /**
+   * Get the file descriptors that become readable when the mixer has events
+   */
+  vector<int> mixer::get_poll_fds() {
+    assert(m_mixer);
+
+    vector<struct pollfd> pfds(snd_mixer_poll_descriptors_count(m_mixer));
+    int count{snd_mixer_poll_descriptors(m_mixer, pfds.data(), pfds.size())};
+
+    vector<int> fds;
+    for (int i = 0; i < count; i++) {
+      fds.emplace_back(pfds[i].fd);
+    }
+    return fds;
+  }
+
   /**
    * Get volume in percentage
    */
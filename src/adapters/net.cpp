@@ -1,23 +1,33 @@
 #include "adapters/net.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iomanip>
 
 #include <arpa/inet.h>
 #include <linux/ethtool.h>
+#include <linux/if.h>
 #include <linux/if_link.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 #include <linux/sockios.h>
 #include <net/if.h>
-#include <netdb.h>
 #include <netinet/in.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 
 #include "common.hpp"
+#include "components/sampler.hpp"
 #include "settings.hpp"
 #include "utils/command.hpp"
 #include "utils/file.hpp"
+#include "utils/proc.hpp"
 #include "utils/string.hpp"
 
+#ifndef NETLINK_GET_STRICT_CHK
+#define NETLINK_GET_STRICT_CHK 12
+#endif
+
 POLYBAR_NS
 
 namespace net {
@@ -30,13 +40,29 @@ namespace net {
 
   static const string NO_IP = string("N/A");
 
+  /**
+   * Get the interface name of a link message
+   */
+  static string link_name(const nlmsghdr* msg) {
+    auto link = static_cast<const ifinfomsg*>(NLMSG_DATA(msg));
+    auto len = IFLA_PAYLOAD(msg);
+
+    for (auto attr = IFLA_RTA(link); RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+      if (attr->rta_type == IFLA_IFNAME) {
+        return static_cast<const char*>(RTA_DATA(attr));
+      }
+    }
+
+    return "";
+  }
+
   // class : network {{{
 
   /**
    * Construct network interface
    */
   network::network(string interface) : m_log(logger::make()), m_interface(move(interface)) {
-    if (if_nametoindex(m_interface.c_str()) == 0) {
+    if ((m_ifindex = if_nametoindex(m_interface.c_str())) == 0) {
       throw network_error("Invalid network interface \"" + m_interface + "\"");
     }
 
@@ -45,90 +71,285 @@ namespace net {
       throw network_error("Failed to open socket");
     }
 
+    m_eventfd = file_util::make_file_descriptor(
+        socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE));
+    m_requestfd = file_util::make_file_descriptor(socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE));
+    if (!*m_eventfd || !*m_requestfd) {
+      throw network_error("Failed to open netlink socket");
+    }
+
+    sockaddr_nl addr{};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+    if (bind(*m_eventfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+      throw network_error("Failed to subscribe to interface changes (" + string{strerror(errno)} + ")");
+    }
+
+    // Let the kernel only dump the addresses of the interface (Linux 4.20+)
+    int enable{1};
+    setsockopt(*m_requestfd, SOL_NETLINK, NETLINK_GET_STRICT_CHK, &enable, sizeof(enable));
+
+    // Don't block the module forever if the kernel doesn't answer
+    timeval timeout{1, 0};
+    setsockopt(*m_requestfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    m_buffer.resize(32768);
+
+    auto& files = sampler::make();
+    m_rxbytes = files.open("/sys/class/net/" + m_interface + "/statistics/rx_bytes");
+    m_txbytes = files.open("/sys/class/net/" + m_interface + "/statistics/tx_bytes");
+    m_netdev = files.open("/proc/net/dev");
+
     check_tuntap_or_bridge();
   }
 
+  network::~network() {}
+
   /**
    * Query device driver for information
+   *
+   * The link state and the addresses are only requested again if they changed
    */
   bool network::query(bool accumulate) {
+    if (m_linkchanged) {
+      ifinfomsg link{};
+      link.ifi_family = AF_UNSPEC;
+      link.ifi_index = m_ifindex;
+
+      bool found{request(RTM_GETLINK, &link, sizeof(link), false)};
+
+      // The interface might have been created again with a new index
+      if (!found && resolve_index()) {
+        link.ifi_index = m_ifindex;
+        found = request(RTM_GETLINK, &link, sizeof(link), false);
+      }
+
+      if (!found) {
+        m_operstate = IF_OPER_DOWN;
+        return false;
+      }
+
+      m_linkchanged = false;
+    }
+
+    if (m_addrchanged) {
+      m_addrchanged = false;
+      m_status.ip = NO_IP;
+      m_status.ip6 = NO_IP;
+
+      ifaddrmsg address{};
+      address.ifa_family = AF_UNSPEC;
+      address.ifa_index = m_ifindex;
+
+      if (!request(RTM_GETADDR, &address, sizeof(address), true)) {
+        m_addrchanged = true;
+        return false;
+      }
+    }
+
     m_status.previous = m_status.current;
-    m_status.current.transmitted = 0;
-    m_status.current.received = 0;
     m_status.current.time = std::chrono::system_clock::now();
-    m_status.ip = NO_IP;
-    m_status.ip6 = NO_IP;
 
-    struct ifaddrs* ifaddr;
-    if (getifaddrs(&ifaddr) == -1 || ifaddr == nullptr) {
+    try {
+      if (accumulate) {
+        proc_util::parse_net_dev(m_netdev->read()->data, m_status.current.received, m_status.current.transmitted);
+      } else {
+        m_status.current.received = std::strtoull(m_rxbytes->read()->data.c_str(), nullptr, 10);
+        m_status.current.transmitted = std::strtoull(m_txbytes->read()->data.c_str(), nullptr, 10);
+      }
+    } catch (const system_error& err) {
+      m_log.warn("Failed to read traffic counters of %s (%s)", m_interface, err.what());
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Get the file descriptor that becomes readable when the interface changed
+   */
+  int network::get_file_descriptor() const {
+    return *m_eventfd;
+  }
+
+  /**
+   * Handle the pending change notifications
+   *
+   * Returns true if the state or the addresses of the interface changed
+   */
+  bool network::process_events() {
+    bool changed{false};
+
+    while (true) {
+      ssize_t bytes{recv(*m_eventfd, m_buffer.data(), m_buffer.size(), 0)};
+
+      if (bytes == -1 && errno == EINTR) {
+        continue;
+      } else if (bytes == -1 && errno == ENOBUFS) {
+        // Notifications were dropped, query everything again
+        m_linkchanged = m_addrchanged = changed = true;
+        continue;
+      } else if (bytes <= 0) {
+        break;
+      }
+
+      auto len = static_cast<unsigned int>(bytes);
+      for (auto msg = reinterpret_cast<nlmsghdr*>(m_buffer.data()); NLMSG_OK(msg, len); msg = NLMSG_NEXT(msg, len)) {
+        if (msg->nlmsg_type == RTM_NEWLINK || msg->nlmsg_type == RTM_DELLINK) {
+          auto link = static_cast<ifinfomsg*>(NLMSG_DATA(msg));
+          if (static_cast<unsigned int>(link->ifi_index) == m_ifindex) {
+            m_linkchanged = changed = true;
+          } else if (msg->nlmsg_type == RTM_NEWLINK && link_name(msg) == m_interface && resolve_index()) {
+            changed = true;
+          }
+        } else if (msg->nlmsg_type == RTM_NEWADDR || msg->nlmsg_type == RTM_DELADDR) {
+          auto address = static_cast<ifaddrmsg*>(NLMSG_DATA(msg));
+          if (address->ifa_index == m_ifindex) {
+            m_addrchanged = changed = true;
+          }
+        }
+      }
+    }
+
+    return changed;
+  }
+
+  /**
+   * Look up the index of the interface again
+   *
+   * Interfaces that are removed and created again (e.g. tun devices of a VPN or
+   * USB adapters) get a new index. Returns true if the index changed
+   */
+  bool network::resolve_index() {
+    unsigned int index{if_nametoindex(m_interface.c_str())};
+
+    if (index == 0 || index == m_ifindex) {
+      return false;
+    }
+
+    m_log.info("Interface %s was created again (index %u)", m_interface, index);
+    m_ifindex = index;
+    m_linkchanged = m_addrchanged = true;
+
+    // The traffic counters of the new device start at zero
+    m_status.current.received = 0;
+    m_status.current.transmitted = 0;
+
+    check_tuntap_or_bridge();
+    return true;
+  }
+
+  /**
+   * Send a request to the kernel and parse the link and address messages of the reply
+   */
+  bool network::request(int type, const void* payload, size_t size, bool dump) {
+    alignas(nlmsghdr) char packet[NLMSG_SPACE(sizeof(ifinfomsg))]{};
+    auto hdr = reinterpret_cast<nlmsghdr*>(packet);
+    hdr->nlmsg_len = NLMSG_LENGTH(size);
+    hdr->nlmsg_type = type;
+    hdr->nlmsg_flags = NLM_F_REQUEST | (dump ? NLM_F_DUMP : 0);
+    hdr->nlmsg_seq = ++m_sequence;
+    memcpy(NLMSG_DATA(hdr), payload, size);
+
+    if (send(*m_requestfd, packet, hdr->nlmsg_len, 0) == -1) {
+      m_log.warn("Failed to send netlink request for %s (%s)", m_interface, strerror(errno));
       return false;
     }
 
-    for (auto ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
-      if (ifa->ifa_addr == nullptr) {
+    while (true) {
+      ssize_t bytes{recv(*m_requestfd, m_buffer.data(), m_buffer.size(), 0)};
+
+      if (bytes == -1 && errno == EINTR) {
         continue;
+      } else if (bytes <= 0) {
+        m_log.warn("Failed to receive netlink reply for %s (%s)", m_interface, strerror(errno));
+        return false;
       }
 
-      if (m_interface.compare(0, m_interface.length(), ifa->ifa_name) != 0) {
-        if (!accumulate || (ifa->ifa_data == nullptr && ifa->ifa_addr->sa_family != AF_PACKET)) {
+      auto len = static_cast<unsigned int>(bytes);
+      for (auto msg = reinterpret_cast<nlmsghdr*>(m_buffer.data()); NLMSG_OK(msg, len); msg = NLMSG_NEXT(msg, len)) {
+        if (msg->nlmsg_seq != m_sequence) {
           continue;
+        } else if (msg->nlmsg_type == NLMSG_DONE) {
+          return true;
+        } else if (msg->nlmsg_type == NLMSG_ERROR) {
+          return static_cast<nlmsgerr*>(NLMSG_DATA(msg))->error == 0;
+        } else if (msg->nlmsg_type == RTM_NEWLINK) {
+          parse_link(msg);
+        } else if (msg->nlmsg_type == RTM_NEWADDR) {
+          parse_address(msg);
+        }
+
+        if (!(msg->nlmsg_flags & NLM_F_MULTI)) {
+          return true;
         }
       }
+    }
+  }
 
-      struct sockaddr_in6* sa6;
+  void network::parse_link(const nlmsghdr* msg) {
+    auto link = static_cast<const ifinfomsg*>(NLMSG_DATA(msg));
+    if (static_cast<unsigned int>(link->ifi_index) != m_ifindex) {
+      return;
+    }
 
-      switch (ifa->ifa_addr->sa_family) {
-        case AF_INET:
-          char ip_buffer[NI_MAXHOST];
-          getnameinfo(ifa->ifa_addr, sizeof(sockaddr_in), ip_buffer, NI_MAXHOST, nullptr, 0, NI_NUMERICHOST);
-          m_status.ip = string{ip_buffer};
-          break;
+    auto len = IFLA_PAYLOAD(msg);
+    for (auto attr = IFLA_RTA(link); RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+      if (attr->rta_type == IFLA_OPERSTATE) {
+        m_operstate = *static_cast<const unsigned char*>(RTA_DATA(attr));
+      }
+    }
+  }
 
-        case AF_INET6:
-          char ip6_buffer[INET6_ADDRSTRLEN];
-          sa6 = reinterpret_cast<decltype(sa6)>(ifa->ifa_addr);
-          if (IN6_IS_ADDR_LINKLOCAL(&sa6->sin6_addr)) {
-              continue;
-          }
-          if (IN6_IS_ADDR_SITELOCAL(&sa6->sin6_addr)) {
-              continue;
-          }
-          if ((((unsigned char*)sa6->sin6_addr.s6_addr)[0] & 0xFE) == 0xFC) {
-              /* Skip Unique Local Addresses (fc00::/7) */
-              continue;
-          }
-          if (inet_ntop(AF_INET6, &sa6->sin6_addr, ip6_buffer, INET6_ADDRSTRLEN) == 0) {
-              m_log.warn("inet_ntop() " + string(strerror(errno)));
-              continue;
-          }
-          m_status.ip6 = string{ip6_buffer};
-          break;
+  void network::parse_address(const nlmsghdr* msg) {
+    auto address = static_cast<const ifaddrmsg*>(NLMSG_DATA(msg));
+    if (address->ifa_index != m_ifindex) {
+      return;
+    }
 
-        case AF_PACKET:
-          if (ifa->ifa_data == nullptr) {
-            continue;
-          }
-          struct rtnl_link_stats* link_state = reinterpret_cast<decltype(link_state)>(ifa->ifa_data);
-          if (link_state == nullptr) {
-            continue;
-          }
-          m_status.current.transmitted += link_state->tx_bytes;
-          m_status.current.received += link_state->rx_bytes;
-          break;
+    const rtattr* local{nullptr};
+    const rtattr* peer{nullptr};
+
+    auto len = IFA_PAYLOAD(msg);
+    for (auto attr = IFA_RTA(address); RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+      if (attr->rta_type == IFA_LOCAL) {
+        local = attr;
+      } else if (attr->rta_type == IFA_ADDRESS) {
+        peer = attr;
       }
     }
 
-    freeifaddrs(ifaddr);
+    char buffer[INET6_ADDRSTRLEN];
 
-    return true;
+    // IFA_ADDRESS is the address of the other end on point-to-point links
+    if (address->ifa_family == AF_INET && (local || peer)) {
+      if (inet_ntop(AF_INET, RTA_DATA(local ? local : peer), buffer, sizeof(buffer)) != nullptr) {
+        m_status.ip = buffer;
+      }
+    } else if (address->ifa_family == AF_INET6 && peer) {
+      auto addr = static_cast<const in6_addr*>(RTA_DATA(peer));
+      if (IN6_IS_ADDR_LINKLOCAL(addr) || IN6_IS_ADDR_SITELOCAL(addr)) {
+        return;
+      } else if ((addr->s6_addr[0] & 0xFE) == 0xFC) {
+        /* Skip Unique Local Addresses (fc00::/7) */
+        return;
+      } else if (inet_ntop(AF_INET6, addr, buffer, sizeof(buffer)) == nullptr) {
+        m_log.warn("inet_ntop() " + string(strerror(errno)));
+        return;
+      }
+      m_status.ip6 = buffer;
+    }
   }
 
   /**
    * Run ping command to test internet connectivity
+   *
+   * The host has to be a numeric address, the timeout is rounded up to seconds
    */
-  bool network::ping() const {
+  bool network::ping(const string& host, std::chrono::duration<double> timeout) const {
     try {
-      auto exec = "ping -c 2 -W 2 -I " + m_interface + " " + string(CONNECTION_TEST_IP);
+      auto seconds = std::max(1, static_cast<int>(std::ceil(timeout.count())));
+      auto exec = "ping -c 2 -W " + to_string(seconds) + " -I " + m_interface + " " + host;
       auto ping = command_util::make_command<output_policy::IGNORED>(exec);
       return ping && ping->exec(true) == EXIT_SUCCESS;
     } catch (const std::exception& err) {
@@ -216,9 +437,8 @@ namespace net {
    * Test if the network interface is in a valid state
    */
   bool network::test_interface() const {
-    auto operstate = file_util::contents("/sys/class/net/" + m_interface + "/operstate");
-    bool up = operstate.compare(0, 2, "up") == 0;
-    return m_unknown_up ? (up || operstate.compare(0, 7, "unknown") == 0) : up;
+    bool up = m_operstate == IF_OPER_UP;
+    return m_unknown_up ? (up || m_operstate == IF_OPER_UNKNOWN) : up;
   }
 
   /**
@@ -226,7 +446,8 @@ namespace net {
    */
   string network::format_speedrate(float bytes_diff, int minwidth) const {
     const auto duration = m_status.current.time - m_status.previous.time;
-    float time_diff = std::chrono::duration_cast<std::chrono::seconds>(duration).count();
+    // Changes of the interface trigger queries in between the intervals
+    float time_diff = std::chrono::duration<float>(duration).count();
     float speedrate = bytes_diff / (time_diff ? time_diff : 1);
 
     vector<string> suffixes{"GB", "MB"};
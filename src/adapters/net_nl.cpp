@@ -11,6 +11,17 @@ POLYBAR_NS
 namespace net {
   // class : wireless_network {{{
 
+  wireless_network::wireless_network(string interface) : network(move(interface)) {
+    if (!open_sockets()) {
+      m_log.warn("Failed to open nl80211 session for %s, retrying on the next query", m_interface);
+    }
+  }
+
+  wireless_network::~wireless_network() {
+    nl_socket_free(m_nlevents);
+    nl_socket_free(m_nlsock);
+  }
+
   /**
    * Query the wireless device for information
    * about the current connection
@@ -20,50 +31,161 @@ namespace net {
       return false;
     }
 
-    struct nl_sock* sk = nl_socket_alloc();
-    if (sk == nullptr) {
+    if (m_nlsock == nullptr && !open_sockets()) {
       return false;
     }
 
-    if (genl_connect(sk) < 0) {
+    // Look up the access point again if the station is gone, e.g. after a missed roam
+    if (!m_bsschanged && query_station()) {
+      return true;
+    }
+
+    return query_scan();
+  }
+
+  /**
+   * Get the file descriptor that becomes readable on nl80211 connection events
+   *
+   * Returns -1 if the nl80211 session couldn't be opened
+   */
+  int wireless_network::get_nl80211_descriptor() const {
+    return m_nlevents ? nl_socket_get_fd(m_nlevents) : -1;
+  }
+
+  /**
+   * Handle the pending nl80211 events
+   *
+   * Returns true if the interface connected, disconnected or roamed
+   */
+  bool wireless_network::process_nl80211_events() {
+    m_eventchanged = false;
+
+    int err = nl_recvmsgs_default(m_nlevents);
+    if (err == -NLE_NOMEM) {
+      // The socket buffer overflowed and events were dropped
+      m_bsschanged = m_eventchanged = true;
+    }
+
+    return m_eventchanged;
+  }
+
+  /**
+   * Open the request socket and the socket subscribed to the mlme events
+   *
+   * The event socket is kept once it is open, its descriptor is watched by the module
+   */
+  bool wireless_network::open_sockets() {
+    if ((m_nlsock = nl_socket_alloc()) == nullptr || genl_connect(m_nlsock) < 0 ||
+        (m_driverid = genl_ctrl_resolve(m_nlsock, "nl80211")) < 0) {
+      nl_socket_free(m_nlsock);
+      m_nlsock = nullptr;
       return false;
     }
 
-    int driver_id = genl_ctrl_resolve(sk, "nl80211");
-    if (driver_id < 0) {
-      nl_socket_free(sk);
+    m_bsschanged = true;
+
+    // Without events the access point is looked up on every query
+    int group = genl_ctrl_resolve_grp(m_nlsock, "nl80211", "mlme");
+    if (m_nlevents != nullptr || group < 0 || (m_nlevents = nl_socket_alloc()) == nullptr) {
+      return true;
+    }
+
+    nl_socket_disable_seq_check(m_nlevents);
+
+    if (genl_connect(m_nlevents) < 0 || nl_socket_add_membership(m_nlevents, group) < 0 ||
+        nl_socket_set_nonblocking(m_nlevents) < 0 ||
+        nl_socket_modify_cb(m_nlevents, NL_CB_VALID, NL_CB_CUSTOM, event_cb, this) != 0) {
+      nl_socket_free(m_nlevents);
+      m_nlevents = nullptr;
+    }
+
+    return true;
+  }
+
+  /**
+   * Send the request and parse the replies with the callback
+   *
+   * Always frees msg
+   */
+  bool wireless_network::send_request(struct nl_msg* msg, int (*callback)(struct nl_msg*, void*)) {
+    if (m_nlsock == nullptr || nl_socket_modify_cb(m_nlsock, NL_CB_VALID, NL_CB_CUSTOM, callback, this) != 0) {
+      nlmsg_free(msg);
       return false;
     }
 
-    if (nl_socket_modify_cb(sk, NL_CB_VALID, NL_CB_CUSTOM, scan_cb, this) != 0) {
-      nl_socket_free(sk);
+    // nl_send_sync always frees msg
+    int err = nl_send_sync(m_nlsock, msg);
+    if (err == -NLE_BAD_SOCK || err == -NLE_NOMEM) {
+      // Reconnect on the next query, replies could be left in the socket buffer
+      nl_socket_free(m_nlsock);
+      m_nlsock = nullptr;
+    }
+
+    return err >= 0;
+  }
+
+  /**
+   * Look up the access point again if the interface was created again
+   */
+  bool wireless_network::resolve_index() {
+    if (!network::resolve_index()) {
       return false;
     }
+    m_bsschanged = true;
+    return true;
+  }
 
+  /**
+   * Look up the associated access point in the scan results
+   */
+  bool wireless_network::query_scan() {
     struct nl_msg* msg = nlmsg_alloc();
     if (msg == nullptr) {
-      nl_socket_free(sk);
       return false;
     }
 
-    if ((genlmsg_put(msg, NL_AUTO_PORT, NL_AUTO_SEQ, driver_id, 0, NLM_F_DUMP, NL80211_CMD_GET_SCAN, 0) == nullptr) ||
-        nla_put_u32(msg, NL80211_ATTR_IFINDEX, m_ifid) < 0) {
+    if ((genlmsg_put(msg, NL_AUTO_PORT, NL_AUTO_SEQ, m_driverid, 0, NLM_F_DUMP, NL80211_CMD_GET_SCAN, 0) == nullptr) ||
+        nla_put_u32(msg, NL80211_ATTR_IFINDEX, m_ifindex) < 0) {
       nlmsg_free(msg);
-      nl_socket_free(sk);
       return false;
     }
 
-    // nl_send_sync always frees msg
-    if (nl_send_sync(sk, msg) < 0) {
-      nl_socket_free(sk);
+    m_essid.clear();
+    m_bssid.clear();
+
+    if (!send_request(msg, scan_cb)) {
       return false;
     }
 
-    nl_socket_free(sk);
-
+    // Only keep the station queries if events tell us about roaming
+    m_bsschanged = m_nlevents == nullptr;
     return true;
   }
 
+  /**
+   * Refresh the signal strength of the associated access point
+   */
+  bool wireless_network::query_station() {
+    if (m_bssid.empty()) {
+      // Not connected, nothing to refresh until an event arrives
+      return true;
+    }
+
+    struct nl_msg* msg = nlmsg_alloc();
+    if (msg == nullptr) {
+      return false;
+    }
+
+    if ((genlmsg_put(msg, NL_AUTO_PORT, NL_AUTO_SEQ, m_driverid, 0, 0, NL80211_CMD_GET_STATION, 0) == nullptr) ||
+        nla_put_u32(msg, NL80211_ATTR_IFINDEX, m_ifindex) < 0 ||
+        nla_put(msg, NL80211_ATTR_MAC, m_bssid.size(), m_bssid.data()) < 0) {
+      nlmsg_free(msg);
+      return false;
+    }
+
+    return send_request(msg, station_cb);
+  }
+
   /**
    * Check current connection state
    */
@@ -131,6 +253,11 @@ namespace net {
       return NL_SKIP;
     }
 
+    if (bss[NL80211_BSS_BSSID] != nullptr) {
+      auto bssid = static_cast<unsigned char*>(nla_data(bss[NL80211_BSS_BSSID]));
+      wn->m_bssid.assign(bssid, bssid + nla_len(bss[NL80211_BSS_BSSID]));
+    }
+
     wn->parse_essid(bss);
     wn->parse_frequency(bss);
     wn->parse_signal(bss);
@@ -139,6 +266,67 @@ namespace net {
     return NL_SKIP;
   }
 
+  /**
+   * Callback to parse the station info of the access point
+   */
+  int wireless_network::station_cb(struct nl_msg* msg, void* instance) {
+    auto wn = static_cast<wireless_network*>(instance);
+    auto gnlh = static_cast<genlmsghdr*>(nlmsg_data(nlmsg_hdr(msg)));
+    struct nlattr* tb[NL80211_ATTR_MAX + 1];
+    struct nlattr* sinfo[NL80211_STA_INFO_MAX + 1];
+
+    struct nla_policy sinfo_policy[NL80211_STA_INFO_MAX + 1]{};
+    sinfo_policy[NL80211_STA_INFO_SIGNAL].type = NLA_U8;
+
+    if (nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0), genlmsg_attrlen(gnlh, 0), nullptr) < 0) {
+      return NL_SKIP;
+    }
+
+    if (tb[NL80211_ATTR_STA_INFO] == nullptr ||
+        nla_parse_nested(sinfo, NL80211_STA_INFO_MAX, tb[NL80211_ATTR_STA_INFO], sinfo_policy) != 0) {
+      return NL_SKIP;
+    }
+
+    if (sinfo[NL80211_STA_INFO_SIGNAL] != nullptr) {
+      // signal strength in dBm
+      wn->set_signal(static_cast<int8_t>(nla_get_u8(sinfo[NL80211_STA_INFO_SIGNAL])));
+    }
+
+    return NL_SKIP;
+  }
+
+  /**
+   * Callback to handle the mlme events of the interface
+   */
+  int wireless_network::event_cb(struct nl_msg* msg, void* instance) {
+    auto wn = static_cast<wireless_network*>(instance);
+    auto gnlh = static_cast<genlmsghdr*>(nlmsg_data(nlmsg_hdr(msg)));
+    struct nlattr* tb[NL80211_ATTR_MAX + 1];
+
+    if (nla_parse(tb, NL80211_ATTR_MAX, genlmsg_attrdata(gnlh, 0), genlmsg_attrlen(gnlh, 0), nullptr) < 0) {
+      return NL_SKIP;
+    }
+
+    if (tb[NL80211_ATTR_IFINDEX] == nullptr || nla_get_u32(tb[NL80211_ATTR_IFINDEX]) != wn->m_ifindex) {
+      return NL_SKIP;
+    }
+
+    switch (gnlh->cmd) {
+      case NL80211_CMD_CONNECT:
+      case NL80211_CMD_DISCONNECT:
+      case NL80211_CMD_ROAM:
+      case NL80211_CMD_JOIN_IBSS:
+      case NL80211_CMD_CH_SWITCH_NOTIFY:
+        wn->m_bsschanged = true;
+        wn->m_eventchanged = true;
+        break;
+      default:
+        break;
+    }
+
+    return NL_SKIP;
+  }
+
   /**
    * Check for a connection to a AP
    */
@@ -213,19 +401,24 @@ namespace net {
    */
   void wireless_network::parse_signal(struct nlattr** bss) {
     if (bss[NL80211_BSS_SIGNAL_MBM] != nullptr) {
-      // signalstrength in dBm
-      int signalstrength = static_cast<int>(nla_get_u32(bss[NL80211_BSS_SIGNAL_MBM])) / 100;
-
-      // WiFi-hardware usually operates in the range -90 to -20dBm.
-      const int hardware_max = -20;
-      const int hardware_min = -90;
-      signalstrength = std::max(hardware_min, std::min(signalstrength, hardware_max));
-
-      // Shift for positive values
-      m_signalstrength.val = signalstrength - hardware_min;
-      m_signalstrength.max = hardware_max - hardware_min;
+      // signalstrength in mBm
+      set_signal(static_cast<int>(nla_get_u32(bss[NL80211_BSS_SIGNAL_MBM])) / 100);
     }
   }
+
+  /**
+   * Set the signalstrength from a value in dBm
+   */
+  void wireless_network::set_signal(int dbm) {
+    // WiFi-hardware usually operates in the range -90 to -20dBm.
+    const int hardware_max = -20;
+    const int hardware_min = -90;
+    dbm = std::max(hardware_min, std::min(dbm, hardware_max));
+
+    // Shift for positive values
+    m_signalstrength.val = dbm - hardware_min;
+    m_signalstrength.max = hardware_max - hardware_min;
+  }
 }  // namespace net
 
 POLYBAR_NS_END
@@ -0,0 +1,261 @@
+#include "adapters/probe.hpp"
+
+#include <netdb.h>
+#include <net/if.h>
+#include <netinet/icmp6.h>
+#include <netinet/in.h>
+#include <netinet/ip_icmp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "utils/file.hpp"
+
+POLYBAR_NS
+
+namespace net {
+  /**
+   * Number of echo requests per probe, any reply counts as online
+   */
+  static constexpr int ECHO_COUNT{2};
+
+  /**
+   * Parse the address of the host, throws a probe_error if it isn't numeric
+   */
+  probe::probe(string host, unsigned short port, string interface, duration_t timeout, duration_t ttl)
+      : m_host(move(host)), m_port(port), m_interface(move(interface)), m_timeout(timeout), m_ttl(ttl) {
+    struct addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_flags = AI_NUMERICHOST;
+
+    struct addrinfo* result{nullptr};
+
+    if (getaddrinfo(m_host.c_str(), nullptr, &hints, &result) != 0 || result == nullptr) {
+      throw probe_error("Invalid address \"" + m_host + "\", host names are not supported");
+    }
+
+    memcpy(&m_address, result->ai_addr, result->ai_addrlen);
+    m_addresslen = result->ai_addrlen;
+    m_family = result->ai_family;
+    freeaddrinfo(result);
+  }
+
+  probe::~probe() {}
+
+  /**
+   * Start a new probe unless one is still running or the cached result is still valid
+   *
+   * Returns true if the probe has to be watched. Throws a probe_error if the
+   * system doesn't allow unprivileged ICMP sockets (see net.ipv4.ping_group_range)
+   */
+  bool probe::start() {
+    if (running() || (m_cached && clock::now() - m_finished < m_ttl)) {
+      return false;
+    }
+
+    if (!connect_to()) {
+      finish(false);
+      close();
+      return false;
+    }
+
+    m_pending = true;
+    m_deadline = clock::now() + chrono::duration_cast<clock::duration>(m_timeout);
+    return true;
+  }
+
+  /**
+   * Check the running probe without blocking
+   *
+   * Returns true once the probe completed or timed out, the socket stays open until close()
+   */
+  bool probe::process() {
+    if (!m_pending) {
+      return true;
+    }
+
+    if (m_port) {
+      pollfd pfd{*m_fd, POLLOUT, 0};
+
+      if (poll(&pfd, 1, 0) > 0) {
+        int err{0};
+        socklen_t len{sizeof(err)};
+        getsockopt(*m_fd, SOL_SOCKET, SO_ERROR, &err, &len);
+
+        // A refused connection still means the host was reached
+        finish(err == 0 || err == ECONNREFUSED);
+        return true;
+      }
+    } else {
+      int err{0};
+
+      if (receive_echo(m_family)) {
+        finish(true);
+        return true;
+      } else if ((err = errno) != EAGAIN && err != EWOULDBLOCK) {
+        finish(false);
+        return true;
+      }
+    }
+
+    if (clock::now() >= m_deadline) {
+      finish(false);
+      return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * Close the socket of the completed probe
+   *
+   * Kept open until then so the descriptor can't be reused while it is still watched
+   */
+  void probe::close() {
+    m_fd.reset();
+  }
+
+  /**
+   * Drop the cached result, e.g. after the interface reconnected
+   */
+  void probe::invalidate() {
+    m_cached = false;
+  }
+
+  /**
+   * Check if the socket of a probe is open, i.e. the last probe is still running or wasn't closed yet
+   */
+  bool probe::running() const {
+    return m_fd && *m_fd;
+  }
+
+  /**
+   * Result of the last completed probe
+   */
+  bool probe::online() const {
+    return m_online;
+  }
+
+  probe::duration_t probe::timeout() const {
+    return m_timeout;
+  }
+
+  /**
+   * Get the descriptor of the running probe, -1 if none is running
+   */
+  int probe::get_file_descriptor() const {
+    return running() ? static_cast<int>(*m_fd) : -1;
+  }
+
+  /**
+   * Get the epoll events that signal progress of the probe
+   */
+  unsigned int probe::get_events() const {
+    return m_port ? EPOLLOUT : EPOLLIN;
+  }
+
+  /**
+   * Open the socket and send the echo requests or start the connection
+   */
+  bool probe::connect_to() {
+    int type{(m_port ? SOCK_STREAM : SOCK_DGRAM) | SOCK_NONBLOCK | SOCK_CLOEXEC};
+    int protocol{IPPROTO_TCP};
+    if (!m_port && m_family == AF_INET6) {
+      protocol = IPPROTO_ICMPV6;
+    } else if (!m_port) {
+      protocol = IPPROTO_ICMP;
+    }
+    int fd{socket(m_family, type, protocol)};
+
+    if (fd == -1) {
+      if (!m_port && (errno == EACCES || errno == EPERM || errno == EPROTONOSUPPORT)) {
+        throw probe_error("Unprivileged ICMP sockets are not permitted (" + string{strerror(errno)} + ")");
+      }
+      return false;
+    }
+
+    m_fd = file_util::make_file_descriptor(fd);
+
+    // Not allowed without CAP_NET_RAW on kernels before 5.7, the routing table decides then
+    if (!m_interface.empty()) {
+      setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, m_interface.c_str(), m_interface.size());
+    }
+
+    struct sockaddr_storage addr {m_address};
+
+    if (m_family == AF_INET) {
+      reinterpret_cast<sockaddr_in*>(&addr)->sin_port = htons(m_port);
+    } else if (m_family == AF_INET6) {
+      reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port = htons(m_port);
+    }
+
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), m_addresslen) == -1 && errno != EINPROGRESS) {
+      return false;
+    }
+
+    if (!m_port) {
+      for (int i = 0; i < ECHO_COUNT; i++) {
+        if (!send_echo(m_family)) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Send an echo request, the kernel sets the identifier and the checksum
+   */
+  bool probe::send_echo(int family) {
+    m_sequence++;
+
+    if (family == AF_INET6) {
+      struct icmp6_hdr request {};
+      request.icmp6_type = ICMP6_ECHO_REQUEST;
+      request.icmp6_seq = htons(m_sequence);
+      return send(*m_fd, &request, sizeof(request), 0) != -1;
+    }
+
+    struct icmphdr request {};
+    request.type = ICMP_ECHO;
+    request.un.echo.sequence = htons(m_sequence);
+    return send(*m_fd, &request, sizeof(request), 0) != -1;
+  }
+
+  /**
+   * Read the pending replies, returns true if one of them is an echo reply
+   *
+   * The connected socket only receives replies from the probed host
+   */
+  bool probe::receive_echo(int family) {
+    char buffer[256];
+    ssize_t bytes;
+
+    while ((bytes = recv(*m_fd, buffer, sizeof(buffer), 0)) != -1) {
+      if (family == AF_INET6 && static_cast<size_t>(bytes) >= sizeof(icmp6_hdr)) {
+        if (reinterpret_cast<icmp6_hdr*>(buffer)->icmp6_type == ICMP6_ECHO_REPLY) {
+          return true;
+        }
+      } else if (family == AF_INET && static_cast<size_t>(bytes) >= sizeof(icmphdr)) {
+        if (reinterpret_cast<icmphdr*>(buffer)->type == ICMP_ECHOREPLY) {
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+  void probe::finish(bool online) {
+    m_pending = false;
+    m_online = online;
+    m_cached = true;
+    m_finished = clock::now();
+  }
+}  // namespace net
+
+POLYBAR_NS_END
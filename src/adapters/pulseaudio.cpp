@@ -1,3 +1,6 @@
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 #include "adapters/pulseaudio.hpp"
 #include "components/logger.hpp"
 
@@ -71,6 +74,8 @@ pulseaudio::pulseaudio(const logger& logger, string&& sink_name, bool max_volume
   wait_loop(op, m_mainloop);
   if (!success)
     throw pulseaudio_error("Failed to subscribe to sink.");
+  if ((m_eventfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1)
+    throw pulseaudio_error("Could not create event fd.");
   pa_context_set_subscribe_callback(m_context, subscribe_callback, this);
 
   update_volume(op);
@@ -87,7 +92,9 @@ pulseaudio::~pulseaudio() {
   pa_context_disconnect(m_context);
   pa_context_unref(m_context);
   pa_threaded_mainloop_free(m_mainloop);
-
+  if (m_eventfd != -1) {
+    close(m_eventfd);
+  }
 }
 
 /**
@@ -101,9 +108,20 @@ const string& pulseaudio::get_name() {
  * Wait for events
  */
 bool pulseaudio::wait() {
+  uint64_t count;
+  if (read(m_eventfd, &count, sizeof(count)) == -1 && errno != EAGAIN) {
+    m_log.err("pulseaudio: Failed to read event fd (%s)", strerror(errno));
+  }
   return m_events.size() > 0;
 }
 
+/**
+ * Get the fd that becomes readable when events are queued
+ */
+int pulseaudio::get_event_fd() const {
+  return m_eventfd;
+}
+
 /**
  * Process queued pulseaudio events
  */
@@ -275,6 +293,11 @@ void pulseaudio::subscribe_callback(pa_context *, pa_subscription_event_type_t t
       }
       break;
   }
+
+  uint64_t count{1};
+  if (write(This->m_eventfd, &count, sizeof(count)) == -1) {
+    This->m_log.err("pulseaudio: Failed to write event fd (%s)", strerror(errno));
+  }
   pa_threaded_mainloop_signal(This->m_mainloop, 0);
 }
 
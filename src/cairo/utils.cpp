@@ -43,6 +43,61 @@ namespace cairo {
 
     unicode_character::unicode_character() : codepoint(0), offset(0), length(0) {}
 
+    // }}}
+    // implementation : unicode_coverage {{{
+
+    constexpr unsigned long unicode_coverage::PLANE_SIZE;
+    constexpr unsigned long unicode_coverage::PLANE_COUNT;
+
+    void unicode_coverage::add(unsigned long codepoint) {
+      auto plane = codepoint / PLANE_SIZE;
+      if (plane >= PLANE_COUNT) {
+        return;
+      }
+      if (!m_planes[plane]) {
+        m_planes[plane] = make_unique<std::bitset<PLANE_SIZE>>();
+      }
+      m_planes[plane]->set(codepoint % PLANE_SIZE);
+    }
+
+    /**
+     * Add all codepoints of the given fontconfig charset
+     */
+    void unicode_coverage::add(const FcCharSet* charset) {
+      FcChar32 map[FC_CHARSET_MAP_SIZE];
+      FcChar32 next;
+
+      for (auto base = FcCharSetFirstPage(charset, map, &next); base != FC_CHARSET_DONE;
+           base = FcCharSetNextPage(charset, map, &next)) {
+        for (unsigned int i = 0; i < FC_CHARSET_MAP_SIZE; i++) {
+          for (unsigned int bit = 0; map[i] && bit < 32; bit++) {
+            if (map[i] & (1U << bit)) {
+              add(base + i * 32 + bit);
+            }
+          }
+        }
+      }
+    }
+
+    /**
+     * Add all codepoints of the selected charmap of the given face
+     */
+    void unicode_coverage::add(FT_Face face) {
+      FT_UInt index;
+      for (auto c = FT_Get_First_Char(face, &index); index != 0; c = FT_Get_Next_Char(face, c, &index)) {
+        add(c);
+      }
+    }
+
+    bool unicode_coverage::empty() const {
+      for (auto&& plane : m_planes) {
+        if (plane) {
+          return false;
+        }
+      }
+      return true;
+    }
+
     // }}}
 
     /**
@@ -3,7 +3,6 @@
 #include <algorithm>
 
 #include "components/config.hpp"
-#include "components/parser.hpp"
 #include "components/renderer.hpp"
 #include "components/screen.hpp"
 #include "components/taskqueue.hpp"
@@ -17,6 +16,7 @@
 #include "utils/math.hpp"
 #include "utils/string.hpp"
 #include "x11/atoms.hpp"
+#include "x11/background_manager.hpp"
 #include "x11/connection.hpp"
 #include "x11/ewmh.hpp"
 #include "x11/extensions/all.hpp"
@@ -37,17 +37,23 @@ using namespace signals::ui;
 
 /**
  * Create instance
+ *
+ * The bar and its components only use the given connection, emitter and
+ * config, so that every bar can be given its own
  */
-bar::make_type bar::make(bool only_initialize_values) {
+bar::make_type bar::make(connection& conn, signal_emitter& emitter, const config& conf, bool only_initialize_values) {
+  auto background = background_manager::make(conn, emitter);
+  auto tray = tray_manager::make(conn, emitter, conf, *background);
+
   // clang-format off
   return factory_util::unique<bar>(
-        connection::make(),
-        signal_emitter::make(),
-        config::make(),
+        conn,
+        emitter,
+        conf,
         logger::make(),
-        screen::make(),
-        tray_manager::make(),
-        parser::make(),
+        move(background),
+        screen::make(conn, emitter, conf),
+        move(tray),
         taskqueue::make(),
         only_initialize_values);
   // clang-format on
@@ -59,15 +65,15 @@ bar::make_type bar::make(bool only_initialize_values) {
  * TODO: Break out all tray handling
  */
 bar::bar(connection& conn, signal_emitter& emitter, const config& config, const logger& logger,
-    unique_ptr<screen>&& screen, unique_ptr<tray_manager>&& tray_manager, unique_ptr<parser>&& parser,
+    unique_ptr<background_manager>&& background, unique_ptr<screen>&& screen, unique_ptr<tray_manager>&& tray_manager,
     unique_ptr<taskqueue>&& taskqueue, bool only_initialize_values)
     : m_connection(conn)
     , m_sig(emitter)
     , m_conf(config)
     , m_log(logger)
+    , m_background(forward<decltype(background)>(background))
     , m_screen(forward<decltype(screen)>(screen))
     , m_tray(forward<decltype(tray_manager)>(tray_manager))
-    , m_parser(forward<decltype(parser)>(parser))
     , m_taskqueue(forward<decltype(taskqueue)>(taskqueue)) {
   string bs{m_conf.section()};
 
@@ -159,6 +165,7 @@ bar::bar(connection& conn, signal_emitter& emitter, const config& config, const
   m_opts.spacing = m_conf.get(bs, "spacing", m_opts.spacing);
   m_opts.separator = drawtypes::load_optional_label(m_conf, bs, "separator", "");
   m_opts.locale = m_conf.get(bs, "locale", ""s);
+  m_opts.damage_tracking = m_conf.get(bs, "damage-tracking", m_opts.damage_tracking);
 
   auto radius = m_conf.get<double>(bs, "radius", 0.0);
   m_opts.radius.top = m_conf.get(bs, "radius-top", radius);
@@ -308,32 +315,129 @@ const bar_settings bar::settings() const {
 }
 
 /**
- * Parse input string and redraw the bar window
+ * Redraw the bar window
+ *
+ * \param contents Contents of the whole bar
+ * \param force Unless true, do not redraw unchanged contents
+ */
+void bar::draw(display_list&& contents, bool force) {
+  if (!m_mutex.try_lock()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(m_mutex, std::adopt_lock);
+
+  bool unchanged = contents == m_lastinput;
+
+  m_lastinput = move(contents);
+  m_lastsegments.clear();
+
+  if (skip_update(force, unchanged)) {
+    return;
+  }
+
+  m_log.info("Redrawing bar window");
+  m_renderer->begin(content_area());
+  m_renderer->render(m_lastinput);
+  m_renderer->end();
+
+  m_dblclicks = has_dblclick_actions();
+}
+
+/**
+ * Redraw the bar window from the output of the individual modules
  *
- * \param data Input string
- * \param force Unless true, do not parse unchanged data
+ * Segments that did not change since the last update are not drawn again,
+ * the renderer reuses their cached contents and only copies the damaged
+ * area to the window
+ *
+ * \param segments Module segments in the order they appear on the bar
+ * \param force Unless true, do not redraw unchanged segments
  */
-void bar::parse(string&& data, bool force) {
+void bar::draw(vector<bar_segment>&& segments, bool force) {
   if (!m_mutex.try_lock()) {
     return;
   }
 
   std::lock_guard<std::mutex> guard(m_mutex, std::adopt_lock);
 
-  bool unchanged = data == m_lastinput;
+  bool unchanged = segments == m_lastsegments;
+
+  m_lastsegments = move(segments);
+  m_lastinput.clear();
+
+  if (skip_update(force, unchanged)) {
+    return;
+  }
+
+  m_log.info("Redrawing bar window (damage tracking)");
+  m_renderer->begin(content_area(), !force);
+
+  bool contained{true};
+
+  for (auto&& segment : m_lastsegments) {
+    if (m_renderer->begin_segment(segment.align, segment.contents)) {
+      continue;
+    }
+
+    m_renderer->render(segment.contents);
+
+    contained = m_renderer->end_segment() && contained;
+  }
+
+  m_renderer->end();
+
+  if (!contained) {
+    /*
+     * Some module changes the alignment within its own output, so its
+     * contents can't be drawn in isolation. Redraw the whole bar instead
+     */
+    m_log.warn("Module output changes alignment, disabling damage tracking");
+    m_opts.damage_tracking = false;
+
+    display_list contents;
+    alignment align{alignment::NONE};
+    for (auto&& segment : m_lastsegments) {
+      if (segment.align != align) {
+        align = segment.align;
+        contents.align(align);
+      }
+      contents += segment.contents;
+    }
 
-  m_lastinput = data;
+    m_lastinput = move(contents);
+    m_lastsegments.clear();
+    m_renderer->begin(content_area());
+    m_renderer->render(m_lastinput);
+    m_renderer->end();
+  }
 
+  m_dblclicks = has_dblclick_actions();
+}
+
+/**
+ * Check if a redraw can be skipped
+ */
+bool bar::skip_update(bool force, bool unchanged) const {
   if (force) {
     m_log.trace("bar: Force update");
   } else if (!m_visible) {
-    return m_log.trace("bar: Ignoring update (invisible)");
+    m_log.trace("bar: Ignoring update (invisible)");
+    return true;
   } else if (m_opts.shaded) {
-    return m_log.trace("bar: Ignoring update (shaded)");
+    m_log.trace("bar: Ignoring update (shaded)");
+    return true;
   } else if (unchanged) {
-    return m_log.trace("bar: Ignoring update (unchanged)");
+    m_log.trace("bar: Ignoring update (unchanged)");
+    return true;
   }
+  return false;
+}
 
+/**
+ * Get the area available for the bar contents (excluding borders and tray)
+ */
+xcb_rectangle_t bar::content_area() const {
   auto rect = m_opts.inner_area();
 
   if (m_tray && !m_tray->settings().detached && m_tray->settings().configured_slots) {
@@ -347,31 +451,24 @@ void bar::parse(string&& data, bool force) {
     }
   }
 
-  m_log.info("Redrawing bar window");
-  m_renderer->begin(rect);
-
-  try {
-    m_parser->parse(settings(), data);
-  } catch (const parser_error& err) {
-    m_log.err("Failed to parse contents (reason: %s)", err.what());
-  }
-
-  m_renderer->end();
+  return rect;
+}
 
-  const auto check_dblclicks = [&]() -> bool {
-    for (auto&& action : m_renderer->actions()) {
-      if (static_cast<int>(action.button) >= static_cast<int>(mousebtn::DOUBLE_LEFT)) {
-        return true;
-      }
+/**
+ * Check if any of the rendered or fallback actions is a double click action
+ */
+bool bar::has_dblclick_actions() const {
+  for (auto&& action : m_renderer->actions()) {
+    if (static_cast<int>(action.button) >= static_cast<int>(mousebtn::DOUBLE_LEFT)) {
+      return true;
     }
-    for (auto&& action : m_opts.actions) {
-      if (static_cast<int>(action.button) >= static_cast<int>(mousebtn::DOUBLE_LEFT)) {
-        return true;
-      }
+  }
+  for (auto&& action : m_opts.actions) {
+    if (static_cast<int>(action.button) >= static_cast<int>(mousebtn::DOUBLE_LEFT)) {
+      return true;
     }
-    return false;
-  };
-  m_dblclicks = check_dblclicks();
+  }
+  return false;
 }
 
 /**
@@ -413,7 +510,11 @@ void bar::show() {
     m_connection.map_window_checked(m_opts.window);
     m_connection.flush();
     m_visible = true;
-    parse(string{m_lastinput}, true);
+    if (!m_lastsegments.empty()) {
+      draw(vector<bar_segment>{m_lastsegments}, true);
+    } else {
+      draw(display_list{m_lastinput}, true);
+    }
   } catch (const exception& err) {
     m_log.err("Failed to map bar window (err=%s", err.what());
   }
@@ -808,7 +909,7 @@ void bar::handle(const evt::configure_notify&) {
 
 bool bar::on(const signals::eventqueue::start&) {
   m_log.trace("bar: Create renderer");
-  m_renderer = renderer::make(m_opts);
+  m_renderer = renderer::make(m_connection, m_sig, m_conf, m_opts, *m_background);
   m_opts.window = m_renderer->window();
 
   // Subscribe to window enter and leave events
@@ -43,11 +43,11 @@ void builder::reset() {
 }
 
 /**
- * Flush contents of the builder and return built string
+ * Flush contents of the builder and return the built display list
  *
  * This will also close any unclosed tags
  */
-string builder::flush() {
+display_list builder::flush() {
   if (m_tags[syntaxtag::B]) {
     background_close();
   }
@@ -74,7 +74,7 @@ string builder::flush() {
     cmd_close();
   }
 
-  string output{m_output};
+  display_list output{move(m_output)};
 
   reset();
 
@@ -83,10 +83,18 @@ string builder::flush() {
 
 /**
  * Insert raw text string
+ *
+ * Formatting tags contained in the text are translated by the parser
  */
 void builder::append(string text) {
-  m_output.reserve(text.size());
-  m_output += move(text);
+  m_parser.parse(m_bar, text, m_output);
+}
+
+/**
+ * Insert contents of a display list
+ */
+void builder::append(const display_list& list) {
+  m_output += list;
 }
 
 /**
@@ -102,6 +110,13 @@ void builder::node(string str) {
   append(move(str));
 }
 
+/**
+ * Insert contents of a display list
+ */
+void builder::node(const display_list& list) {
+  append(list);
+}
+
 /**
  * Insert text node with specific font index
  *
@@ -204,7 +219,7 @@ void builder::offset(int pixels) {
   if (pixels == 0) {
     return;
   }
-  tag_open(syntaxtag::O, to_string(pixels));
+  m_output.offset(pixels);
 }
 
 /**
@@ -212,24 +227,20 @@ void builder::offset(int pixels) {
  */
 void builder::space(size_t width) {
   if (width) {
-    m_output.append(width, ' ');
+    m_output.text(width, ' ');
   } else {
     space();
   }
 }
 void builder::space() {
-  m_output.append(m_bar.spacing, ' ');
+  m_output.text(m_bar.spacing, ' ');
 }
 
 /**
  * Remove trailing space
  */
 void builder::remove_trailing_space(size_t len) {
-  if (len == 0_z || len > m_output.size()) {
-    return;
-  } else if (m_output.substr(m_output.size() - len) == string(len, ' ')) {
-    m_output.erase(m_output.size() - len);
-  }
+  m_output.remove_trailing(len, ' ');
 }
 void builder::remove_trailing_space() {
   remove_trailing_space(m_bar.spacing);
@@ -243,7 +254,8 @@ void builder::font(int index) {
     return;
   }
   m_fontindex = index;
-  tag_open(syntaxtag::T, to_string(index));
+  tag_open(syntaxtag::T);
+  m_output.font(index);
 }
 
 /**
@@ -266,7 +278,8 @@ void builder::background(string color) {
 
   color = color_util::simplify_hex(color);
   m_colors[syntaxtag::B] = color;
-  tag_open(syntaxtag::B, color);
+  tag_open(syntaxtag::B);
+  m_output.color(display_op::BACKGROUND, color_util::parse(color, m_bar.background));
 }
 
 /**
@@ -291,7 +304,8 @@ void builder::color(string color) {
 
   color = color_util::simplify_hex(color);
   m_colors[syntaxtag::F] = color;
-  tag_open(syntaxtag::F, color);
+  tag_open(syntaxtag::F);
+  m_output.color(display_op::FOREGROUND, color_util::parse(color, m_bar.foreground));
 }
 
 /**
@@ -342,7 +356,8 @@ void builder::line_color_close() {
 void builder::overline_color(string color) {
   color = color_util::simplify_hex(color);
   m_colors[syntaxtag::o] = color;
-  tag_open(syntaxtag::o, color);
+  tag_open(syntaxtag::o);
+  m_output.color(display_op::OVERLINE, color_util::parse(color, m_bar.overline.color));
   tag_open(attribute::OVERLINE);
 }
 
@@ -360,7 +375,8 @@ void builder::overline_color_close() {
 void builder::underline_color(string color) {
   color = color_util::simplify_hex(color);
   m_colors[syntaxtag::u] = color;
-  tag_open(syntaxtag::u, color);
+  tag_open(syntaxtag::u);
+  m_output.color(display_op::UNDERLINE, color_util::parse(color, m_bar.underline.color));
   tag_open(attribute::UNDERLINE);
 }
 
@@ -412,17 +428,9 @@ void builder::underline_close() {
  * Add a polybar control tag
  */
 void builder::control(controltag tag) {
-  string str;
-  switch (tag) {
-    case controltag::R:
-      str = "R";
-      break;
-    default:
-      break;
-  }
-
-  if (!str.empty()) {
-    tag_open(syntaxtag::P, str);
+  if (tag != controltag::NONE) {
+    tag_open(syntaxtag::P);
+    m_output.control(tag);
   }
 }
 
@@ -431,8 +439,8 @@ void builder::control(controltag tag) {
  */
 void builder::cmd(mousebtn index, string action) {
   if (!action.empty()) {
-    action = string_util::replace_all(action, ":", "\\:");
-    tag_open(syntaxtag::A, to_string(static_cast<int>(index)) + ":" + action + ":");
+    tag_open(syntaxtag::A);
+    m_output.action_begin(index, action);
   }
 }
 
@@ -475,42 +483,10 @@ string builder::foreground_hex() {
 }
 
 /**
- * Insert directive to change value of given tag
+ * Keep track of the opened tag so that it can be closed
  */
-void builder::tag_open(syntaxtag tag, const string& value) {
+void builder::tag_open(syntaxtag tag) {
   m_tags[tag]++;
-
-  switch (tag) {
-    case syntaxtag::NONE:
-      break;
-    case syntaxtag::A:
-      append("%{A" + value + "}");
-      break;
-    case syntaxtag::F:
-      append("%{F" + value + "}");
-      break;
-    case syntaxtag::B:
-      append("%{B" + value + "}");
-      break;
-    case syntaxtag::T:
-      append("%{T" + value + "}");
-      break;
-    case syntaxtag::u:
-      append("%{u" + value + "}");
-      break;
-    case syntaxtag::o:
-      append("%{o" + value + "}");
-      break;
-    case syntaxtag::R:
-      append("%{R}");
-      break;
-    case syntaxtag::O:
-      append("%{O" + value + "}");
-      break;
-    case syntaxtag::P:
-      append("%{P" + value + "}");
-      break;
-  }
 }
 
 /**
@@ -522,17 +498,7 @@ void builder::tag_open(attribute attr) {
   }
 
   m_attrs[attr] = true;
-
-  switch (attr) {
-    case attribute::NONE:
-      break;
-    case attribute::UNDERLINE:
-      append("%{+u}");
-      break;
-    case attribute::OVERLINE:
-      append("%{+o}");
-      break;
-  }
+  m_output.attr(display_op::ATTRIBUTE_SET, attr);
 }
 
 /**
@@ -547,22 +513,22 @@ void builder::tag_close(syntaxtag tag) {
 
   switch (tag) {
     case syntaxtag::A:
-      append("%{A}");
+      m_output.action_end();
       break;
     case syntaxtag::F:
-      append("%{F-}");
+      m_output.color(display_op::FOREGROUND, m_bar.foreground, true);
       break;
     case syntaxtag::B:
-      append("%{B-}");
+      m_output.color(display_op::BACKGROUND, m_bar.background, true);
       break;
     case syntaxtag::T:
-      append("%{T-}");
+      m_output.font(0, true);
       break;
     case syntaxtag::u:
-      append("%{u-}");
+      m_output.color(display_op::UNDERLINE, m_bar.underline.color, true);
       break;
     case syntaxtag::o:
-      append("%{o-}");
+      m_output.color(display_op::OVERLINE, m_bar.overline.color, true);
       break;
     case syntaxtag::NONE:
     case syntaxtag::R:
@@ -581,17 +547,7 @@ void builder::tag_close(attribute attr) {
   }
 
   m_attrs[attr] = false;
-
-  switch (attr) {
-    case attribute::NONE:
-      break;
-    case attribute::UNDERLINE:
-      append("%{-u}");
-      break;
-    case attribute::OVERLINE:
-      append("%{-o}");
-      break;
-  }
+  m_output.attr(display_op::ATTRIBUTE_UNSET, attr);
 }
 
 POLYBAR_NS_END
@@ -9,6 +9,15 @@ config_parser::config_parser(const logger& logger, string&& file, string&& bar)
     : m_log(logger), m_config(file_util::expand(file)), m_barname(move(bar)) {}
 
 config::make_type config_parser::parse() {
+  config::make_type result = config::make(m_config, m_barname);
+
+  // Cast to non-const to set sections, included and xrm
+  parse(const_cast<config&>(result));
+
+  return result;
+}
+
+void config_parser::parse(config& result) {
   m_log.notice("Parsing config file: %s", m_config);
 
   parse_file(m_config, {});
@@ -25,18 +34,12 @@ config::make_type config_parser::parse() {
    * second element onwards for the included list
    */
   file_list included(m_files.begin() + 1, m_files.end());
-  config::make_type result = config::make(m_config, m_barname);
-
-  // Cast to non-const to set sections, included and xrm
-  config& m_conf = const_cast<config&>(result);
 
-  m_conf.set_sections(move(sections));
-  m_conf.set_included(move(included));
+  result.set_sections(move(sections));
+  result.set_included(move(included));
   if (use_xrm) {
-    m_conf.use_xrm();
+    result.use_xrm();
   }
-
-  return result;
 }
 
 sectionmap_t config_parser::create_sectionmap() {
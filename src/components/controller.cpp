@@ -1,5 +1,6 @@
 #include "components/controller.hpp"
 
+#include <algorithm>
 #include <csignal>
 
 #include "components/bar.hpp"
@@ -40,44 +41,70 @@ void interrupt_handler(int signum) {
 
 /**
  * Build controller instance
+ *
+ * The emitter and config belong to this bar, the emitter must not be the
+ * process wide one the modules report to. Bars hosted in the same process
+ * pass the same registry and share their modules through it
  */
-controller::make_type controller::make(unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch) {
-  return factory_util::unique<controller>(connection::make(), signal_emitter::make(), logger::make(), config::make(),
-      bar::make(), forward<decltype(ipc)>(ipc), forward<decltype(config_watch)>(config_watch));
+controller::make_type controller::make(connection& conn, signal_emitter& emitter, const config& conf,
+    shared_ptr<ipc> ipc, unique_ptr<inotify_watch>&& config_watch, module_registry* registry) {
+  return factory_util::unique<controller>(conn, emitter, logger::make(), conf, bar::make(conn, emitter, conf),
+      move(ipc), forward<decltype(config_watch)>(config_watch), registry);
 }
 
 /**
  * Construct controller
+ *
+ * The first controller of the process handles the signals and runs the event
+ * loop, the others only run their eventqueue
  */
 controller::controller(connection& conn, signal_emitter& emitter, const logger& logger, const config& config,
-    unique_ptr<bar>&& bar, unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& confwatch)
+    unique_ptr<bar>&& bar, shared_ptr<ipc> ipc, unique_ptr<inotify_watch>&& confwatch, module_registry* registry)
     : m_connection(conn)
     , m_sig(emitter)
+    , m_modsig(signal_emitter::make())
     , m_log(logger)
     , m_conf(config)
     , m_bar(forward<decltype(bar)>(bar))
-    , m_ipc(forward<decltype(ipc)>(ipc))
-    , m_confwatch(forward<decltype(confwatch)>(confwatch)) {
+    , m_ipc(move(ipc))
+    , m_confwatch(forward<decltype(confwatch)>(confwatch))
+    , m_registry(registry) {
+  assert(&m_sig != &m_modsig);
+
   m_swallow_input = m_conf.get("settings", "throttle-input-for", m_swallow_input);
-  m_swallow_limit = m_conf.deprecated("settings", "eventqueue-swallow", "throttle-output", m_swallow_limit);
-  m_swallow_update = m_conf.deprecated("settings", "eventqueue-swallow-time", "throttle-output-for", m_swallow_update);
 
-  if (pipe(g_eventpipe.data()) == 0) {
-    m_queuefd[PIPE_READ] = make_unique<file_descriptor>(g_eventpipe[PIPE_READ]);
-    m_queuefd[PIPE_WRITE] = make_unique<file_descriptor>(g_eventpipe[PIPE_WRITE]);
+  auto framerate = m_conf.get("settings", "max-framerate", 60U);
+  if (framerate > 0) {
+    m_frame_interval = std::chrono::milliseconds{1000 / framerate};
   } else {
-    throw system_error("Failed to create event channel pipes");
+    m_frame_interval = std::chrono::milliseconds::zero();
   }
+  m_frame_latency = m_conf.get("settings", "frame-latency", m_frame_interval);
 
-  m_log.trace("controller: Install signal handler");
-  struct sigaction act {};
-  memset(&act, 0, sizeof(act));
-  act.sa_handler = &interrupt_handler;
-  sigaction(SIGINT, &act, nullptr);
-  sigaction(SIGQUIT, &act, nullptr);
-  sigaction(SIGTERM, &act, nullptr);
-  sigaction(SIGUSR1, &act, nullptr);
-  sigaction(SIGALRM, &act, nullptr);
+  for (auto&& key : {"eventqueue-swallow", "eventqueue-swallow-time", "throttle-output", "throttle-output-for"}) {
+    if (m_conf.has("settings", key)) {
+      m_log.warn("The config parameter `settings.%s` is no longer used, see `settings.max-framerate`", key);
+    }
+  }
+
+  if (g_eventpipe[PIPE_READ] == -1) {
+    if (pipe(g_eventpipe.data()) == 0) {
+      m_queuefd[PIPE_READ] = make_unique<file_descriptor>(g_eventpipe[PIPE_READ]);
+      m_queuefd[PIPE_WRITE] = make_unique<file_descriptor>(g_eventpipe[PIPE_WRITE]);
+    } else {
+      throw system_error("Failed to create event channel pipes");
+    }
+
+    m_log.trace("controller: Install signal handler");
+    struct sigaction act {};
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = &interrupt_handler;
+    sigaction(SIGINT, &act, nullptr);
+    sigaction(SIGQUIT, &act, nullptr);
+    sigaction(SIGTERM, &act, nullptr);
+    sigaction(SIGUSR1, &act, nullptr);
+    sigaction(SIGALRM, &act, nullptr);
+  }
 
   m_log.trace("controller: Setup user-defined modules");
   size_t created_modules{0};
@@ -88,31 +115,44 @@ controller::controller(connection& conn, signal_emitter& emitter, const logger&
   if (!created_modules) {
     throw application_error("No modules created");
   }
+
+  builder build{m_bar->settings()};
+  build.node(m_bar->settings().separator);
+  m_separator = build.flush();
+
+  /*
+   * Attach to the process wide emitter while the bar is built, before any
+   * module of the process is started, so that its receivers don't change
+   * while modules emit
+   */
+  m_modsig.attach(this);
 }
 
 /**
  * Deconstruct controller
+ *
+ * All bars of the process must be stopped before the first one is destroyed
  */
 controller::~controller() {
-  m_log.trace("controller: Uninstall sighandler");
-  signal(SIGINT, SIG_DFL);
-  signal(SIGQUIT, SIG_DFL);
-  signal(SIGTERM, SIG_DFL);
-  signal(SIGALRM, SIG_DFL);
-
-  if (g_reload) {
-    // Cause SIGUSR1 to be ignored until registered in the new polybar process
-    signal(SIGUSR1, SIG_IGN);
-  }
+  stop();
 
   m_log.trace("controller: Detach signal receiver");
   m_sig.detach(this);
+  m_modsig.detach(this);
+
+  if (m_queuefd[PIPE_READ]) {
+    m_log.trace("controller: Uninstall sighandler");
+    signal(SIGINT, SIG_DFL);
+    signal(SIGQUIT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGALRM, SIG_DFL);
+
+    if (g_reload) {
+      // Cause SIGUSR1 to be ignored until registered in the new polybar process
+      signal(SIGUSR1, SIG_IGN);
+    }
 
-  m_log.trace("controller: Stop modules");
-  for (auto&& module : m_modules) {
-    auto module_name = module->name();
-    auto cleanup_ms = time_util::measure([&module] { module->stop(); });
-    m_log.info("Deconstruction of %s took %lu ms.", module_name, cleanup_ms);
+    g_eventpipe = {{-1, -1}};
   }
 
   m_log.trace("controller: Joining threads");
@@ -125,8 +165,26 @@ controller::~controller() {
 
 /**
  * Run the main loop
+ *
+ * Other bars hosted in the process are started before and stopped after
+ * this, their events are read by this loop
  */
 bool controller::run(bool writeback, string snapshot_dst) {
+  start(writeback, move(snapshot_dst));
+
+  read_events();
+
+  m_log.notice("Termination signal received, shutting down...");
+
+  stop();
+
+  return !g_reload;
+}
+
+/**
+ * Start the modules created by this bar and the eventqueue worker
+ */
+void controller::start(bool writeback, string snapshot_dst) {
   m_log.info("Starting application");
   m_log.trace("controller: Main thread id = %i", concurrency_util::thread_id(this_thread::get_id()));
 
@@ -137,14 +195,27 @@ bool controller::run(bool writeback, string snapshot_dst) {
 
   m_sig.attach(this);
 
-  size_t started_modules{0};
-  for (const auto& module : m_modules) {
+  for (const auto& module : bar_modules()) {
     auto inp_handler = dynamic_cast<input_handler*>(&*module);
-    auto evt_handler = dynamic_cast<event_handler_interface*>(&*module);
-
     if (inp_handler != nullptr) {
       m_inputhandlers.emplace_back(inp_handler);
     }
+  }
+
+  if (m_registry != nullptr && m_queuefd[PIPE_READ]) {
+    // Unaddressed ipc actions only reach the first bar, let it try the modules of the other bars too
+    for (const auto& entry : *m_registry) {
+      auto inp_handler = dynamic_cast<input_handler*>(&*entry.second);
+      if (inp_handler != nullptr &&
+          std::find(m_inputhandlers.begin(), m_inputhandlers.end(), inp_handler) == m_inputhandlers.end()) {
+        m_inputhandlers.emplace_back(inp_handler);
+      }
+    }
+  }
+
+  size_t started_modules{0};
+  for (const auto& module : m_modules) {
+    auto evt_handler = dynamic_cast<event_handler_interface*>(&*module);
 
     if (evt_handler != nullptr) {
       evt_handler->connect(m_connection);
@@ -159,23 +230,33 @@ bool controller::run(bool writeback, string snapshot_dst) {
     }
   }
 
-  if (!started_modules) {
+  // Modules shared with another bar are started by that bar
+  if (!started_modules && m_modules.size() == bar_modules().size()) {
     throw application_error("No modules started");
   }
 
   m_connection.flush();
   m_event_thread = thread(&controller::process_eventqueue, this);
+}
 
-  read_events();
-
+/**
+ * Stop the eventqueue worker and the modules created by this bar
+ */
+void controller::stop() {
   if (m_event_thread.joinable()) {
     enqueue(make_quit_evt(static_cast<bool>(g_reload)));
     m_event_thread.join();
   }
 
-  m_log.notice("Termination signal received, shutting down...");
-
-  return !g_reload;
+  m_log.trace("controller: Stop modules");
+  for (auto&& module : m_modules) {
+    if (!module->running()) {
+      continue;
+    }
+    auto module_name = module->name();
+    auto cleanup_ms = time_util::measure([&module] { module->stop(); });
+    m_log.info("Deconstruction of %s took %lu ms.", module_name, cleanup_ms);
+  }
 }
 
 /**
@@ -312,8 +393,6 @@ void controller::read_events() {
     // Process event on the ipc fd
     if (fd_ipc > -1 && FD_ISSET(fd_ipc, &readfds)) {
       m_ipc->receive_message();
-      fds.erase(std::remove_if(fds.begin(), fds.end(), [fd_ipc](int fd) { return fd == fd_ipc; }), fds.end());
-      fds.emplace_back((fd_ipc = m_ipc->get_file_descriptor()));
     }
   }
 }
@@ -330,9 +409,34 @@ void controller::process_eventqueue() {
     m_sig.emit(signals::ui::ready{});
   }
 
+  /*
+   * Updates are rendered right away unless the previous frame is less than a
+   * frame interval ago. In that case the update and everything that follows
+   * it is drawn in the next frame slot, or earlier if the latency budget of
+   * the first waiting update runs out
+   */
+  bool pending{false};
+  std::chrono::steady_clock::time_point deadline;
+
+  const auto render = [&](bool force) {
+    pending = false;
+    process_update(force);
+    m_lastframe = std::chrono::steady_clock::now();
+  };
+
   while (!g_terminate) {
     event evt{};
-    m_queue.wait_dequeue(evt);
+
+    if (!pending) {
+      m_queue.wait_dequeue(evt);
+    } else {
+      // A negative timeout would block until the next event
+      auto timeout = std::max(deadline - std::chrono::steady_clock::now(), std::chrono::steady_clock::duration::zero());
+      if (!m_queue.wait_dequeue_timed(evt, timeout)) {
+        render(false);
+        continue;
+      }
+    }
 
     if (g_terminate) {
       break;
@@ -345,41 +449,22 @@ void controller::process_eventqueue() {
     } else if (evt.type == event_type::INPUT) {
       process_inputdata();
     } else if (evt.type == event_type::UPDATE && evt.flag) {
-      process_update(true);
-    } else {
-      event next{};
-      size_t swallowed{0};
-      while (swallowed++ < m_swallow_limit && m_queue.wait_dequeue_timed(next, m_swallow_update)) {
-        if (next.type == event_type::QUIT) {
-          evt = next;
-          break;
-        } else if (next.type == event_type::INPUT) {
-          evt = next;
-          break;
-        } else if (evt.type != next.type) {
-          enqueue(move(next));
-          break;
-        } else {
-          m_log.trace_x("controller: Swallowing event within timeframe");
-          evt = next;
-        }
-      }
-
-      if (evt.type == event_type::UPDATE) {
-        process_update(evt.flag);
-      } else if (evt.type == event_type::INPUT) {
-        process_inputdata();
-      } else if (evt.type == event_type::QUIT) {
-        if (evt.flag) {
-          on(signals::eventqueue::exit_reload{});
-        } else {
-          on(signals::eventqueue::exit_terminate{});
-        }
-      } else if (evt.type == event_type::CHECK) {
-        on(signals::eventqueue::check_state{});
+      render(true);
+    } else if (evt.type == event_type::UPDATE) {
+      auto now = std::chrono::steady_clock::now();
+
+      if (pending) {
+        m_log.trace_x("controller: Coalescing update into the next frame");
+      } else if (now - m_lastframe >= m_frame_interval) {
+        render(false);
       } else {
-        m_log.warn("Unknown event type for enqueued event (%d)", evt.type);
+        pending = true;
+        deadline = std::min(m_lastframe + m_frame_interval, now + m_frame_latency);
       }
+    } else if (evt.type == event_type::CHECK) {
+      on(signals::eventqueue::check_state{});
+    } else {
+      m_log.warn("Unknown event type for enqueued event (%d)", evt.type);
     }
   }
 }
@@ -423,27 +508,25 @@ void controller::process_inputdata() {
  */
 bool controller::process_update(bool force) {
   const bar_settings& bar{m_bar->settings()};
-  string contents;
-  string padding_left(bar.padding.left, ' ');
-  string padding_right(bar.padding.right, ' ');
-  string margin_left(bar.module_margin.left, ' ');
-  string margin_right(bar.module_margin.right, ' ');
+  display_list contents;
+  auto start = chrono::steady_clock::now();
 
-  builder build{bar};
-  build.node(bar.separator);
-  string separator{build.flush()};
+  /*
+   * When damage tracking is enabled the output of each module is handed to
+   * the bar separately, so that unchanged modules don't have to be redrawn
+   */
+  bool segmented{bar.damage_tracking && !m_writeback};
+  vector<bar_segment> segments;
 
   for (const auto& block : m_blocks) {
-    string block_contents;
+    display_list block_contents;
+    vector<bar_segment> block_segments;
     bool is_left = false;
-    bool is_center = false;
     bool is_right = false;
     bool is_first = true;
 
     if (block.first == alignment::LEFT) {
       is_left = true;
-    } else if (block.first == alignment::CENTER) {
-      is_center = true;
     } else if (block.first == alignment::RIGHT) {
       is_right = true;
     }
@@ -453,7 +536,7 @@ bool controller::process_update(bool force) {
         continue;
       }
 
-      string module_contents;
+      display_list module_contents;
 
       try {
         module_contents = module->contents();
@@ -465,61 +548,149 @@ bool controller::process_update(bool force) {
         continue;
       }
 
-      if (!block_contents.empty() && !margin_right.empty()) {
-        block_contents += margin_right;
-      }
+      display_list segment_contents;
 
-      if (!block_contents.empty() && !separator.empty()) {
-        block_contents += separator;
+      if (!is_first) {
+        segment_contents.text(bar.module_margin.right, ' ');
+        segment_contents += m_separator;
+        segment_contents.text(bar.module_margin.left, ' ');
       }
 
-      if (!block_contents.empty() && !margin_left.empty() && !(is_left && is_first)) {
-        block_contents += margin_left;
-      }
+      segment_contents += module_contents;
 
-      block_contents.reserve(module_contents.size());
-      block_contents += module_contents;
+      if (segmented) {
+        block_segments.emplace_back(bar_segment{block.first, move(segment_contents)});
+      } else {
+        block_contents += segment_contents;
+      }
 
       is_first = false;
     }
 
-    if (block_contents.empty()) {
+    if (is_first) {
       continue;
-    } else if (is_left) {
-      contents += "%{l}";
-      contents += padding_left;
-    } else if (is_center) {
-      contents += "%{c}";
-    } else if (is_right) {
-      contents += "%{r}";
-      block_contents += padding_right;
+    } else if (segmented) {
+      if (is_left) {
+        display_list padded;
+        padded.text(bar.padding.left, ' ');
+        padded += block_segments.front().contents;
+        block_segments.front().contents = move(padded);
+      } else if (is_right) {
+        block_segments.back().contents.text(bar.padding.right, ' ');
+      }
+      for (auto&& segment : block_segments) {
+        segments.emplace_back(move(segment));
+      }
+    } else {
+      contents.align(block.first);
+      if (is_left) {
+        contents.text(bar.padding.left, ' ');
+      }
+      contents += block_contents;
+      if (is_right) {
+        contents.text(bar.padding.right, ' ');
+      }
     }
-
-    // Strip unnecessary reset tags
-    block_contents = string_util::replace_all(block_contents, "T-}%{T", "T");
-    block_contents = string_util::replace_all(block_contents, "B-}%{B#", "B#");
-    block_contents = string_util::replace_all(block_contents, "F-}%{F#", "F#");
-    block_contents = string_util::replace_all(block_contents, "U-}%{U#", "U#");
-    block_contents = string_util::replace_all(block_contents, "u-}%{u#", "u#");
-    block_contents = string_util::replace_all(block_contents, "o-}%{o#", "o#");
-
-    // Join consecutive tags
-    contents += string_util::replace_all(block_contents, "}%{", " ");
   }
 
+  auto built = chrono::steady_clock::now();
+
   try {
-    if (!m_writeback) {
-      m_bar->parse(move(contents), force);
+    if (m_writeback) {
+      std::cout << contents.to_string() << std::endl;
+    } else if (segmented) {
+      m_bar->draw(move(segments), force);
     } else {
-      std::cout << contents << std::endl;
+      m_bar->draw(move(contents), force);
     }
   } catch (const exception& err) {
     m_log.err("Failed to update bar contents (reason: %s)", err.what());
   }
 
+  auto rendered = chrono::steady_clock::now();
+  uint64_t buildtime = chrono::duration_cast<chrono::nanoseconds>(built - start).count();
+  uint64_t rendertime = chrono::duration_cast<chrono::nanoseconds>(rendered - built).count();
+  m_lastbuildtime = buildtime;
+  m_lastrendertime = rendertime;
+  m_buildtime += buildtime;
+  m_rendertime += rendertime;
+  m_frames++;
+
+  auto window = chrono::steady_clock::time_point{chrono::nanoseconds{m_fpswindow.load()}};
+
+  if (++m_fpsframes == 1) {
+    m_fpswindow = chrono::duration_cast<chrono::nanoseconds>(rendered.time_since_epoch()).count();
+  } else if (rendered - window >= 1s) {
+    m_fps = (m_fpsframes - 1) / chrono::duration<double>(rendered - window).count();
+    m_fpswindow = chrono::duration_cast<chrono::nanoseconds>(rendered.time_since_epoch()).count();
+    m_fpsframes = 1;
+  }
+
   return true;
 }
 
+/**
+ * Serialize the performance counters of the bar and its modules as JSON
+ *
+ * Times are given in nanoseconds
+ */
+string controller::stats_snapshot() const {
+  const auto escape = [](const string& value) {
+    string escaped;
+    for (auto&& c : value) {
+      if (c == '"' || c == '\\') {
+        escaped += '\\';
+      }
+      if (static_cast<unsigned char>(c) >= 0x20) {
+        escaped += c;
+      }
+    }
+    return escaped;
+  };
+
+  /*
+   * The rate is only measured when a frame is drawn. Once the current window
+   * is older than a second, count its frames up to now instead, so that the
+   * rate decays while the bar is idle
+   */
+  double fps{m_fps};
+  uint64_t fpsframes{m_fpsframes};
+  auto window = chrono::steady_clock::time_point{chrono::nanoseconds{m_fpswindow.load()}};
+  auto elapsed = chrono::steady_clock::now() - window;
+
+  if (fpsframes > 0 && elapsed >= 1s) {
+    fps = (fpsframes - 1) / chrono::duration<double>(elapsed).count();
+  }
+
+  std::ostringstream json;
+  json << "{\"bar\":{";
+  json << "\"frames\":" << m_frames.load();
+  json << ",\"fps\":" << fps;
+  json << ",\"build_time\":" << m_buildtime.load();
+  json << ",\"render_time\":" << m_rendertime.load();
+  json << ",\"last_build_time\":" << m_lastbuildtime.load();
+  json << ",\"last_render_time\":" << m_lastrendertime.load();
+  json << "},\"modules\":[";
+
+  auto modules = bar_modules();
+  for (auto it = modules.begin(); it != modules.end(); it++) {
+    const auto& stats = (*it)->stats();
+    json << (it == modules.begin() ? "" : ",") << "{";
+    json << "\"name\":\"" << escape((*it)->name()) << "\"";
+    json << ",\"running\":" << ((*it)->running() ? "true" : "false");
+    json << ",\"updates\":" << stats.updates.load();
+    json << ",\"broadcasts\":" << stats.broadcasts.load();
+    json << ",\"builds\":" << stats.builds.load();
+    json << ",\"build_time\":" << stats.build_time.load();
+    json << ",\"update_time\":" << stats.update_time.load();
+    json << ",\"cpu_time\":" << stats.cpu_time.load();
+    json << "}";
+  }
+
+  json << "]}";
+  return json.str();
+}
+
 /**
  * Creates module instances for all the modules in the given alignment block
  */
@@ -563,6 +734,19 @@ size_t controller::setup_modules(alignment align) {
         throw application_error("Inter-process messaging needs to be enabled");
       }
 
+      string key;
+      if (m_registry != nullptr) {
+        key = module_key(type, module_name);
+        auto shared = m_registry->find(key);
+
+        if (shared != m_registry->end()) {
+          m_log.info("Sharing module \"%s\" with another bar", module_name);
+          m_blocks[align].push_back(shared->second);
+          count++;
+          continue;
+        }
+      }
+
       auto ptr = make_module(move(type), m_bar->settings(), module_name, m_log);
       module_t module = shared_ptr<modules::module_interface>(ptr);
       ptr = nullptr;
@@ -570,6 +754,10 @@ size_t controller::setup_modules(alignment align) {
       m_modules.push_back(module);
       m_blocks[align].push_back(module);
       count++;
+
+      if (m_registry != nullptr) {
+        m_registry->emplace(move(key), module);
+      }
     } catch (const runtime_error& err) {
       m_log.err("Disabling module \"%s\" (reason: %s)", module_name, err.what());
     }
@@ -578,6 +766,42 @@ size_t controller::setup_modules(alignment align) {
   return count;
 }
 
+/**
+ * Key under which a module is shared by the bars of the process
+ *
+ * Bars only share an instance if the settings the module output depends on
+ * are the same for them
+ */
+string controller::module_key(const string& type, const string& module_name) const {
+  const bar_settings& bar{m_bar->settings()};
+  sstream key;
+
+  key << "module/" << module_name << ';' << bar.foreground << ';' << bar.background << ';' << bar.underline.color
+      << ';' << bar.overline.color << ';' << bar.spacing << ';' << bar.locale;
+
+  if (type == "internal/bspwm" || type == "internal/i3" || type == "internal/xworkspaces" ||
+      type == "internal/xbacklight") {
+    key << ';' << (bar.monitor ? bar.monitor->name : "") << ';' << bar.monitor_strict << ';' << bar.monitor_exact;
+  }
+
+  return key;
+}
+
+/**
+ * Modules shown by this bar, each one once
+ */
+vector<module_t> controller::bar_modules() const {
+  vector<module_t> modules;
+  for (const auto& block : m_blocks) {
+    for (const auto& module : block.second) {
+      if (std::find(modules.begin(), modules.end(), module) == modules.end()) {
+        modules.emplace_back(module);
+      }
+    }
+  }
+  return modules;
+}
+
 /**
  * Process broadcast events
  */
@@ -612,6 +836,18 @@ bool controller::on(const signals::eventqueue::exit_reload&) {
  * Process eventqueue check event
  */
 bool controller::on(const signals::eventqueue::check_state&) {
+  if (g_terminate) {
+    return true;
+  }
+
+  // With several bars the process keeps running as long as any of their modules does
+  if (m_registry != nullptr) {
+    for (const auto& entry : *m_registry) {
+      if (entry.second->running()) {
+        return true;
+      }
+    }
+  }
   for (const auto& module : m_modules) {
     if (module->running()) {
       return true;
@@ -694,6 +930,7 @@ bool controller::on(const signals::ipc::command& evt) {
     m_bar->toggle();
   } else {
     m_log.warn("\"%s\" is not a valid ipc command", command);
+    return false;
   }
 
   return true;
@@ -705,6 +942,7 @@ bool controller::on(const signals::ipc::command& evt) {
 bool controller::on(const signals::ipc::hook& evt) {
   string hook{evt.cast()};
 
+  // Every bar of the process gets the hook, each passes it to the modules it created
   for (const auto& module : m_modules) {
     if (!module->running()) {
       continue;
@@ -718,6 +956,37 @@ bool controller::on(const signals::ipc::hook& evt) {
   return true;
 }
 
+/**
+ * Process ipc stats messages
+ *
+ * Without a path the snapshot is sent back to the client. Otherwise it is
+ * written to a temporary file that is renamed to the requested path, so
+ * readers never see a partial file
+ */
+bool controller::on(const signals::ipc::stats& evt) {
+  ipc_stats_request* request{evt.cast()};
+  string path{string_util::replace(request->path, "%pid%", to_string(getpid()))};
+
+  if (path.empty()) {
+    request->snapshot = stats_snapshot();
+    return true;
+  }
+
+  try {
+    string tmp{path + ".tmp"};
+    file_util::write_contents(tmp, stats_snapshot() + "\n");
+    if (rename(tmp.c_str(), path.c_str()) == -1) {
+      throw system_error("Failed to rename " + tmp);
+    }
+    m_log.info("Wrote stats to %s", path);
+  } catch (const exception& err) {
+    m_log.err("Failed to write stats to %s (err: %s)", path, err.what());
+    return false;
+  }
+
+  return true;
+}
+
 bool controller::on(const signals::ui::update_background&) {
   enqueue(make_update_evt(true));
 
@@ -0,0 +1,290 @@
+#include "components/display_list.hpp"
+
+#include <cstdio>
+
+#include "utils/string.hpp"
+
+POLYBAR_NS
+
+display_list::const_iterator display_list::begin() const {
+  return m_items.begin();
+}
+
+display_list::const_iterator display_list::end() const {
+  return m_items.end();
+}
+
+size_t display_list::size() const {
+  return m_items.size();
+}
+
+bool display_list::empty() const {
+  return m_items.empty();
+}
+
+void display_list::clear() {
+  m_items.clear();
+  m_strings.clear();
+}
+
+/**
+ * Get the text or action command referenced by the given item
+ */
+string display_list::str(const display_item& item) const {
+  return m_strings.substr(item.pos, item.len);
+}
+
+/**
+ * Add text run
+ *
+ * Consecutive text runs are joined into one
+ */
+void display_list::text(const string& text) {
+  if (text.empty()) {
+    return;
+  }
+
+  if (m_items.empty() || m_items.back().op != display_op::TEXT ||
+      m_items.back().pos + m_items.back().len != m_strings.size()) {
+    m_items.emplace_back(display_item{display_op::TEXT, false, 0U, m_strings.size(), 0_z});
+  }
+
+  m_items.back().len += text.size();
+  m_strings += text;
+}
+
+/**
+ * Add text run made of count times the given character
+ */
+void display_list::text(size_t count, char c) {
+  if (count) {
+    text(string(count, c));
+  }
+}
+
+/**
+ * Add color change for the background, foreground, underline or overline
+ */
+void display_list::color(display_op op, unsigned int color, bool reset) {
+  push(op, color, reset);
+}
+
+/**
+ * Add font change
+ */
+void display_list::font(int index, bool reset) {
+  push(display_op::FONT, static_cast<unsigned int>(index), reset);
+}
+
+/**
+ * Add alignment block change
+ */
+void display_list::align(alignment align) {
+  push(display_op::ALIGNMENT, static_cast<unsigned int>(align));
+}
+
+/**
+ * Add swap of the foreground and background color
+ */
+void display_list::reverse() {
+  push(display_op::REVERSE);
+}
+
+/**
+ * Add pixel offset
+ */
+void display_list::offset(int pixels) {
+  push(display_op::OFFSET, static_cast<unsigned int>(pixels));
+}
+
+/**
+ * Add change of the given attribute
+ */
+void display_list::attr(display_op op, attribute attr) {
+  push(op, static_cast<unsigned int>(attr));
+}
+
+/**
+ * Add start of a clickable area
+ */
+void display_list::action_begin(mousebtn btn, const string& command) {
+  m_items.emplace_back(
+      display_item{display_op::ACTION_BEGIN, false, static_cast<unsigned int>(btn), m_strings.size(), command.size()});
+  m_strings += command;
+}
+
+/**
+ * Add end of a clickable area
+ *
+ * mousebtn::NONE ends the most recently opened area
+ */
+void display_list::action_end(mousebtn btn) {
+  push(display_op::ACTION_END, static_cast<unsigned int>(btn));
+}
+
+/**
+ * Add polybar control tag
+ */
+void display_list::control(controltag tag) {
+  push(display_op::CONTROL, static_cast<unsigned int>(tag));
+}
+
+/**
+ * Remove count trailing characters c
+ *
+ * Nothing is removed unless the list ends in a text run ending with at
+ * least count characters c
+ */
+bool display_list::remove_trailing(size_t count, char c) {
+  if (count == 0 || m_items.empty() || m_items.back().op != display_op::TEXT || m_items.back().len < count) {
+    return false;
+  }
+
+  auto& item = m_items.back();
+  size_t end{item.pos + item.len};
+
+  if (m_strings.find_first_not_of(c, end - count) < end) {
+    return false;
+  }
+
+  item.len -= count;
+
+  if (end == m_strings.size()) {
+    m_strings.erase(end - count);
+  }
+
+  if (item.len == 0) {
+    m_items.pop_back();
+  }
+
+  return true;
+}
+
+/**
+ * Convert the list back to the formatting tag syntax
+ */
+string display_list::to_string() const {
+  string output;
+  char buf[16];
+
+  const auto color = [&](char tag, const display_item& item) {
+    if (item.reset) {
+      output += "%{"s + tag + "-}";
+    } else {
+      snprintf(buf, sizeof(buf), "%%{%c#%08x}", tag, item.value);
+      output += buf;
+    }
+  };
+
+  const auto attr = [&](char modifier, const display_item& item) {
+    output += "%{"s + modifier + (static_cast<attribute>(item.value) == attribute::OVERLINE ? "o" : "u") + "}";
+  };
+
+  for (auto&& item : m_items) {
+    switch (item.op) {
+      case display_op::TEXT:
+        output.append(m_strings, item.pos, item.len);
+        break;
+      case display_op::BACKGROUND:
+        color('B', item);
+        break;
+      case display_op::FOREGROUND:
+        color('F', item);
+        break;
+      case display_op::UNDERLINE:
+        color('u', item);
+        break;
+      case display_op::OVERLINE:
+        color('o', item);
+        break;
+      case display_op::FONT:
+        output += item.reset ? "%{T-}" : "%{T" + std::to_string(item.value) + "}";
+        break;
+      case display_op::ALIGNMENT:
+        switch (static_cast<alignment>(item.value)) {
+          case alignment::LEFT:
+            output += "%{l}";
+            break;
+          case alignment::CENTER:
+            output += "%{c}";
+            break;
+          case alignment::RIGHT:
+            output += "%{r}";
+            break;
+          case alignment::NONE:
+            break;
+        }
+        break;
+      case display_op::REVERSE:
+        output += "%{R}";
+        break;
+      case display_op::OFFSET:
+        output += "%{O" + std::to_string(static_cast<int>(item.value)) + "}";
+        break;
+      case display_op::ATTRIBUTE_SET:
+        attr('+', item);
+        break;
+      case display_op::ATTRIBUTE_UNSET:
+        attr('-', item);
+        break;
+      case display_op::ATTRIBUTE_TOGGLE:
+        attr('!', item);
+        break;
+      case display_op::ACTION_BEGIN:
+        output += "%{A" + std::to_string(item.value) + ":" + string_util::replace_all(str(item), ":", "\\:") + ":}";
+        break;
+      case display_op::ACTION_END:
+        output += item.value ? "%{A" + std::to_string(item.value) + "}" : "%{A}";
+        break;
+      case display_op::CONTROL:
+        if (static_cast<controltag>(item.value) == controltag::R) {
+          output += "%{PR}";
+        }
+        break;
+    }
+  }
+
+  return output;
+}
+
+/**
+ * Append the contents of another list
+ */
+display_list& display_list::operator+=(const display_list& other) {
+  size_t offset{m_strings.size()};
+  auto it = other.m_items.begin();
+
+  // Join the adjacent text runs
+  if (it != other.m_items.end() && it->op == display_op::TEXT && it->pos == 0 && !m_items.empty() &&
+      m_items.back().op == display_op::TEXT && m_items.back().pos + m_items.back().len == offset) {
+    m_items.back().len += it->len;
+    it++;
+  }
+
+  m_items.reserve(m_items.size() + (other.m_items.end() - it));
+
+  for (; it != other.m_items.end(); it++) {
+    m_items.emplace_back(*it);
+    if (it->op == display_op::TEXT || it->op == display_op::ACTION_BEGIN) {
+      m_items.back().pos += offset;
+    }
+  }
+
+  m_strings += other.m_strings;
+
+  return *this;
+}
+
+bool display_list::operator==(const display_list& other) const {
+  return m_items == other.m_items && m_strings == other.m_strings;
+}
+
+bool display_list::operator!=(const display_list& other) const {
+  return !(*this == other);
+}
+
+void display_list::push(display_op op, unsigned int value, bool reset) {
+  m_items.emplace_back(display_item{op, reset, value, 0_z, 0_z});
+}
+
+POLYBAR_NS_END
@@ -1,6 +1,11 @@
-#include <fcntl.h>
-#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
+#include <algorithm>
+
+#include "components/config.hpp"
 #include "components/ipc.hpp"
 #include "components/logger.hpp"
 #include "events/signal.hpp"
@@ -14,72 +19,232 @@ POLYBAR_NS
 /**
  * Create instance
  */
-ipc::make_type ipc::make() {
-  return factory_util::unique<ipc>(signal_emitter::make(), logger::make());
+ipc::make_type ipc::make(const config& conf) {
+  return factory_util::unique<ipc>(signal_emitter::make(), logger::make(), conf.section().substr(strlen("bar/")),
+      string_util::replace(PATH_MESSAGING_SOCKET, "%pid%", to_string(getpid())));
 }
 
 /**
  * Construct ipc handler
  */
-ipc::ipc(signal_emitter& emitter, const logger& logger) : m_sig(emitter), m_log(logger) {
-  m_path = string_util::replace(PATH_MESSAGING_FIFO, "%pid%", to_string(getpid()));
+ipc::ipc(signal_emitter& emitter, const logger& logger, string bar_name, string path)
+    : m_sig(emitter), m_log(logger), m_barname(move(bar_name)), m_path(move(path)) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+
+  if (m_path.size() >= sizeof(addr.sun_path)) {
+    throw application_error("Path of ipc socket is too long: " + m_path);
+  }
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", m_path.c_str());
 
   if (file_util::exists(m_path) && unlink(m_path.c_str()) == -1) {
     throw system_error("Failed to remove ipc channel");
   }
-  if (mkfifo(m_path.c_str(), 0666) == -1) {
-    throw system_error("Failed to create ipc channel");
+  if ((m_socketfd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) == -1) {
+    throw system_error("Failed to create ipc socket");
+  }
+  if (bind(m_socketfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+    close(m_socketfd);
+    throw system_error("Failed to bind ipc socket");
+  }
+  if (listen(m_socketfd, SOMAXCONN) == -1 || (m_epollfd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+    close(m_socketfd);
+    unlink(m_path.c_str());
+    throw system_error("Failed to listen on ipc socket");
   }
 
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = m_socketfd;
+  epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_socketfd, &event);
+
   m_log.info("Created ipc channel at: %s", m_path);
-  m_fd = file_util::make_file_descriptor(m_path, O_RDONLY | O_NONBLOCK);
 }
 
 /**
  * Deconstruct ipc handler
  */
 ipc::~ipc() {
-  m_fd.reset();
-
-  if (!m_path.empty()) {
-    m_log.trace("ipc: Removing file handle");
-    unlink(m_path.c_str());
+  for (auto&& fd : m_clients) {
+    close(fd);
   }
+  close(m_epollfd);
+  close(m_socketfd);
+
+  m_log.trace("ipc: Removing socket");
+  unlink(m_path.c_str());
+}
+
+/**
+ * Register a bar hosted in this process
+ *
+ * Once a bar is added, messages are no longer emitted to the process wide
+ * emitter, except for hooks
+ */
+void ipc::add_bar(string name, signal_emitter& emitter) {
+  m_bars.emplace_back(move(name), &emitter);
 }
 
 /**
- * Receive available ipc messages and delegate valid events
+ * Accept new clients and handle the pending requests of connected ones
  */
 void ipc::receive_message() {
-  m_log.info("Receiving ipc message");
-
-  char buffer[BUFSIZ]{'\0'};
-  ssize_t bytes_read{0};
-
-  if ((bytes_read = read(*m_fd, &buffer, BUFSIZ)) == -1) {
-    m_log.err("Failed to read from ipc channel (err: %s)", strerror(errno));
-  } else if (bytes_read > 0) {
-    string payload{string_util::trim(string{buffer}, '\n')};
-
-    if (payload.find(ipc_command_prefix) == 0) {
-      m_sig.emit(signals::ipc::command{payload.substr(strlen(ipc_command_prefix))});
-    } else if (payload.find(ipc_hook_prefix) == 0) {
-      m_sig.emit(signals::ipc::hook{payload.substr(strlen(ipc_hook_prefix))});
-    } else if (payload.find(ipc_action_prefix) == 0) {
-      m_sig.emit(signals::ipc::action{payload.substr(strlen(ipc_action_prefix))});
-    } else if (!payload.empty()) {
-      m_log.warn("Received unknown ipc message: (payload=%s)", payload);
+  epoll_event events[32];
+  int count{epoll_wait(m_epollfd, events, 32, 0)};
+
+  for (int i = 0; i < count; i++) {
+    if (events[i].data.fd == m_socketfd) {
+      accept_clients();
+    } else if (!receive_requests(events[i].data.fd)) {
+      close_client(events[i].data.fd);
     }
   }
-
-  m_fd = file_util::make_file_descriptor(m_path, O_RDONLY | O_NONBLOCK);
 }
 
 /**
- * Get the file descriptor to the ipc channel
+ * Get the file descriptor that becomes readable whenever there is ipc work to do
  */
 int ipc::get_file_descriptor() const {
-  return *m_fd;
+  return m_epollfd;
+}
+
+void ipc::accept_clients() {
+  int fd;
+  while ((fd = accept4(m_socketfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+
+    if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, fd, &event) == -1) {
+      m_log.err("ipc: Failed to watch client (err: %s)", strerror(errno));
+      close(fd);
+    } else {
+      m_clients.emplace_back(fd);
+    }
+  }
+
+  if (errno != EAGAIN && errno != EWOULDBLOCK) {
+    m_log.err("ipc: Failed to accept client (err: %s)", strerror(errno));
+  }
+}
+
+/**
+ * Handle the requests queued on the client socket
+ *
+ * Returns false once the client has to be disconnected
+ */
+bool ipc::receive_requests(int fd) {
+  vector<char> buffer(ipc_max_packet_size);
+
+  // Limit the number of requests per client, so a busy client can't stall the others
+  for (int i = 0; i < 64; i++) {
+    iovec iov{buffer.data(), buffer.size()};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    ssize_t bytes{recvmsg(fd, &msg, 0)};
+    string reply;
+
+    if (bytes == -1) {
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    } else if (bytes == 0) {
+      return false;
+    } else if (msg.msg_flags & MSG_TRUNC) {
+      reply = ipc_reply_error + ":request too large"s;
+    } else {
+      reply = handle_request(string{buffer.data(), static_cast<size_t>(bytes)});
+    }
+
+    if (send(fd, reply.data(), std::min(reply.size(), ipc_max_packet_size), MSG_NOSIGNAL | MSG_DONTWAIT) == -1) {
+      m_log.warn("ipc: Failed to send reply, disconnecting client (err: %s)", strerror(errno));
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void ipc::close_client(int fd) {
+  epoll_ctl(m_epollfd, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  m_clients.erase(std::remove(m_clients.begin(), m_clients.end(), fd), m_clients.end());
+}
+
+/**
+ * Handle all messages of the request and collect their replies
+ */
+string ipc::handle_request(const string& request) {
+  auto messages = string_util::split(request, '\n');
+  string reply;
+
+  signal_emitter* bar{nullptr};
+
+  auto it = messages.begin();
+  if (it != messages.end() && it->find(ipc_bar_prefix) == 0) {
+    auto name = it->substr(strlen(ipc_bar_prefix));
+    auto added = std::find_if(m_bars.begin(), m_bars.end(), [&](const auto& b) { return b.first == name; });
+
+    if (added != m_bars.end()) {
+      bar = added->second;
+    } else if (!m_bars.empty() || name != m_barname) {
+      return ipc_reply_skip;
+    }
+    it++;
+  }
+
+  if (it == messages.end()) {
+    return ipc_reply_error + ":empty request"s;
+  }
+
+  m_log.trace("ipc: Receiving request (messages: %lu)", static_cast<size_t>(std::distance(it, messages.end())));
+
+  for (; it != messages.end(); it++) {
+    if (!reply.empty()) {
+      reply += '\n';
+    }
+    reply += handle_message(*it, bar);
+  }
+
+  return reply;
+}
+
+/**
+ * Delegate the message and get its reply
+ *
+ * The bar is the emitter of the addressed bar, if any
+ */
+string ipc::handle_message(const string& message, signal_emitter* bar) {
+  signal_emitter& target{bar != nullptr ? *bar : m_bars.empty() ? m_sig : *m_bars.front().second};
+  bool handled{false};
+
+  if (message.find(ipc_command_prefix) == 0) {
+    string command{message.substr(strlen(ipc_command_prefix))};
+    if (bar != nullptr || m_bars.empty()) {
+      handled = target.emit(signals::ipc::command{move(command)});
+    } else {
+      for (auto&& added : m_bars) {
+        handled = added.second->emit(signals::ipc::command{string{command}}) || handled;
+      }
+    }
+  } else if (message.find(ipc_hook_prefix) == 0) {
+    handled = m_sig.emit(signals::ipc::hook{message.substr(strlen(ipc_hook_prefix))});
+  } else if (message.find(ipc_action_prefix) == 0) {
+    handled = target.emit(signals::ipc::action{message.substr(strlen(ipc_action_prefix))});
+  } else if (message.find(ipc_stats_prefix) == 0 || message == "stats") {
+    ipc_stats_request request{message.substr(std::min(message.size(), strlen(ipc_stats_prefix))), ""};
+    if (target.emit(signals::ipc::stats{&request})) {
+      return request.snapshot.empty() ? ipc_reply_ok : ipc_reply_ok + ":"s + request.snapshot;
+    }
+  } else {
+    m_log.warn("Received unknown ipc message: (payload=%s)", message);
+    return ipc_reply_error + ":unknown message type"s;
+  }
+
+  if (!handled) {
+    return ipc_reply_error + ":not handled"s;
+  }
+  return ipc_reply_ok;
 }
 
 POLYBAR_NS_END
@@ -1,10 +1,9 @@
+#include <algorithm>
 #include <cassert>
 
 #include "components/parser.hpp"
+#include "components/display_list.hpp"
 #include "components/types.hpp"
-#include "events/signal.hpp"
-#include "events/signal_emitter.hpp"
-#include "settings.hpp"
 #include "utils/color.hpp"
 #include "utils/factory.hpp"
 #include "utils/memory.hpp"
@@ -12,207 +11,203 @@
 
 POLYBAR_NS
 
-using namespace signals::parser;
-
 /**
  * Create instance
  */
 parser::make_type parser::make() {
-  return factory_util::unique<parser>(signal_emitter::make());
+  return factory_util::unique<parser>();
 }
 
 /**
- * Construct parser instance
+ * Process input string and append the resulting operations to output
+ *
+ * The input is walked once from start to end, tags and text runs are
+ * referenced by their position in the input instead of being cut off of it
+ *
+ * The input may be a fragment of the bar contents, e.g. a module's format
+ * definition, so action blocks don't have to be closed within it. Action
+ * ends that can't be matched to a button are added with mousebtn::NONE
  */
-parser::parser(signal_emitter& emitter) : m_sig(emitter) {}
+void parser::parse(const bar_settings& bar, const string& data, display_list& output) {
+  size_t pos{0};
+  size_t size{data.size()};
 
-/**
- * Process input string
- */
-void parser::parse(const bar_settings& bar, string data) {
-  while (!data.empty()) {
-    size_t pos{string::npos};
-
-    if (data.compare(0, 2, "%{") == 0 && (pos = data.find('}')) != string::npos) {
-      codeblock(data.substr(2, pos - 2), bar);
-      data.erase(0, pos + 1);
-    } else if ((pos = data.find("%{")) != string::npos) {
-      data.erase(0, text(data.substr(0, pos)));
-    } else {
-      data.erase(0, text(data.substr(0)));
+  m_actions.clear();
+
+  while (pos < size) {
+    size_t next{data.find("%{", pos)};
+
+    if (next != pos) {
+      // Text up to the next tag or the end of the input
+      next = next != string::npos ? next : size;
+      output.text(data.substr(pos, next - pos));
+      pos = next;
+      continue;
+    }
+
+    size_t close{data.find('}', pos + 2)};
+
+    if (close == string::npos) {
+      // Unterminated tag, the remaining input is treated as text
+      output.text(data.substr(pos));
+      break;
     }
-  }
 
-  if (!m_actions.empty()) {
-    throw unclosed_actionblocks(to_string(m_actions.size()) + " unclosed action block(s)");
+    codeblock(data, pos + 2, close, bar, output);
+    pos = close + 1;
   }
 }
 
 /**
  * Process contents within tag blocks, i.e: %{...}
+ *
+ * \param pos Position of the first character after the opening %{
+ * \param end Position of the closing }
  */
-void parser::codeblock(string&& data, const bar_settings& bar) {
-  size_t pos;
-
-  while (data.length()) {
-    data = string_util::ltrim(move(data), ' ');
+void parser::codeblock(const string& data, size_t pos, size_t end, const bar_settings& bar, display_list& output) {
+  while (pos < end) {
+    while (pos < end && data[pos] == ' ') {
+      pos++;
+    }
 
-    if (data.empty()) {
+    if (pos == end) {
       break;
     }
 
-    char tag{data[0]};
+    char tag{data[pos++]};
 
     /*
-     * Contains the string from the current position to the next space or
-     * closing curly bracket (})
+     * The value of the tag reaches from the current position to the next
+     * space or the end of the block
      *
      * This may be unsuitable for some tags (e.g. action tag) to use
-     * These MUST set value to the actual string they parsed from the beginning
-     * of data (or a string with the same length). The length of value is used
-     * to progress the cursor further.
+     * These MUST set length to the number of characters they parsed from
+     * the current position. It is used to progress the cursor further.
      *
      * example:
      *
      * data = A1:echo "test": ...}
      *
-     * erase(0,1)
-     * -> data = 1:echo "test": ...}
+     * tag = A
+     * -> pos points at 1:echo "test": ...}
      *
      * case 'A', parse_action_cmd
-     * -> value = echo "test"
-     *
-     * Padding value
-     * -> value = echo "test"0::
-     *
-     * erase(0, value.length())
-     * -> data =  ...}
+     * -> cmd = echo "test"
      *
+     * length = btn_id + ':' + cmd + ':'
+     * -> pos points at  ...}
      */
-    string value;
+    size_t value_end = std::find(data.begin() + pos, data.begin() + end, ' ') - data.begin();
+    size_t length{value_end - pos};
 
-    // Remove the tag
-    data.erase(0, 1);
-
-    if ((pos = data.find_first_of(" }")) != string::npos) {
-      value = data.substr(0, pos);
-    } else {
-      value = data;
-    }
+    const auto value = [&] { return data.substr(pos, value_end - pos); };
+    const auto color = [&](display_op op, unsigned int fallback) {
+      auto color = value();
+      output.color(op, parse_color(color, fallback), is_reset(color));
+    };
 
     switch (tag) {
       case 'B':
-        m_sig.emit(change_background{parse_color(value, bar.background)});
+        color(display_op::BACKGROUND, bar.background);
         break;
 
       case 'F':
-        m_sig.emit(change_foreground{parse_color(value, bar.foreground)});
+        color(display_op::FOREGROUND, bar.foreground);
         break;
 
       case 'T':
-        m_sig.emit(change_font{parse_fontindex(value)});
+        output.font(parse_fontindex(value()), !length || data[pos] == '-');
         break;
 
       case 'U':
-        m_sig.emit(change_underline{parse_color(value, bar.underline.color)});
-        m_sig.emit(change_overline{parse_color(value, bar.overline.color)});
+        color(display_op::UNDERLINE, bar.underline.color);
+        color(display_op::OVERLINE, bar.overline.color);
         break;
 
       case 'u':
-        m_sig.emit(change_underline{parse_color(value, bar.underline.color)});
+        color(display_op::UNDERLINE, bar.underline.color);
         break;
 
       case 'o':
-        m_sig.emit(change_overline{parse_color(value, bar.overline.color)});
+        color(display_op::OVERLINE, bar.overline.color);
         break;
 
       case 'R':
-        m_sig.emit(reverse_colors{});
+        output.reverse();
         break;
 
       case 'O':
-        m_sig.emit(offset_pixel{static_cast<int>(std::strtol(value.c_str(), nullptr, 10))});
+        output.offset(length ? static_cast<int>(std::strtol(&data[pos], nullptr, 10)) : 0);
         break;
 
       case 'l':
-        m_sig.emit(change_alignment{alignment::LEFT});
+        output.align(alignment::LEFT);
         break;
 
       case 'c':
-        m_sig.emit(change_alignment{alignment::CENTER});
+        output.align(alignment::CENTER);
         break;
 
       case 'r':
-        m_sig.emit(change_alignment{alignment::RIGHT});
+        output.align(alignment::RIGHT);
         break;
 
       case '+':
-        m_sig.emit(attribute_set{parse_attr(value[0])});
+        output.attr(display_op::ATTRIBUTE_SET, parse_attr(length ? data[pos] : '\0'));
         break;
 
       case '-':
-        m_sig.emit(attribute_unset{parse_attr(value[0])});
+        output.attr(display_op::ATTRIBUTE_UNSET, parse_attr(length ? data[pos] : '\0'));
         break;
 
       case '!':
-        m_sig.emit(attribute_toggle{parse_attr(value[0])});
+        output.attr(display_op::ATTRIBUTE_TOGGLE, parse_attr(length ? data[pos] : '\0'));
         break;
 
       case 'A': {
-        bool has_btn_id = (data[0] != ':');
-        if (isdigit(data[0]) || !has_btn_id) {
-          value = parse_action_cmd(data.substr(has_btn_id ? 1 : 0));
-          mousebtn btn = parse_action_btn(data);
+        char btn_id{pos < end ? data[pos] : '\0'};
+        bool has_btn_id = (btn_id != ':');
+        if (isdigit(btn_id) || !has_btn_id) {
+          string cmd = parse_action_cmd(data, has_btn_id ? pos + 1 : pos, end);
+          mousebtn btn = parse_action_btn(btn_id);
           m_actions.push_back(static_cast<int>(btn));
 
-          // Unescape colons inside command before sending it to the renderer
-          auto cmd = string_util::replace_all(value, "\\:", ":");
-          m_sig.emit(action_begin{action{btn, cmd}});
+          // Unescape colons inside command
+          output.action_begin(btn, string_util::replace_all(cmd, "\\:", ":"));
 
           /*
-           * make sure value has the same length as the inside of the action
-           * tag which is btn_id + ':' + value + ':'
+           * make sure length matches the inside of the action tag which is
+           * btn_id + ':' + cmd + ':'
            */
-          if (has_btn_id) {
-            value += "0";
+          length = (has_btn_id ? 1 : 0) + cmd.size() + 2;
+        } else {
+          output.action_end(parse_action_btn(length ? btn_id : '\0'));
+          if (!m_actions.empty()) {
+            m_actions.pop_back();
           }
-          value += "::";
-        } else if (!m_actions.empty()) {
-          m_sig.emit(action_end{parse_action_btn(value)});
-          m_actions.pop_back();
         }
         break;
       }
 
       // Internal Polybar control tags
       case 'P':
-        m_sig.emit(control{parse_control(value)});
+        output.control(parse_control(value()));
         break;
 
       default:
         throw unrecognized_token("Unrecognized token '" + string{tag} + "'");
     }
 
-    if (!data.empty()) {
-      // Remove the parsed string from data
-      data.erase(0, !value.empty() ? value.length() : 1);
-    }
+    // Move past the parsed value
+    pos = std::min(end, pos + (length ? length : 1));
   }
 }
 
 /**
- * Process text contents
+ * Check if the value of a color or font tag restores the default
  */
-size_t parser::text(string&& data) {
-#ifdef DEBUG_WHITESPACE
-  string::size_type p;
-  while ((p = data.find(' ')) != string::npos) {
-    data.replace(p, 1, "-"s);
-  }
-#endif
-
-  m_sig.emit(signals::parser::text{forward<string>(data)});
-  return data.size();
+bool parser::is_reset(const string& s) {
+  return s.empty() || s[0] == '-';
 }
 
 /**
@@ -257,11 +252,11 @@ attribute parser::parse_attr(const char attr) {
 /**
  * Process action button token and convert it to the correct value
  */
-mousebtn parser::parse_action_btn(const string& data) {
-  if (data[0] == ':') {
+mousebtn parser::parse_action_btn(const char btn) {
+  if (btn == ':') {
     return mousebtn::LEFT;
-  } else if (isdigit(data[0])) {
-    return static_cast<mousebtn>(data[0] - '0');
+  } else if (isdigit(btn)) {
+    return static_cast<mousebtn>(btn - '0');
   } else if (!m_actions.empty()) {
     return static_cast<mousebtn>(m_actions.back());
   } else {
@@ -272,26 +267,29 @@ mousebtn parser::parse_action_btn(const string& data) {
 /**
  * Process action command string
  *
- * data is the action cmd surrounded by unescaped colons followed by an
- * arbitrary string
+ * data[pos] is the start of the action cmd surrounded by unescaped colons
+ * followed by an arbitrary string, end is the position at which the search
+ * for the closing colon stops
  *
  * Returns everything inside the unescaped colons as is
  */
-string parser::parse_action_cmd(string&& data) {
-  if (data[0] != ':') {
+string parser::parse_action_cmd(const string& data, size_t pos, size_t end) {
+  end = std::min(end, data.size());
+
+  if (pos >= end || data[pos] != ':') {
     return "";
   }
 
-  size_t end{1};
-  while ((end = data.find(':', end)) != string::npos && data[end - 1] == '\\') {
-    end++;
+  size_t cmd_end{pos + 1};
+  while ((cmd_end = data.find(':', cmd_end)) < end && data[cmd_end - 1] == '\\') {
+    cmd_end++;
   }
 
-  if (end == string::npos) {
+  if (cmd_end >= end) {
     return "";
   }
 
-  return data.substr(1, end - 1);
+  return data.substr(pos + 1, cmd_end - pos - 1);
 }
 
 controltag parser::parse_control(const string& data) {
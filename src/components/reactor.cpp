@@ -0,0 +1,449 @@
+#include "components/reactor.hpp"
+
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "components/logger.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+namespace {
+  /**
+   * Source whose callback is running on the current thread
+   */
+  thread_local reactor::handle_t g_current{0};
+
+  itimerspec make_timerspec(reactor::duration_t timeout, reactor::duration_t interval) {
+    const auto to_timespec = [](reactor::duration_t d) {
+      auto ns = chrono::duration_cast<chrono::nanoseconds>(d).count();
+      return timespec{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+    };
+
+    itimerspec spec{};
+    spec.it_interval = to_timespec(std::max(interval, reactor::duration_t::zero()));
+    // A zero timeout would disarm the timer instead of firing it right away
+    spec.it_value = to_timespec(std::max(timeout, reactor::duration_t{1ns}));
+    return spec;
+  }
+}  // namespace
+
+/**
+ * Create instance
+ *
+ * The module callbacks mostly read a few files or wait on short commands,
+ * a handful of workers is enough for any number of modules
+ */
+reactor::make_type reactor::make() {
+  return *factory_util::singleton<reactor>(logger::make(), 4_z);
+}
+
+reactor::reactor(const logger& logger, size_t workers) : m_log(logger) {
+  if ((m_epollfd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+    throw system_error("Failed to create epoll instance");
+  }
+  if ((m_wakeupfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1) {
+    throw system_error("Failed to create eventfd");
+  }
+
+  // Handle 0 is reserved for the wakeup fd
+  epoll_event ev{};
+  ev.events = EPOLLIN;
+  ev.data.u64 = 0;
+  if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, m_wakeupfd, &ev) == -1) {
+    throw system_error("Failed to watch eventfd");
+  }
+
+  m_pollthread = std::thread(&reactor::poll, this);
+  for (size_t i = 0; i < workers; i++) {
+    m_workers.emplace_back(&reactor::work, this, false);
+  }
+}
+
+reactor::~reactor() {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_running = false;
+  }
+
+  uint64_t value{1};
+  if (write(m_wakeupfd, &value, sizeof(value)) == -1) {
+    m_log.err("reactor: Failed to wake up poll thread (%s)", strerror(errno));
+  }
+  m_queued.notify_all();
+  m_blockingqueued.notify_all();
+
+  if (m_pollthread.joinable()) {
+    m_pollthread.join();
+  }
+  for (auto&& worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+
+  // No more blocking workers are started once m_running is cleared
+  for (auto&& worker : m_blockingworkers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+
+  for (auto&& src : m_sources) {
+    if (src.second.timer) {
+      close(src.second.fd);
+    }
+  }
+
+  close(m_wakeupfd);
+  close(m_epollfd);
+}
+
+/**
+ * Run the callback whenever the file descriptor has one of the given events
+ *
+ * The reactor doesn't take ownership of the fd, the source has to be removed
+ * before the fd is closed
+ */
+reactor::handle_t reactor::add_fd(int fd, callback_t&& callback, unsigned int events) {
+  return add(fd, false, events, forward<callback_t>(callback));
+}
+
+/**
+ * Run the callback after the timeout and then every interval
+ *
+ * A zero interval runs the callback once, the timer can be armed again
+ * using set_timer()
+ */
+reactor::handle_t reactor::add_timer(duration_t timeout, duration_t interval, callback_t&& callback) {
+  int fd{timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)};
+  if (fd == -1) {
+    throw system_error("Failed to create timerfd");
+  }
+
+  auto spec = make_timerspec(timeout, interval);
+  if (timerfd_settime(fd, 0, &spec, nullptr) == -1) {
+    close(fd);
+    throw system_error("Failed to arm timerfd");
+  }
+
+  try {
+    return add(fd, true, EPOLLIN, forward<callback_t>(callback));
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+}
+
+/**
+ * Run the callback every interval, on multiples of the interval since the epoch
+ *
+ * Timers with the same interval expire at the same time, e.g. on every full
+ * second or minute of the wall clock. The timer is aligned again if the system
+ * clock is changed
+ */
+reactor::handle_t reactor::add_aligned_timer(duration_t interval, callback_t&& callback) {
+  int fd{timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC)};
+  if (fd == -1) {
+    throw system_error("Failed to create timerfd");
+  }
+
+  try {
+    align(fd, interval);
+    return add(fd, true, EPOLLIN, forward<callback_t>(callback), interval);
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+}
+
+/**
+ * Change the timeout and interval of a timer
+ */
+void reactor::set_timer(handle_t handle, duration_t timeout, duration_t interval) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto it = m_sources.find(handle);
+
+  if (it == m_sources.end() || !it->second.timer || it->second.removed) {
+    return;
+  }
+
+  auto spec = make_timerspec(timeout, interval);
+  if (timerfd_settime(it->second.fd, 0, &spec, nullptr) == -1) {
+    throw system_error("Failed to arm timerfd");
+  }
+}
+
+/**
+ * Run the callback of the source on the blocking threads instead of the shared workers
+ *
+ * Meant for callbacks that wait for the network or other processes, which
+ * would otherwise stall the callbacks of all other sources
+ */
+void reactor::set_blocking(handle_t handle, bool blocking) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto it = m_sources.find(handle);
+
+  if (it == m_sources.end() || it->second.removed || it->second.blocking == blocking) {
+    return;
+  }
+
+  auto& src = it->second;
+  auto& queue = src.blocking ? m_blockingqueue : m_queue;
+  auto queued = std::find(queue.begin(), queue.end(), handle);
+
+  src.blocking = blocking;
+
+  // Move an already queued callback over to the other threads
+  if (queued != queue.end()) {
+    queue.erase(queued);
+    src.queued = false;
+    enqueue(handle, src);
+  }
+}
+
+/**
+ * Run the callback of the source as soon as possible
+ */
+void reactor::trigger(handle_t handle) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto it = m_sources.find(handle);
+
+  if (it == m_sources.end() || it->second.removed) {
+    return;
+  } else if (it->second.running) {
+    it->second.pending = true;
+  } else {
+    enqueue(handle, it->second);
+  }
+}
+
+/**
+ * Detach the source
+ *
+ * Waits for a running callback to finish, unless it is called from within
+ * that callback
+ */
+void reactor::remove(handle_t handle) {
+  std::unique_lock<std::mutex> guard(m_lock);
+  auto it = m_sources.find(handle);
+
+  if (it == m_sources.end() || it->second.removed) {
+    return;
+  }
+
+  epoll_ctl(m_epollfd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+  it->second.removed = true;
+
+  if (!it->second.running) {
+    if (it->second.timer) {
+      close(it->second.fd);
+    }
+    m_sources.erase(it);
+  } else if (g_current != handle) {
+    m_finished.wait(guard, [&] { return m_sources.find(handle) == m_sources.end(); });
+  }
+}
+
+/**
+ * Get the source whose callback is running on the calling thread
+ *
+ * \brief Returns 0 outside of reactor callbacks
+ */
+reactor::handle_t reactor::current() {
+  return g_current;
+}
+
+reactor::handle_t reactor::add(int fd, bool timer, unsigned int events, callback_t&& callback, duration_t aligned) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  handle_t handle{m_nexthandle++};
+  auto& src = m_sources[handle];
+  src.fd = fd;
+  src.timer = timer;
+  src.aligned = aligned;
+  src.events = events;
+  src.callback = forward<callback_t>(callback);
+
+  epoll_event ev{};
+  ev.events = events | EPOLLONESHOT;
+  ev.data.u64 = handle;
+
+  if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+    m_sources.erase(handle);
+    throw system_error("Failed to add fd " + to_string(fd) + " to epoll");
+  }
+
+  return handle;
+}
+
+/**
+ * Arm the realtime timerfd to expire on the next multiple of the interval
+ */
+void reactor::align(int fd, duration_t interval) {
+  auto now = chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch());
+  auto step = std::max(chrono::duration_cast<chrono::nanoseconds>(interval), chrono::nanoseconds{1});
+  auto next = (now / step + 1) * step;
+
+  itimerspec spec{};
+  spec.it_interval = make_timerspec(interval, interval).it_interval;
+  spec.it_value.tv_sec = static_cast<time_t>(next.count() / 1000000000);
+  spec.it_value.tv_nsec = static_cast<long>(next.count() % 1000000000);
+
+  if (timerfd_settime(fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr) == -1) {
+    throw system_error("Failed to arm timerfd");
+  }
+}
+
+/**
+ * Re-enable the one-shot epoll registration of the source
+ */
+void reactor::arm(handle_t handle, const source& src) {
+  epoll_event ev{};
+  ev.events = src.events | EPOLLONESHOT;
+  ev.data.u64 = handle;
+
+  if (epoll_ctl(m_epollfd, EPOLL_CTL_MOD, src.fd, &ev) == -1) {
+    m_log.err("reactor: Failed to re-arm fd %i (%s)", src.fd, strerror(errno));
+  }
+}
+
+void reactor::enqueue(handle_t handle, source& src) {
+  if (src.queued) {
+    return;
+  }
+
+  src.queued = true;
+
+  if (!src.blocking) {
+    m_queue.emplace_back(handle);
+    m_queued.notify_one();
+    return;
+  }
+
+  m_blockingqueue.emplace_back(handle);
+  m_blockingqueued.notify_one();
+
+  // Each queued blocking callback gets a thread of its own
+  if (m_running && m_blockingqueue.size() > m_idleblocking) {
+    m_blockingworkers.emplace_back(&reactor::work, this, true);
+  }
+}
+
+/**
+ * Wait for ready sources and hand them to the workers
+ */
+void reactor::poll() {
+  epoll_event events[32];
+
+  while (true) {
+    int count{epoll_wait(m_epollfd, events, 32, -1)};
+
+    if (count == -1 && errno != EINTR) {
+      m_log.err("reactor: epoll_wait failed (%s)", strerror(errno));
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if (!m_running) {
+      return;
+    }
+
+    for (int i = 0; i < count; i++) {
+      auto it = m_sources.find(events[i].data.u64);
+
+      if (it == m_sources.end() || it->second.removed) {
+        continue;
+      } else if (it->second.running) {
+        it->second.pending = true;
+      } else {
+        enqueue(it->first, it->second);
+      }
+    }
+  }
+}
+
+/**
+ * Run queued callbacks, either of the shared or of the blocking queue
+ */
+void reactor::work(bool blocking) {
+  auto& queue = blocking ? m_blockingqueue : m_queue;
+  auto& queued = blocking ? m_blockingqueued : m_queued;
+  std::unique_lock<std::mutex> guard(m_lock);
+
+  while (true) {
+    if (blocking) {
+      m_idleblocking++;
+    }
+    queued.wait(guard, [&] { return !queue.empty() || !m_running; });
+    if (blocking) {
+      m_idleblocking--;
+    }
+
+    if (!m_running) {
+      return;
+    }
+
+    handle_t handle{queue.front()};
+    queue.pop_front();
+
+    auto it = m_sources.find(handle);
+    if (it == m_sources.end() || it->second.removed) {
+      continue;
+    }
+
+    auto& src = it->second;
+    src.queued = false;
+    src.running = true;
+    src.pending = false;
+    guard.unlock();
+
+    if (src.timer) {
+      // Consume the expirations, the fd is non-blocking in case the callback was triggered manually
+      uint64_t expirations;
+      if (read(src.fd, &expirations, sizeof(expirations)) == -1) {
+        if (errno == ECANCELED && src.aligned.count() > 0) {
+          // The system clock has been changed
+          try {
+            align(src.fd, src.aligned);
+          } catch (const system_error& err) {
+            m_log.err("reactor: %s", err.what());
+          }
+        } else if (errno != EAGAIN) {
+          m_log.err("reactor: Failed to read timerfd (%s)", strerror(errno));
+        }
+      }
+    }
+
+    g_current = handle;
+    try {
+      src.callback();
+    } catch (const exception& err) {
+      m_log.err("reactor: Uncaught exception in callback (%s)", err.what());
+    }
+    g_current = 0;
+
+    guard.lock();
+    src.running = false;
+
+    if (src.removed) {
+      if (src.timer) {
+        close(src.fd);
+      }
+      m_sources.erase(handle);
+      m_finished.notify_all();
+    } else {
+      if (src.pending) {
+        src.pending = false;
+        enqueue(handle, src);
+      }
+      arm(handle, src);
+    }
+  }
+}
+
+POLYBAR_NS_END
@@ -1,10 +1,13 @@
 #include "components/renderer.hpp"
 
+#include <algorithm>
+
 #include "cairo/context.hpp"
 #include "components/config.hpp"
 #include "events/signal.hpp"
 #include "events/signal_emitter.hpp"
 #include "events/signal_receiver.hpp"
+#include "settings.hpp"
 #include "utils/factory.hpp"
 #include "utils/math.hpp"
 #include "x11/atoms.hpp"
@@ -19,15 +22,16 @@ static constexpr double BLOCK_GAP{20.0};
 /**
  * Create instance
  */
-renderer::make_type renderer::make(const bar_settings& bar) {
+renderer::make_type renderer::make(connection& conn, signal_emitter& sig, const config& conf, const bar_settings& bar,
+    background_manager& background_manager) {
   // clang-format off
   return factory_util::unique<renderer>(
-      connection::make(),
-      signal_emitter::make(),
-      config::make(),
+      conn,
+      sig,
+      conf,
       logger::make(),
       forward<decltype(bar)>(bar),
-      background_manager::make());
+      background_manager);
   // clang-format on
 }
 
@@ -90,6 +94,8 @@ renderer::renderer(connection& conn, signal_emitter& sig, const config& conf, co
   {
     m_pixmap = m_connection.generate_id();
     m_connection.create_pixmap(m_depth, m_pixmap, m_window, m_bar.size.w, m_bar.size.h);
+    m_flusharea.width = m_bar.size.w;
+    m_flusharea.height = m_bar.size.h;
   }
 
   m_log.trace("renderer: Allocate graphic contexts");
@@ -184,6 +190,7 @@ renderer::renderer(connection& conn, signal_emitter& sig, const config& conf, co
  */
 renderer::~renderer() {
   m_sig.detach(this);
+  clear_segments();
 }
 
 /**
@@ -202,9 +209,19 @@ const vector<action_block> renderer::actions() const {
 
 /**
  * Begin render routine
+ *
+ * \param incremental Reuse the cached contents of unchanged segments and
+ * only copy the damaged area onto the window
  */
-void renderer::begin(xcb_rectangle_t rect) {
-  m_log.trace_x("renderer: begin (geom=%ix%i+%i+%i)", rect.width, rect.height, rect.x, rect.y);
+void renderer::begin(xcb_rectangle_t rect, bool incremental) {
+  m_log.trace_x("renderer: begin (geom=%ix%i+%i+%i, incremental=%i)", rect.width, rect.height, rect.x, rect.y,
+      incremental);
+
+  // Cached segments are drawn relative to the content area
+  if (rect.x != m_rect.x || rect.y != m_rect.y || rect.width != m_rect.width || rect.height != m_rect.height) {
+    clear_segments();
+    incremental = false;
+  }
 
   // Reset state
   m_rect = rect;
@@ -212,6 +229,16 @@ void renderer::begin(xcb_rectangle_t rect) {
   m_attr.reset();
   m_align = alignment::NONE;
 
+  for (auto&& b : m_blocks) {
+    b.second.x = 0.0;
+    b.second.y = 0.0;
+  }
+
+  m_incremental = incremental;
+  m_segmented = false;
+  m_segmentcount.clear();
+  m_damage.clear();
+
   // Reset colors
   m_bg = m_bar.background;
   m_fg = m_bar.foreground;
@@ -256,6 +283,66 @@ void renderer::begin(xcb_rectangle_t rect) {
   // clang-format on
 }
 
+/**
+ * Draw the operations of the given display list
+ */
+void renderer::render(const display_list& list) {
+  for (auto&& item : list) {
+    switch (item.op) {
+      case display_op::TEXT: {
+        auto text = list.str(item);
+#ifdef DEBUG_WHITESPACE
+        std::replace(text.begin(), text.end(), ' ', '-');
+#endif
+        draw_text(text);
+        break;
+      }
+      case display_op::BACKGROUND:
+        change_background(item.value);
+        break;
+      case display_op::FOREGROUND:
+        change_foreground(item.value);
+        break;
+      case display_op::UNDERLINE:
+        change_underline(item.value);
+        break;
+      case display_op::OVERLINE:
+        change_overline(item.value);
+        break;
+      case display_op::FONT:
+        change_font(static_cast<int>(item.value));
+        break;
+      case display_op::ALIGNMENT:
+        change_alignment(static_cast<alignment>(item.value));
+        break;
+      case display_op::REVERSE:
+        reverse_colors();
+        break;
+      case display_op::OFFSET:
+        offset_pixel(static_cast<int>(item.value));
+        break;
+      case display_op::ATTRIBUTE_SET:
+        attribute_set(static_cast<attribute>(item.value));
+        break;
+      case display_op::ATTRIBUTE_UNSET:
+        attribute_unset(static_cast<attribute>(item.value));
+        break;
+      case display_op::ATTRIBUTE_TOGGLE:
+        attribute_toggle(static_cast<attribute>(item.value));
+        break;
+      case display_op::ACTION_BEGIN:
+        action_begin(static_cast<mousebtn>(item.value), list.str(item));
+        break;
+      case display_op::ACTION_END:
+        action_end(static_cast<mousebtn>(item.value));
+        break;
+      case display_op::CONTROL:
+        control(static_cast<controltag>(item.value));
+        break;
+    }
+  }
+}
+
 /**
  * End render routine
  */
@@ -267,6 +354,52 @@ void renderer::end() {
     a.end_x += block_x(a.align) + m_rect.x;
   }
 
+  // Drop cached segments that are no longer part of the bar
+  for (auto&& block : m_segments) {
+    auto count = m_segmented ? m_segmentcount[block.first] : 0U;
+    while (block.second.size() > count) {
+      auto& segment = block.second.back();
+      damage(block.first, segment.x, segment.x + segment.w);
+      m_context->destroy(&segment.pattern);
+      block.second.pop_back();
+    }
+  }
+
+  /*
+   * Only the damaged parts of the blocks need to be copied onto the window,
+   * unless one of the blocks changed its size and therefore its position
+   */
+  m_flusharea = xcb_rectangle_t{0, 0, static_cast<uint16_t>(m_bar.size.w), static_cast<uint16_t>(m_bar.size.h)};
+
+  if (m_incremental && m_segmented) {
+    bool resized{false};
+    double x1{static_cast<double>(m_rect.x + m_rect.width)};
+    double x2{static_cast<double>(m_rect.x)};
+
+    for (auto&& b : m_blocks) {
+      auto width = m_blockwidths.find(b.first);
+      resized = resized || width == m_blockwidths.end() || width->second != b.second.x;
+    }
+
+    for (auto&& d : m_damage) {
+      x1 = std::min(x1, m_rect.x + block_x(d.first) + d.second.first);
+      x2 = std::max(x2, m_rect.x + block_x(d.first) + d.second.second);
+    }
+
+    x1 = std::max(std::floor(x1), static_cast<double>(m_rect.x));
+    x2 = std::min(std::ceil(x2), static_cast<double>(m_rect.x + m_rect.width));
+
+    if (!resized && x2 > x1) {
+      m_log.trace_x("renderer: damaged area (x=%g, w=%g)", x1, x2 - x1);
+      m_flusharea.x = static_cast<int16_t>(x1);
+      m_flusharea.width = static_cast<uint16_t>(x2 - x1);
+    }
+  }
+
+  for (auto&& b : m_blocks) {
+    m_blockwidths[b.first] = b.second.x;
+  }
+
   if (m_align != alignment::NONE) {
     m_log.trace_x("renderer: pop(%i)", static_cast<int>(m_align));
     m_context->pop(&m_blocks[m_align].pattern);
@@ -417,9 +550,13 @@ void renderer::flush() {
 #endif
 
   m_surface->flush();
-  m_connection.copy_area(m_pixmap, m_window, m_gcontext, 0, 0, 0, 0, m_bar.size.w, m_bar.size.h);
+  m_connection.copy_area(m_pixmap, m_window, m_gcontext, m_flusharea.x, m_flusharea.y, m_flusharea.x,
+      m_flusharea.y, m_flusharea.width, m_flusharea.height);
   m_connection.flush();
 
+  // Anything but the end of an incremental render routine copies the whole pixmap
+  m_flusharea = xcb_rectangle_t{0, 0, static_cast<uint16_t>(m_bar.size.w), static_cast<uint16_t>(m_bar.size.h)};
+
   if (!m_snapshot_dst.empty()) {
     try {
       m_surface->write_png(m_snapshot_dst);
@@ -431,6 +568,149 @@ void renderer::flush() {
   }
 }
 
+/**
+ * Begin rendering of a bar segment
+ *
+ * Returns true if the cached contents of the segment were reused. In that
+ * case the segment doesn't need to be rendered and end_segment() must not be
+ * called
+ */
+bool renderer::begin_segment(alignment a, const display_list& contents) {
+  if (a != m_align) {
+    change_alignment(a);
+  }
+
+  m_segmented = true;
+
+  auto& segments = m_segments[a];
+  auto index = m_segmentcount[a]++;
+
+  if (index == segments.size()) {
+    segments.emplace_back();
+  }
+
+  auto& segment = segments[index];
+  double x{m_blocks[a].x};
+
+  if (m_incremental && segment.pattern != nullptr && segment.contents == contents) {
+    m_log.trace_x("renderer: reuse segment (align=%i, index=%lu)", static_cast<int>(a), index);
+
+    if (segment.x != x) {
+      damage(a, std::min(segment.x, x), std::max(segment.x, x) + segment.w);
+      segment.x = x;
+    }
+
+    paint_segment(segment);
+
+    for (auto action : segment.actions) {
+      action.start_x += x;
+      action.end_x += x;
+      m_actions.emplace_back(action);
+    }
+
+    m_blocks[a].x += segment.w;
+    return true;
+  }
+
+  if (segment.pattern != nullptr) {
+    damage(a, segment.x, segment.x + segment.w);
+    m_context->destroy(&segment.pattern);
+  }
+
+  segment.contents = contents;
+  segment.x = x;
+  segment.actions.clear();
+
+  // Every segment starts out with the default state, as if a reset tag preceded it
+  m_bg = m_bar.background;
+  m_fg = m_bar.foreground;
+  m_ul = m_bar.underline.color;
+  m_ol = m_bar.overline.color;
+  m_font = 0;
+  m_attr.reset();
+
+  m_segment = &segment;
+  m_segment_actions = m_actions.size();
+
+  // Draw the segment onto its own layer, starting at the left edge of the block
+  m_blocks[a].x = 0.0;
+  m_context->push();
+
+  return false;
+}
+
+/**
+ * Finish rendering of a bar segment and add it to the current alignment block
+ *
+ * Returns false if the segment tried to switch to a different alignment
+ * block, in which case it can't be rendered on its own
+ */
+bool renderer::end_segment() {
+  auto& segment = *m_segment;
+  m_segment = nullptr;
+
+  m_context->pop(&segment.pattern);
+  segment.w = m_blocks[m_align].x;
+  m_blocks[m_align].x = segment.x + segment.w;
+
+  for (auto action = m_actions.begin() + m_segment_actions; action != m_actions.end(); action++) {
+    segment.actions.emplace_back(*action);
+    action->start_x += segment.x;
+    action->end_x += segment.x;
+  }
+
+  paint_segment(segment);
+  damage(m_align, segment.x, segment.x + segment.w);
+
+  if (m_segment_escaped) {
+    m_segment_escaped = false;
+    m_context->destroy(&segment.pattern);
+    segment.contents.clear();
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Paint cached segment contents onto the current alignment block
+ */
+void renderer::paint_segment(const segment_block& segment) {
+  m_context->save();
+  *m_context << CAIRO_OPERATOR_OVER;
+  *m_context << cairo::translate{segment.x, 0.0};
+  *m_context << segment.pattern;
+  m_context->paint();
+  m_context->restore();
+}
+
+/**
+ * Mark range of the given alignment block as changed
+ */
+void renderer::damage(alignment a, double x1, double x2) {
+  auto range = m_damage.find(a);
+  if (range == m_damage.end()) {
+    m_damage.emplace(a, make_pair(x1, x2));
+  } else {
+    range->second.first = std::min(range->second.first, x1);
+    range->second.second = std::max(range->second.second, x2);
+  }
+}
+
+/**
+ * Destroy all cached segments
+ */
+void renderer::clear_segments() {
+  for (auto&& block : m_segments) {
+    for (auto&& segment : block.second) {
+      if (segment.pattern != nullptr) {
+        cairo_pattern_destroy(segment.pattern);
+      }
+    }
+  }
+  m_segments.clear();
+}
+
 /**
  * Get x position of block for given alignment
  *
@@ -741,54 +1021,46 @@ bool renderer::on(const signals::ui::request_snapshot& evt) {
   return true;
 }
 
-bool renderer::on(const signals::parser::change_background& evt) {
-  const unsigned int color{evt.cast()};
+void renderer::change_background(unsigned int color) {
   if (color != m_bg) {
     m_log.trace_x("renderer: change_background(#%08x)", color);
     m_bg = color;
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::change_foreground& evt) {
-  const unsigned int color{evt.cast()};
+void renderer::change_foreground(unsigned int color) {
   if (color != m_fg) {
     m_log.trace_x("renderer: change_foreground(#%08x)", color);
     m_fg = color;
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::change_underline& evt) {
-  const unsigned int color{evt.cast()};
+void renderer::change_underline(unsigned int color) {
   if (color != m_ul) {
     m_log.trace_x("renderer: change_underline(#%08x)", color);
     m_ul = color;
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::change_overline& evt) {
-  const unsigned int color{evt.cast()};
+void renderer::change_overline(unsigned int color) {
   if (color != m_ol) {
     m_log.trace_x("renderer: change_overline(#%08x)", color);
     m_ol = color;
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::change_font& evt) {
-  const int font{evt.cast()};
+void renderer::change_font(int font) {
   if (font != m_font) {
     m_log.trace_x("renderer: change_font(%i)", font);
     m_font = font;
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::change_alignment& evt) {
-  auto align = static_cast<const alignment&>(evt.cast());
-  if (align != m_align) {
+void renderer::change_alignment(alignment align) {
+  if (m_segment != nullptr) {
+    // Segments are drawn in isolation and can't switch to another block
+    m_segment_escaped = m_segment_escaped || align != m_align;
+  } else if (align != m_align) {
     m_log.trace_x("renderer: change_alignment(%i)", static_cast<int>(align));
 
     if (m_align != alignment::NONE) {
@@ -804,81 +1076,64 @@ bool renderer::on(const signals::parser::change_alignment& evt) {
 
     fill_background();
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::reverse_colors&) {
+void renderer::reverse_colors() {
   m_log.trace_x("renderer: reverse_colors");
   m_fg = m_fg + m_bg;
   m_bg = m_fg - m_bg;
   m_fg = m_fg - m_bg;
-  return true;
 }
 
-bool renderer::on(const signals::parser::offset_pixel& evt) {
-  m_log.trace_x("renderer: offset_pixel(%f)", evt.cast());
-  m_blocks[m_align].x += evt.cast();
-  return true;
+void renderer::offset_pixel(int pixels) {
+  m_log.trace_x("renderer: offset_pixel(%i)", pixels);
+  m_blocks[m_align].x += pixels;
 }
 
-bool renderer::on(const signals::parser::attribute_set& evt) {
-  m_log.trace_x("renderer: attribute_set(%i)", static_cast<int>(evt.cast()));
-  m_attr.set(static_cast<int>(evt.cast()), true);
-  return true;
+void renderer::attribute_set(attribute attr) {
+  m_log.trace_x("renderer: attribute_set(%i)", static_cast<int>(attr));
+  m_attr.set(static_cast<int>(attr), true);
 }
 
-bool renderer::on(const signals::parser::attribute_unset& evt) {
-  m_log.trace_x("renderer: attribute_unset(%i)", static_cast<int>(evt.cast()));
-  m_attr.set(static_cast<int>(evt.cast()), false);
-  return true;
+void renderer::attribute_unset(attribute attr) {
+  m_log.trace_x("renderer: attribute_unset(%i)", static_cast<int>(attr));
+  m_attr.set(static_cast<int>(attr), false);
 }
 
-bool renderer::on(const signals::parser::attribute_toggle& evt) {
-  m_log.trace_x("renderer: attribute_toggle(%i)", static_cast<int>(evt.cast()));
-  m_attr.flip(static_cast<int>(evt.cast()));
-  return true;
+void renderer::attribute_toggle(attribute attr) {
+  m_log.trace_x("renderer: attribute_toggle(%i)", static_cast<int>(attr));
+  m_attr.flip(static_cast<int>(attr));
 }
 
-bool renderer::on(const signals::parser::action_begin& evt) {
-  auto a = evt.cast();
-  m_log.trace_x("renderer: action_begin(btn=%i, command=%s)", static_cast<int>(a.button), a.command);
+void renderer::action_begin(mousebtn btn, string&& command) {
+  m_log.trace_x("renderer: action_begin(btn=%i, command=%s)", static_cast<int>(btn), command);
   action_block action{};
-  action.button = a.button == mousebtn::NONE ? mousebtn::LEFT : a.button;
+  action.button = btn == mousebtn::NONE ? mousebtn::LEFT : btn;
   action.align = m_align;
   action.start_x = m_blocks.at(m_align).x;
-  action.command = a.command;
+  action.command = forward<string>(command);
   action.active = true;
   m_actions.emplace_back(action);
-  return true;
 }
 
-bool renderer::on(const signals::parser::action_end& evt) {
-  auto btn = evt.cast();
-
+void renderer::action_end(mousebtn btn) {
   /*
    * Iterate actions in reverse and find the FIRST active action that matches
+   *
+   * mousebtn::NONE closes the most recently opened action
    */
   m_log.trace_x("renderer: action_end(btn=%i)", static_cast<int>(btn));
   for (auto action = m_actions.rbegin(); action != m_actions.rend(); action++) {
-    if (action->active && action->align == m_align && action->button == btn) {
+    if (action->active && action->align == m_align && (btn == mousebtn::NONE || action->button == btn)) {
       action->end_x = m_blocks.at(action->align).x;
       action->active = false;
       break;
     }
   }
-  return true;
-}
-
-bool renderer::on(const signals::parser::text& evt) {
-  auto text = evt.cast();
-  draw_text(text);
-  return true;
 }
 
-bool renderer::on(const signals::parser::control& evt) {
-  auto ctrl = evt.cast();
-
-  switch (ctrl) {
+void renderer::control(controltag tag) {
+  switch (tag) {
     case controltag::R:
       m_bg = m_bar.background;
       m_fg = m_bar.foreground;
@@ -891,8 +1146,6 @@ bool renderer::on(const signals::parser::control& evt) {
     case controltag::NONE:
       break;
   }
-
-  return true;
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,138 @@
+#include "components/sampler.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "errors.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+/**
+ * Open the file, throws a system_error if it can't be read
+ */
+sampled_file::sampled_file(string path) : m_path(move(path)) {
+  if ((m_fd = ::open(m_path.c_str(), O_RDONLY | O_CLOEXEC)) == -1) {
+    throw system_error("Failed to open " + m_path);
+  }
+}
+
+sampled_file::~sampled_file() {
+  close(m_fd);
+}
+
+const string& sampled_file::path() const {
+  return m_path;
+}
+
+/**
+ * Get the contents of the file
+ *
+ * The file is only read again if the last snapshot is older than the given
+ * max age. Throws a system_error if it can't be read
+ */
+sample_t sampled_file::read(duration_t max_age) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto now = chrono::steady_clock::now();
+
+  if (m_sample && now - m_sample->time <= max_age) {
+    return m_sample;
+  }
+
+  // The buffer of the last snapshot is reused, unless a module still holds on to it
+  if (!m_sample || m_sample.use_count() > 1) {
+    auto next = make_shared<sample>();
+    next->data.reserve(m_sample ? m_sample->data.capacity() : BUFSIZ);
+    m_sample = move(next);
+  }
+
+  try {
+    refresh(*m_sample);
+  } catch (...) {
+    m_sample.reset();
+    throw;
+  }
+
+  m_sample->time = now;
+  return m_sample;
+}
+
+void sampled_file::refresh(sample& s) {
+  size_t size{0};
+  bool reopened{false};
+  s.data.resize(std::max(s.data.capacity(), size_t{BUFSIZ}));
+
+  while (true) {
+    ssize_t bytes{pread(m_fd, &s.data[size], s.data.size() - size, size)};
+
+    if (bytes == -1 && errno == EINTR) {
+      continue;
+    } else if (bytes == -1 && (errno == ENODEV || errno == ENOENT) && !reopened) {
+      // The device went away, e.g. a hot-swapped battery. Try once if it is back
+      reopen();
+      reopened = true;
+      size = 0;
+      continue;
+    } else if (bytes == -1) {
+      throw system_error("Failed to read " + m_path);
+    } else if (bytes == 0) {
+      break;
+    }
+
+    size += bytes;
+    if (size == s.data.size()) {
+      s.data.resize(size * 2);
+    }
+  }
+
+  s.data.resize(size);
+}
+
+/**
+ * Open the path again, throws a system_error if it doesn't exist anymore
+ */
+void sampled_file::reopen() {
+  int fd{::open(m_path.c_str(), O_RDONLY | O_CLOEXEC)};
+
+  if (fd == -1) {
+    throw system_error("Failed to open " + m_path);
+  }
+
+  close(m_fd);
+  m_fd = fd;
+}
+
+/**
+ * Create instance
+ */
+sampler::make_type sampler::make() {
+  return *factory_util::singleton<sampler>();
+}
+
+/**
+ * Get the shared handle of the file, throws a system_error if it can't be opened
+ */
+shared_ptr<sampled_file> sampler::open(const string& path) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  // Forget the files that were released in the meantime
+  for (auto it = m_files.begin(); it != m_files.end();) {
+    if (it->second.expired()) {
+      it = m_files.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  auto file = m_files[path].lock();
+  if (!file) {
+    file = make_shared<sampled_file>(path);
+    m_files[path] = file;
+  }
+
+  return file;
+}
+
+POLYBAR_NS_END
@@ -21,8 +21,8 @@ using namespace signals::eventqueue;
 /**
  * Create instance
  */
-screen::make_type screen::make() {
-  return factory_util::unique<screen>(connection::make(), signal_emitter::make(), logger::make(), config::make());
+screen::make_type screen::make(connection& conn, signal_emitter& emitter, const config& conf) {
+  return factory_util::unique<screen>(conn, emitter, logger::make(), conf);
 }
 
 /**
@@ -1,6 +1,5 @@
-#include <algorithm>
-
 #include "components/taskqueue.hpp"
+
 #include "utils/factory.hpp"
 
 POLYBAR_NS
@@ -11,100 +10,140 @@ taskqueue::make_type taskqueue::make() {
 
 taskqueue::taskqueue() {
   m_thread = std::thread([&] {
-    while (m_active) {
-      std::unique_lock<std::mutex> guard(m_lock);
+    std::unique_lock<std::mutex> guard(m_lock);
 
-      if (m_deferred.empty()) {
+    while (m_active) {
+      if (m_queue.empty()) {
         m_hold.wait(guard);
+      } else if (m_queue.top().first > deferred::clock::now()) {
+        m_hold.wait_until(guard, m_queue.top().first);
       } else {
-        auto now = deferred::clock::now();
-        auto wait = m_deferred.front()->now + m_deferred.front()->wait;
-        for (auto&& task : m_deferred) {
-          auto when = task->now + task->wait;
-          if (when < wait) {
-            wait = move(when);
-          }
-        }
-        if (wait > now) {
-          m_hold.wait_for(guard, wait - now);
-        }
-      }
-      if (!m_deferred.empty()) {
-        guard.unlock();
-        tick();
+        tick(guard);
       }
     }
   });
 }
 
 taskqueue::~taskqueue() {
-  if (m_active && m_thread.joinable()) {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
     m_active = false;
-    m_hold.notify_all();
+  }
+  m_hold.notify_all();
+  if (m_thread.joinable()) {
     m_thread.join();
   }
 }
 
+/**
+ * Run the callback count times, the first time after offset + ms and then
+ * every ms
+ */
 void taskqueue::defer(
     string id, deferred::duration ms, deferred::callback fn, deferred::duration offset, size_t count) {
-  std::unique_lock<std::mutex> guard(m_lock);
-  deferred::timepoint now{chrono::time_point_cast<deferred::duration>(deferred::clock::now() + move(offset))};
-  m_deferred.emplace_back(make_unique<deferred>(move(id), move(now), move(ms), move(fn), move(count)));
-  guard.unlock();
-  m_hold.notify_one();
+  std::lock_guard<std::mutex> guard(m_lock);
+  add(move(id), ms, move(fn), offset, count);
 }
 
+/**
+ * Same as defer() but replaces all pending tasks with the same id
+ */
 void taskqueue::defer_unique(
     string id, deferred::duration ms, deferred::callback fn, deferred::duration offset, size_t count) {
-  purge(id);
-  std::unique_lock<std::mutex> guard(m_lock);
-  deferred::timepoint now{chrono::time_point_cast<deferred::duration>(deferred::clock::now() + move(offset))};
-  m_deferred.emplace_back(make_unique<deferred>(move(id), move(now), move(ms), move(fn), move(count)));
-  guard.unlock();
-  m_hold.notify_one();
+  std::lock_guard<std::mutex> guard(m_lock);
+  remove(id);
+  add(move(id), ms, move(fn), offset, count);
 }
 
-void taskqueue::tick() {
-  if (!m_lock.try_lock()) {
+bool taskqueue::exist(const string& id) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_ids.find(id) != m_ids.end();
+}
+
+bool taskqueue::purge(const string& id) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  return remove(id) > 0;
+}
+
+void taskqueue::add(
+    string&& id, deferred::duration ms, deferred::callback&& fn, deferred::duration offset, size_t count) {
+  if (!count) {
     return;
   }
-  std::unique_lock<std::mutex> guard(m_lock, std::adopt_lock);
+
+  auto when = chrono::time_point_cast<deferred::duration>(deferred::clock::now()) + offset + ms;
+  auto handle = m_nexthandle++;
+  m_ids.emplace(id, handle);
+  m_tasks.emplace(handle, make_unique<deferred>(move(id), when, ms, move(fn), count));
+  schedule(handle, when);
+}
+
+/**
+ * Queue the due time of the task
+ *
+ * The worker is only woken up if the task is due before everything else,
+ * otherwise it already waits for an earlier deadline
+ */
+void taskqueue::schedule(handle_t handle, deferred::timepoint when) {
+  bool earliest{m_queue.empty() || when < m_queue.top().first};
+  m_queue.emplace(when, handle);
+  if (earliest) {
+    m_hold.notify_one();
+  }
+}
+
+size_t taskqueue::remove(const string& id) {
+  auto range = m_ids.equal_range(id);
+  size_t count{0};
+  for (auto it = range.first; it != range.second; ++it, ++count) {
+    m_tasks.erase(it->second);
+  }
+  m_ids.erase(range.first, range.second);
+  return count;
+}
+
+/**
+ * Run all due tasks
+ *
+ * The callbacks are called without holding the lock so that they can
+ * schedule new tasks
+ */
+void taskqueue::tick(std::unique_lock<std::mutex>& guard) {
   auto now = chrono::time_point_cast<deferred::duration>(deferred::clock::now());
   vector<pair<deferred::callback, size_t>> cbs;
-  for (auto it = m_deferred.rbegin(); it != m_deferred.rend(); ++it) {
-    auto& task = *it;
-    if (task->now + task->wait > now) {
+
+  while (!m_queue.empty() && m_queue.top().first <= now) {
+    auto entry = m_queue.top();
+    m_queue.pop();
+
+    auto it = m_tasks.find(entry.second);
+    if (it == m_tasks.end() || it->second->when != entry.first) {
       continue;
-    } else if (task->count--) {
-      cbs.emplace_back(make_pair(task->func, task->count));
-      task->now = now;
-    } else {
-      m_deferred.erase(std::remove_if(m_deferred.begin(), m_deferred.end(),
-                           [&](const unique_ptr<deferred>& d) { return d == task; }),
-          m_deferred.end());
     }
-  }
-  guard.unlock();
-  for (auto&& p : cbs) {
-    p.first(p.second);
-  }
-}
 
-bool taskqueue::purge(const string& id) {
-  std::lock_guard<std::mutex> guard(m_lock);
-  return m_deferred.erase(std::remove_if(m_deferred.begin(), m_deferred.end(),
-                              [id](const unique_ptr<deferred>& d) { return d->id == id; }),
-             m_deferred.end()) == m_deferred.end();
-}
+    auto& task = *it->second;
+    cbs.emplace_back(task.func, --task.count);
 
-bool taskqueue::exist(const string& id) {
-  std::lock_guard<std::mutex> guard(m_lock);
-  for (const auto& task : m_deferred) {
-    if (task->id == id) {
-      return true;
+    if (task.count) {
+      task.when = now + task.wait;
+      m_queue.emplace(task.when, entry.second);
+    } else {
+      auto range = m_ids.equal_range(task.id);
+      for (auto id = range.first; id != range.second; ++id) {
+        if (id->second == entry.second) {
+          m_ids.erase(id);
+          break;
+        }
+      }
+      m_tasks.erase(it);
     }
   }
-  return false;
+
+  guard.unlock();
+  for (auto&& cb : cbs) {
+    cb.first(cb.second);
+  }
+  guard.lock();
 }
 
 POLYBAR_NS_END
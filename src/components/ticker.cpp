@@ -0,0 +1,137 @@
+#include "components/ticker.hpp"
+
+#include <algorithm>
+
+#include "events/signal.hpp"
+#include "events/signal_emitter.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+/**
+ * Create instance
+ */
+ticker::make_type ticker::make() {
+  return *factory_util::singleton<ticker>(reactor::make(), signal_emitter::make());
+}
+
+ticker::ticker(reactor& reactor, signal_emitter& emitter) : m_reactor(reactor), m_sig(emitter) {}
+
+ticker::~ticker() {
+  std::map<chrono::milliseconds, group> groups;
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    groups.swap(m_groups);
+  }
+  for (auto&& g : groups) {
+    m_reactor.remove(g.second.timer);
+  }
+}
+
+/**
+ * Run the callback on every tick of the interval
+ *
+ * The callback returns true if the output has changed. The interval is
+ * rounded to milliseconds
+ */
+ticker::handle_t ticker::add(duration_t interval, callback_t&& callback) {
+  auto ms = std::max(chrono::duration_cast<chrono::milliseconds>(interval), chrono::milliseconds{1});
+
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto handle = m_nexthandle++;
+  auto& e = m_entries[handle];
+  e.callback = forward<callback_t>(callback);
+  e.interval = ms;
+
+  auto& g = m_groups[ms];
+  if (!g.timer) {
+    g.timer = m_reactor.add_aligned_timer(ms, [this, ms] { tick(ms); });
+  }
+  g.entries.emplace_back(handle);
+
+  return handle;
+}
+
+/**
+ * Detach the callback
+ *
+ * Waits for the callback to finish if it is part of a running tick, unless it
+ * is called from within the callback
+ */
+void ticker::remove(handle_t handle) {
+  std::unique_lock<std::mutex> guard(m_lock);
+  auto it = m_entries.find(handle);
+
+  if (it == m_entries.end() || it->second.removed) {
+    return;
+  }
+
+  it->second.removed = true;
+
+  reactor::handle_t timer{0};
+  auto g = m_groups.find(it->second.interval);
+  auto& entries = g->second.entries;
+  entries.erase(std::remove(entries.begin(), entries.end(), handle), entries.end());
+  if (entries.empty()) {
+    timer = g->second.timer;
+    m_groups.erase(g);
+  }
+
+  if (!it->second.running) {
+    m_entries.erase(it);
+  } else if (it->second.runner != std::this_thread::get_id()) {
+    m_finished.wait(guard, [&] { return m_entries.find(handle) == m_entries.end(); });
+  }
+
+  guard.unlock();
+
+  if (timer) {
+    m_reactor.remove(timer);
+  }
+}
+
+/**
+ * Run all callbacks of the interval and notify the controller once
+ */
+void ticker::tick(chrono::milliseconds interval) {
+  vector<pair<handle_t, callback_t*>> callbacks;
+
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto g = m_groups.find(interval);
+    if (g == m_groups.end()) {
+      return;
+    }
+    for (auto&& handle : g->second.entries) {
+      auto& e = m_entries[handle];
+      e.running = true;
+      e.runner = std::this_thread::get_id();
+      callbacks.emplace_back(handle, &e.callback);
+    }
+  }
+
+  bool changed{false};
+
+  for (auto&& cb : callbacks) {
+    std::unique_lock<std::mutex> guard(m_lock);
+    auto& e = m_entries[cb.first];
+
+    if (!e.removed) {
+      guard.unlock();
+      changed = (*cb.second)() || changed;
+      guard.lock();
+    }
+
+    e.running = false;
+    if (e.removed) {
+      m_entries.erase(cb.first);
+      m_finished.notify_all();
+    }
+  }
+
+  if (changed) {
+    m_sig.emit(signals::eventqueue::notify_change{});
+  }
+}
+
+POLYBAR_NS_END
@@ -37,27 +37,46 @@ namespace drawtypes {
     m_colorstep = m_colors.empty() ? 1 : m_width / m_colors.size();
   }
 
-  string progressbar::output(float percentage) {
-    string output{m_format};
-
+  display_list progressbar::output(float percentage) {
     // Get fill/empty widths based on percentage
     unsigned int perc = math_util::cap(percentage, 0.0f, 100.0f);
     unsigned int fill_width = math_util::percentage_to_value(perc, m_width);
     unsigned int empty_width = m_width - fill_width;
 
-    // Output fill icons
-    fill(perc, fill_width);
-    output = string_util::replace_all(output, "%fill%", m_builder->flush());
+    size_t pos{0};
+
+    while (pos < m_format.size()) {
+      // Find the next token in the format
+      size_t next{string::npos};
+      string token;
 
-    // Output indicator icon
-    m_builder->node(m_indicator);
-    output = string_util::replace_all(output, "%indicator%", m_builder->flush());
+      for (auto&& t : {"%fill%", "%indicator%", "%empty%"}) {
+        size_t found{m_format.find(t, pos)};
+        if (found < next) {
+          next = found;
+          token = t;
+        }
+      }
 
-    // Output empty icons
-    m_builder->node_repeat(m_empty, empty_width);
-    output = string_util::replace_all(output, "%empty%", m_builder->flush());
+      m_builder->append(m_format.substr(pos, next - pos));
+
+      if (next == string::npos) {
+        break;
+      } else if (token == "%fill%") {
+        // Output fill icons
+        fill(perc, fill_width);
+      } else if (token == "%indicator%") {
+        // Output indicator icon
+        m_builder->node(m_indicator);
+      } else {
+        // Output empty icons
+        m_builder->node_repeat(m_empty, empty_width);
+      }
+
+      pos = next + token.size();
+    }
 
-    return output;
+    return m_builder->flush();
   }
 
   void progressbar::fill(unsigned int perc, unsigned int fill_width) {
@@ -1,20 +1,39 @@
 #include <fcntl.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <iostream>
 #include <vector>
 
 #include "common.hpp"
+#include "components/ipc.hpp"
 #include "utils/file.hpp"
 #include "utils/io.hpp"
+#include "utils/string.hpp"
 
 using namespace polybar;
 using namespace std;
 
 #ifndef IPC_CHANNEL_PREFIX
-#define IPC_CHANNEL_PREFIX "/tmp/polybar_mqueue."
+#define IPC_CHANNEL_PREFIX "/tmp/polybar_ipc."
 #endif
 
+/**
+ * Connection to the ipc socket of a bar
+ */
+struct channel {
+  string path;
+  int fd{-1};
+  bool skipped{false};
+  bool failed{false};
+  size_t delivered{0};
+  size_t errors{0};
+};
+
 void display(const string& msg) {
   fprintf(stdout, "%s\n", msg.c_str());
 }
@@ -24,12 +43,16 @@ void log(int exit_code, const string& msg) {
   exit(exit_code);
 }
 
+void warn(const string& msg) {
+  fprintf(stderr, "polybar-msg: %s\n", msg.c_str());
+}
+
 void usage(const string& parameters) {
-  fprintf(stderr, "Usage: polybar-msg [-p pid] %s\n", parameters.c_str());
+  fprintf(stderr, "Usage: polybar-msg [-p pid] [-b bar] %s\n", parameters.c_str());
   exit(127);
 }
 
-void remove_pipe(const string& handle) {
+void remove_channel(const string& handle) {
   if (unlink(handle.c_str()) == -1) {
     log(1, "Could not remove stale ipc channel: "s + strerror(errno));
   } else {
@@ -38,7 +61,54 @@ void remove_pipe(const string& handle) {
 }
 
 bool validate_type(const string& type) {
-  return (type == "action" || type == "cmd" || type == "hook");
+  return (type == "action" || type == "cmd" || type == "hook" || type == "stats");
+}
+
+/**
+ * Connect to the socket, returns -1 if nobody is listening on it
+ */
+int connect_channel(const string& path) {
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path.c_str());
+
+  int fd{socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)};
+  if (fd == -1) {
+    log(1, "Failed to create socket: "s + strerror(errno));
+  }
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+    int err{errno};
+    close(fd);
+    errno = err;
+    return -1;
+  }
+
+  // Don't hang forever on a bar that stopped responding
+  timeval timeout{5, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  return fd;
+}
+
+/**
+ * Pack the messages into as few requests as possible
+ */
+vector<string> make_requests(const vector<string>& messages, const string& bar) {
+  const string header{bar.empty() ? "" : ipc_bar_prefix + bar + "\n"};
+  vector<string> requests;
+  string request;
+
+  for (auto&& message : messages) {
+    if (!request.empty() && header.size() + request.size() + message.size() + 1 > ipc_max_packet_size) {
+      requests.emplace_back(header + request);
+      request.clear();
+    }
+    request += message + "\n";
+  }
+  if (!request.empty()) {
+    requests.emplace_back(header + request);
+  }
+
+  return requests;
 }
 
 int main(int argc, char** argv) {
@@ -51,84 +121,174 @@ int main(int argc, char** argv) {
   vector<string> args{argv + 1, argv + argc};
   string::size_type p;
   int pid{0};
+  string bar;
 
-  // If -p <pid> is passed, check if the process is running and that
-  // a valid channel pipe is available
-  if (args.size() >= 2 && args[0].compare(0, 2, "-p") == 0) {
-    if (!file_util::exists("/proc/" + args[1])) {
-      log(E_INVALID_PID, "No process with pid " + args[1]);
-    } else if (!file_util::exists(IPC_CHANNEL_PREFIX + args[1])) {
-      log(E_INVALID_CHANNEL, "No channel available for pid " + args[1]);
+  while (args.size() >= 2 && (args[0] == "-p" || args[0] == "-b")) {
+    // If -p <pid> is passed, check if the process is running and that
+    // a valid channel is available
+    if (args[0] == "-p") {
+      if (!file_util::exists("/proc/" + args[1])) {
+        log(E_INVALID_PID, "No process with pid " + args[1]);
+      } else if (!file_util::exists(IPC_CHANNEL_PREFIX + args[1])) {
+        log(E_INVALID_CHANNEL, "No channel available for pid " + args[1]);
+      }
+      pid = strtol(args[1].c_str(), nullptr, 10);
+    } else {
+      bar = args[1];
     }
 
-    pid = strtol(args[1].c_str(), nullptr, 10);
     args.erase(args.begin());
     args.erase(args.begin());
   }
 
   // Validate args
   auto help = find_if(args.begin(), args.end(), [](string a) { return a == "-h" || a == "--help"; }) != args.end();
-  if (help || args.size() < 2) {
-    usage("<command=(action|cmd|hook)> <payload> [...]");
-  } else if (!validate_type(args[0])) {
+  bool batch{args.size() == 1 && args[0] == "-"};
+  if (help || args.empty() || (args.size() < 2 && !batch && args[0] != "stats")) {
+    usage("<command=(action|cmd|hook|stats)> <payload> [...]\n       polybar-msg [-p pid] [-b bar] - < messages");
+  } else if (!batch && !validate_type(args[0])) {
     log(E_MESSAGE_TYPE, "\"" + args[0] + "\" is not a valid type.");
   }
 
-  string ipc_type{args[0]};
-  args.erase(args.begin());
-  string ipc_payload{args[0]};
-  args.erase(args.begin());
-
-  // Check hook specific args
-  if (ipc_type == "hook") {
-    if (args.size() != 1) {
-      usage("hook <module-name> <hook-index>");
-    } else if ((p = ipc_payload.find("module/")) != 0) {
-      ipc_payload = "module/" + ipc_payload + args[0];
-      args.erase(args.begin());
-    } else {
-      ipc_payload += args[0];
+  vector<string> messages;
+
+  if (batch) {
+    // One <type>:<payload> message per line
+    string line;
+    while (getline(cin, line)) {
+      if (line.empty()) {
+        continue;
+      } else if ((p = line.find(':')) == string::npos || !validate_type(line.substr(0, p))) {
+        log(E_MESSAGE_TYPE, "\"" + line + "\" is not a valid message.");
+      }
+      messages.emplace_back(line);
+    }
+  } else {
+    string ipc_type{args[0]};
+    args.erase(args.begin());
+    string ipc_payload{args.empty() ? "" : args[0]};
+    if (!args.empty()) {
       args.erase(args.begin());
     }
+
+    // Check hook specific args
+    if (ipc_type == "hook") {
+      if (args.size() != 1) {
+        usage("hook <module-name> <hook-index>");
+      } else if ((p = ipc_payload.find("module/")) != 0) {
+        ipc_payload = "module/" + ipc_payload + args[0];
+        args.erase(args.begin());
+      } else {
+        ipc_payload += args[0];
+        args.erase(args.begin());
+      }
+    }
+
+    // The stats are written by the bar process, which has a different working directory.
+    // A %pid% token in the path is replaced with the pid of each bar
+    if (ipc_type == "stats" && !ipc_payload.empty() && ipc_payload[0] != '/') {
+      char cwd[PATH_MAX];
+      if (getcwd(cwd, sizeof(cwd)) == nullptr) {
+        log(1, "Failed to get working directory: "s + strerror(errno));
+      }
+      ipc_payload = cwd + "/"s + ipc_payload;
+    }
+
+    messages.emplace_back(ipc_type + ':' + ipc_payload);
   }
 
-  // Get availble channel pipes
-  auto pipes = file_util::glob(IPC_CHANNEL_PREFIX + "*"s);
+  if (messages.empty()) {
+    log(E_MESSAGE_TYPE, "No messages to send");
+  }
+
+  // Get available channels
+  auto paths = file_util::glob(IPC_CHANNEL_PREFIX + "*"s);
+  vector<channel> channels;
 
-  // Remove stale channel files without a running parent process
-  for (auto it = pipes.rbegin(); it != pipes.rend(); it++) {
-    if ((p = it->rfind('.')) == string::npos) {
+  for (auto&& path : paths) {
+    if ((p = path.rfind('.')) == string::npos) {
       continue;
-    } else if (!file_util::exists("/proc/" + it->substr(p + 1))) {
-      remove_pipe(*it);
-      pipes.erase(remove(pipes.begin(), pipes.end(), *it), pipes.end());
-    } else if (pid && to_string(pid) != it->substr(p + 1)) {
-      pipes.erase(remove(pipes.begin(), pipes.end(), *it), pipes.end());
+    } else if (!file_util::exists("/proc/" + path.substr(p + 1))) {
+      // Remove stale channel files without a running parent process
+      remove_channel(path);
+    } else if (!pid || to_string(pid) == path.substr(p + 1)) {
+      channel c;
+      c.path = path;
+      if ((c.fd = connect_channel(path)) == -1) {
+        warn("Failed to connect to \"" + path + "\" (err: " + strerror(errno) + ")");
+      } else {
+        channels.emplace_back(move(c));
+      }
     }
   }
 
-  if (pipes.empty()) {
+  if (channels.empty()) {
     log(E_NO_CHANNELS, "No active ipc channels");
   }
 
+  auto requests = make_requests(messages, bar);
+  vector<char> buffer(ipc_max_packet_size + 1);
+
+  // Keep one request in flight per bar, so all bars handle the messages concurrently
+  for (auto&& request : requests) {
+    for (auto&& c : channels) {
+      if (!c.skipped && !c.failed && send(c.fd, request.data(), request.size(), MSG_NOSIGNAL) == -1) {
+        warn("Failed to write to \"" + c.path + "\" (err: " + strerror(errno) + ")");
+        c.failed = true;
+      }
+    }
+
+    for (auto&& c : channels) {
+      if (c.skipped || c.failed) {
+        continue;
+      }
+
+      ssize_t bytes{recv(c.fd, buffer.data(), buffer.size(), 0)};
+      if (bytes <= 0) {
+        warn("No reply from \"" + c.path + "\"" + (bytes == -1 ? " (err: "s + strerror(errno) + ")" : ""));
+        c.failed = true;
+        continue;
+      }
+
+      for (auto&& reply : string_util::split(string{buffer.data(), static_cast<size_t>(bytes)}, '\n')) {
+        if (reply == ipc_reply_skip) {
+          c.skipped = true;
+        } else if (reply.find(ipc_reply_ok) == 0) {
+          c.delivered++;
+          if (reply.size() > strlen(ipc_reply_ok) + 1) {
+            display(reply.substr(strlen(ipc_reply_ok) + 1));
+          }
+        } else {
+          warn("\"" + c.path + "\" replied: " + reply);
+          c.errors++;
+        }
+      }
+    }
+  }
+
   int exit_status = 127;
+  bool failed{false};
 
-  // Write message to each available channel or match
-  // against pid if one was defined
-  for (auto&& channel : pipes) {
-    try {
-      file_descriptor fd(channel, O_WRONLY | O_NONBLOCK);
-      string payload{ipc_type + ':' + ipc_payload};
-      if (write(fd, payload.c_str(), payload.size()) != -1) {
-        display("Successfully wrote \"" + payload + "\" to \"" + channel + "\"");
-        exit_status = 0;
-      } else {
-        log(E_WRITE, "Failed to write \"" + payload + "\" to \"" + channel + "\" (err: " + strerror(errno) + ")");
+  for (auto&& c : channels) {
+    close(c.fd);
+
+    if (c.failed || c.errors) {
+      failed = true;
+    } else if (!c.skipped) {
+      exit_status = 0;
+      if (!batch && messages[0].find(ipc_stats_prefix) != 0) {
+        display("Successfully wrote \"" + messages[0] + "\" to \"" + c.path + "\"");
+      } else if (batch) {
+        display("Successfully wrote " + to_string(c.delivered) + " message(s) to \"" + c.path + "\"");
       }
-    } catch (const exception& err) {
-      remove_pipe(channel);
     }
   }
 
+  if (failed) {
+    exit_status = E_WRITE;
+  } else if (exit_status != 0 && !bar.empty()) {
+    log(E_NO_CHANNELS, "No active bar named \"" + bar + "\"");
+  }
+
   return exit_status;
 }
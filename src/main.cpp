@@ -4,9 +4,11 @@
 #include "components/config_parser.hpp"
 #include "components/controller.hpp"
 #include "components/ipc.hpp"
+#include "events/signal_emitter.hpp"
 #include "utils/env.hpp"
 #include "utils/inotify.hpp"
 #include "utils/process.hpp"
+#include "utils/scope.hpp"
 #include "x11/connection.hpp"
 
 using namespace polybar;
@@ -101,8 +103,16 @@ int main(int argc, char** argv) {
     if (!cli->has(0)) {
       cli->usage();
       return EXIT_FAILURE;
-    } else if (cli->has(1)) {
-      fprintf(stderr, "Unrecognized argument \"%s\"\n", cli->get(1).c_str());
+    }
+
+    // Every bar passed in is hosted in this process
+    vector<string> barnames;
+    for (size_t i = 0; cli->has(i); i++) {
+      barnames.emplace_back(cli->get(i));
+    }
+
+    if (barnames.size() > 1 && (cli->has("stdout") || cli->has("png"))) {
+      fprintf(stderr, "--stdout and --png can only be used with a single bar\n");
       cli->usage();
       return EXIT_FAILURE;
     }
@@ -116,37 +126,81 @@ int main(int argc, char** argv) {
       throw application_error("Define configuration using --config=PATH");
     }
 
-    config_parser parser{logger, move(confpath), cli->get(0)};
+    // The first bar uses the process wide config the modules read from, the others get their own
+    config_parser parser{logger, string{confpath}, string{barnames.front()}};
     config::make_type conf = parser.parse();
 
+    vector<const config*> confs{&conf};
+    vector<unique_ptr<config>> other_confs;
+    for (auto it = barnames.begin() + 1; it != barnames.end(); it++) {
+      other_confs.emplace_back(make_unique<config>(logger, string{confpath}, string{*it}));
+      config_parser{logger, string{confpath}, string{*it}}.parse(*other_confs.back());
+      confs.emplace_back(other_confs.back().get());
+    }
+
+    // Each bar gets its own emitter, the process wide one is left to the modules
+    vector<unique_ptr<signal_emitter>> sigs;
+    for (size_t i = 0; i < barnames.size(); i++) {
+      sigs.emplace_back(make_unique<signal_emitter>());
+    }
+
     //==================================================
     // Dump requested data
     //==================================================
     if (cli->has("dump")) {
-      printf("%s\n", conf.get(conf.section(), cli->get("dump")).c_str());
+      for (auto&& c : confs) {
+        printf("%s\n", c->get(c->section(), cli->get("dump")).c_str());
+      }
       return EXIT_SUCCESS;
     }
     if (cli->has("print-wmname")) {
-      printf("%s\n", bar::make(true)->settings().wmname.c_str());
+      for (size_t i = 0; i < confs.size(); i++) {
+        printf("%s\n", bar::make(conn, *sigs[i], *confs[i], true)->settings().wmname.c_str());
+      }
       return EXIT_SUCCESS;
     }
 
     //==================================================
-    // Create controller and run application
+    // Create controllers and run application
     //==================================================
-    unique_ptr<ipc> ipc{};
+    shared_ptr<ipc> ipc{};
     unique_ptr<inotify_watch> config_watch{};
 
     if (conf.get(conf.section(), "enable-ipc", false)) {
-      ipc = ipc::make();
+      ipc = ipc::make(conf);
+      if (barnames.size() > 1) {
+        for (size_t i = 0; i < barnames.size(); i++) {
+          ipc->add_bar(barnames[i], *sigs[i]);
+        }
+      }
     }
     if (cli->has("reload")) {
       config_watch = inotify_util::make_watch(conf.filepath());
     }
 
-    auto ctrl = controller::make(move(ipc), move(config_watch));
+    /*
+     * Bars hosted in the same process share the connection, the fonts and the
+     * instances of their modules. The first bar runs the event loop for all
+     */
+    module_registry registry;
+    vector<unique_ptr<controller>> ctrls;
+    for (size_t i = 0; i < barnames.size(); i++) {
+      ctrls.emplace_back(controller::make(conn, *sigs[i], *confs[i], ipc,
+          i == 0 ? move(config_watch) : unique_ptr<inotify_watch>{}, barnames.size() > 1 ? &registry : nullptr));
+    }
+
+    // All bars are stopped before the first one is destroyed
+    auto stop_bars = scope_util::make_exit_handler([&] {
+      for (auto&& ctrl : ctrls) {
+        ctrl->stop();
+      }
+    });
+
+    for (auto it = ctrls.begin() + 1; it != ctrls.end(); it++) {
+      (*it)->start(false, "");
+    }
 
-    if (!ctrl->run(cli->has("stdout"), cli->get("png"))) {
+    if (!ctrls.front()->run(cli->has("stdout"), cli->get("png"))) {
       reload = true;
     }
   } catch (const exception& err) {
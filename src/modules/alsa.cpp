@@ -94,25 +94,40 @@ namespace modules {
   }
 
   bool alsa_module::has_event() {
-    // Poll for mixer and control events
+    // Consume the mixer and control events, one of the poll fds is readable
+    bool event{false};
+
     try {
-      if (m_mixer[mixer::MASTER] && m_mixer[mixer::MASTER]->wait(25)) {
-        return true;
-      }
-      if (m_mixer[mixer::SPEAKER] && m_mixer[mixer::SPEAKER]->wait(25)) {
-        return true;
-      }
-      if (m_mixer[mixer::HEADPHONE] && m_mixer[mixer::HEADPHONE]->wait(25)) {
-        return true;
+      for (auto&& m : m_mixer) {
+        if (m.second && m.second->wait(0)) {
+          event = true;
+        }
       }
-      if (m_ctrl[control::HEADPHONE] && m_ctrl[control::HEADPHONE]->wait(25)) {
-        return true;
+      if (m_ctrl[control::HEADPHONE] && m_ctrl[control::HEADPHONE]->wait(0)) {
+        event = true;
       }
     } catch (const alsa_exception& e) {
       m_log.err("%s: %s", name(), e.what());
     }
 
-    return false;
+    return event;
+  }
+
+  vector<int> alsa_module::get_poll_fds() {
+    vector<int> fds;
+
+    for (auto&& m : m_mixer) {
+      if (m.second) {
+        auto mixer_fds = m.second->get_poll_fds();
+        fds.insert(fds.end(), mixer_fds.begin(), mixer_fds.end());
+      }
+    }
+    if (m_ctrl[control::HEADPHONE]) {
+      auto ctrl_fds = m_ctrl[control::HEADPHONE]->get_poll_fds();
+      fds.insert(fds.end(), ctrl_fds.begin(), ctrl_fds.end());
+    }
+
+    return fds;
   }
 
   bool alsa_module::update() {
@@ -184,11 +199,11 @@ namespace modules {
     return m_muted ? FORMAT_MUTED : FORMAT_VOLUME;
   }
 
-  string alsa_module::get_output() {
+  display_list alsa_module::get_output() {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapper
     // with the cmd handlers
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     if (m_handle_events) {
       m_builder->cmd(mousebtn::LEFT, EVENT_TOGGLE_MUTE);
@@ -60,10 +60,6 @@ namespace modules {
     watch(path_backlight_val);
   }
 
-  void backlight_module::idle() {
-    sleep(75ms);
-  }
-
   bool backlight_module::on_event(inotify_event* event) {
     if (event != nullptr) {
       m_log.trace("%s: %s", name(), event->filename);
@@ -80,11 +76,11 @@ namespace modules {
     return true;
   }
 
-  string backlight_module::get_output() {
+  display_list backlight_module::get_output() {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapped
     // with the cmd handlers
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     if (m_scroll) {
       m_builder->cmd(mousebtn::SCROLL_UP, EVENT_SCROLLUP);
@@ -20,6 +20,27 @@ namespace modules {
     return reader.read();
   }
 
+  /**
+   * Read the contents of a power supply attribute
+   *
+   * Like file_util::contents, an attribute that can't be read (e.g. the
+   * battery was removed) is treated as empty
+   */
+  string read_contents(const shared_ptr<sampled_file>& file) {
+    try {
+      return file->read()->data;
+    } catch (const system_error&) {
+      return "";
+    }
+  }
+
+  /**
+   * Read the numeric value of a power supply attribute
+   */
+  unsigned long read_value(const shared_ptr<sampled_file>& file) {
+    return std::strtoul(read_contents(file).c_str(), nullptr, 10);
+  }
+
   /**
    * Bootstrap module by setting up required components
    */
@@ -28,17 +49,22 @@ namespace modules {
     // Load configuration values
     m_fullat = math_util::min(m_conf.get(name(), "full-at", m_fullat), 100);
     m_interval = m_conf.get<decltype(m_interval)>(name(), "poll-interval", 5s);
-    m_lastpoll = chrono::system_clock::now();
+    m_adapter = m_conf.get(name(), "adapter", "ADP1"s);
+    m_battery = m_conf.get(name(), "battery", "BAT0"s);
+
+    auto path_adapter = string_util::replace(PATH_ADAPTER, "%adapter%", m_adapter) + "/";
+    auto path_battery = string_util::replace(PATH_BATTERY, "%battery%", m_battery) + "/";
 
-    auto path_adapter = string_util::replace(PATH_ADAPTER, "%adapter%", m_conf.get(name(), "adapter", "ADP1"s)) + "/";
-    auto path_battery = string_util::replace(PATH_BATTERY, "%battery%", m_conf.get(name(), "battery", "BAT0"s)) + "/";
+    auto& files = sampler::make();
 
     // Make state reader
     if (file_util::exists((m_fstate = path_adapter + "online"))) {
-      m_state_reader = make_unique<state_reader>([=] { return file_util::contents(m_fstate).compare(0, 1, "1") == 0; });
+      m_state_file = files.open(m_fstate);
+      m_state_reader = make_unique<state_reader>([=] { return read_contents(m_state_file).compare(0, 1, "1") == 0; });
     } else if (file_util::exists((m_fstate = path_battery + "status"))) {
+      m_state_file = files.open(m_fstate);
       m_state_reader =
-          make_unique<state_reader>([=] { return file_util::contents(m_fstate).compare(0, 8, "Charging") == 0; });
+          make_unique<state_reader>([=] { return read_contents(m_state_file).compare(0, 8, "Charging") == 0; });
     } else {
       throw module_error("No suitable way to get current charge state");
     }
@@ -50,9 +76,12 @@ namespace modules {
       throw module_error("No suitable way to get max capacity value");
     }
 
+    m_capnow_file = files.open(m_fcapnow);
+    m_capfull_file = files.open(m_fcapfull);
+
     m_capacity_reader = make_unique<capacity_reader>([=] {
-      auto cap_now = std::strtoul(file_util::contents(m_fcapnow).c_str(), nullptr, 10);
-      auto cap_max = std::strtoul(file_util::contents(m_fcapfull).c_str(), nullptr, 10);
+      auto cap_now = read_value(m_capnow_file);
+      auto cap_max = read_value(m_capfull_file);
       return math_util::percentage(cap_now, 0UL, cap_max);
     });
 
@@ -63,11 +92,14 @@ namespace modules {
       throw module_error("No suitable way to get current charge rate value");
     }
 
+    m_voltage_file = files.open(m_fvoltage);
+    m_rate_file = files.open(m_frate);
+
     m_rate_reader = make_unique<rate_reader>([this] {
-      unsigned long rate{std::strtoul(file_util::contents(m_frate).c_str(), nullptr, 10)};
-      unsigned long volt{std::strtoul(file_util::contents(m_fvoltage).c_str(), nullptr, 10) / 1000UL};
-      unsigned long now{std::strtoul(file_util::contents(m_fcapnow).c_str(), nullptr, 10)};
-      unsigned long max{std::strtoul(file_util::contents(m_fcapfull).c_str(), nullptr, 10)};
+      unsigned long rate{read_value(m_rate_file)};
+      unsigned long volt{read_value(m_voltage_file) / 1000UL};
+      unsigned long now{read_value(m_capnow_file)};
+      unsigned long max{read_value(m_capfull_file)};
       unsigned long cap{read(*m_state_reader) ? max - now : now};
 
       if (rate && volt && cap) {
@@ -88,13 +120,13 @@ namespace modules {
 
       // if the rate we found was the current, calculate power (P = I*V)
       if (string_util::contains(m_frate, "current_now")) {
-        unsigned long current{std::strtoul(file_util::contents(m_frate).c_str(), nullptr, 10)};
-        unsigned long voltage{std::strtoul(file_util::contents(m_fvoltage).c_str(), nullptr, 10)};
+        unsigned long current{read_value(m_rate_file)};
+        unsigned long voltage{read_value(m_voltage_file)};
 
         consumption = ((voltage / 1000.0) * (current /  1000.0)) / 1e6;
       // if it was power, just use as is
       } else {
-        unsigned long power{std::strtoul(file_util::contents(m_frate).c_str(), nullptr, 10)};
+        unsigned long power{read_value(m_rate_file)};
 
         consumption = power / 1e6;
       }
@@ -140,9 +172,14 @@ namespace modules {
       m_label_full = load_optional_label(m_conf, name(), TAG_LABEL_FULL, "%percentage%%");
     }
 
-    // Create inotify watches
-    watch(m_fcapnow, IN_ACCESS);
-    watch(m_fstate, IN_ACCESS);
+    // Get notified by the kernel when the power supplies change, sysfs doesn't reliably report inotify events
+    try {
+      m_uevents = uevent_util::make_socket();
+    } catch (const system_error& err) {
+      m_log.warn("%s: Failed to listen for power supply events, falling back to inotify (%s)", name(), err.what());
+      watch(m_fcapnow, IN_ACCESS);
+      watch(m_fstate, IN_ACCESS);
+    }
 
     // Setup time if token is used
     if ((m_label_charging && m_label_charging->has_token("%time%")) ||
@@ -155,61 +192,95 @@ namespace modules {
   }
 
   /**
-   * Dispatch the subthread used to update the
-   * charging animation when the module is started
+   * Start listening for power supply events, the polling timer
+   * and the charging animation when the module is started
    */
   void battery_module::start() {
     this->inotify_module::start();
-    // We only start animation thread if there is at least one animation.
+
+    if (m_uevents) {
+      add_fd(m_uevents->get_file_descriptor(), [this] { read_uevents(); });
+    }
+
+    /*
+     * The capacity and the rate change gradually, they are polled on the
+     * defined interval. Changes of the charge state are reported right away.
+     */
+    if (m_interval.count() > 0) {
+      add_timer(m_interval, m_interval, [this] { refresh(false); });
+    }
+
+    // We only start the animation timer if there is at least one animation.
     if (m_animation_charging || m_animation_discharging) {
-      m_subthread = thread(&battery_module::subthread, this);
+      add_timer(0s, 0s, [this] { animate(); });
     }
   }
 
   /**
-   * Release wake lock when stopping the module
+   * Update values when tracked files have changed
    */
-  void battery_module::teardown() {
-    if (m_subthread.joinable()) {
-      m_subthread.join();
+  bool battery_module::on_event(inotify_event* event) {
+    if (event != nullptr) {
+      m_log.trace("%s: Inotify event reported for %s", name(), event->filename);
     }
+    return update(event == nullptr);
   }
 
   /**
-   * Idle between polling inotify watches for events.
-   *
-   * If the defined interval has been reached, trigger a manual
-   * poll in case the inotify events aren't fired.
-   *
-   * This fallback is needed because some systems won't
-   * report inotify events for files on sysfs.
+   * Handle the pending kernel events and update right away if one of them
+   * is about the adapter or the battery
    */
-  void battery_module::idle() {
-    if (m_interval.count() > 0) {
-      auto now = chrono::system_clock::now();
-      if (chrono::duration_cast<decltype(m_interval)>(now - m_lastpoll) > m_interval) {
-        m_lastpoll = now;
-        m_log.info("%s: Polling values (inotify fallback)", name());
-        read(*m_capacity_reader);
+  void battery_module::read_uevents() {
+    bool changed{false};
+    uevent event;
+
+    while (m_uevents->receive(event)) {
+      if (event.action.empty()) {
+        // Events were dropped
+        changed = true;
+      } else if (event.property("SUBSYSTEM") == "power_supply") {
+        auto supply = event.property("POWER_SUPPLY_NAME");
+        if (supply.empty()) {
+          supply = event.devpath.substr(event.devpath.rfind('/') + 1);
+        }
+        changed = changed || supply == m_adapter || supply == m_battery;
       }
     }
 
-    this->inotify_module::idle();
+    if (changed) {
+      m_log.trace("%s: Power supply event reported", name());
+      refresh(true);
+    }
   }
 
   /**
-   * Update values when tracked files have changed
+   * Update the values outside of inotify events and redraw if needed
    */
-  bool battery_module::on_event(inotify_event* event) {
-    auto state = current_state();
-    auto percentage = current_percentage();
+  void battery_module::refresh(bool force) {
+    try {
+      std::unique_lock<std::mutex> guard(m_updatelock);
+      bool changed{running() && timed_update([&] { return update(force); })};
+      guard.unlock();
 
-    // Reset timer to avoid unnecessary polling
-    m_lastpoll = chrono::system_clock::now();
+      if (changed) {
+        broadcast();
+      }
+    } catch (const exception& err) {
+      halt(err.what());
+    }
+  }
 
-    if (event != nullptr) {
-      m_log.trace("%s: Inotify event reported for %s", name(), event->filename);
+  /**
+   * Read the current values
+   *
+   * Unless forced, unchanged values are only redrawn every few updates
+   * to refresh %time% and %consumption%
+   */
+  bool battery_module::update(bool force) {
+    auto state = current_state();
+    auto percentage = current_percentage();
 
+    if (!force) {
       if (state == m_state && percentage == m_percentage && m_unchanged--) {
         return false;
       }
@@ -339,33 +410,24 @@ namespace modules {
   }
 
   /**
-   * Subthread runner that emits update events to refresh <animation-charging>
+   * Timer callback that emits update events to refresh <animation-charging>
    * or <animation-discharging> in case they are used. Note, that it is ok to
-   * use a single thread, because the two animations are never shown at the
+   * use a single timer, because the two animations are never shown at the
    * same time.
    */
-  void battery_module::subthread() {
-    m_log.trace("%s: Start of subthread", name());
-
-    while (running()) {
-      auto now = chrono::steady_clock::now();
-      auto framerate = 1000U;  // milliseconds
-      if (m_state == battery_module::state::CHARGING && m_animation_charging) {
-        m_animation_charging->increment();
-        broadcast();
-        framerate = m_animation_charging->framerate();
-      } else if (m_state == battery_module::state::DISCHARGING && m_animation_discharging) {
-        m_animation_discharging->increment();
-        broadcast();
-        framerate = m_animation_discharging->framerate();
-      }
-
-      // We don't count the the first part of the loop to be as close as possible to the framerate.
-      now += chrono::milliseconds(framerate);
-      this_thread::sleep_until(now);
+  void battery_module::animate() {
+    auto framerate = 1000U;  // milliseconds
+    if (m_state == battery_module::state::CHARGING && m_animation_charging) {
+      m_animation_charging->increment();
+      broadcast();
+      framerate = m_animation_charging->framerate();
+    } else if (m_state == battery_module::state::DISCHARGING && m_animation_discharging) {
+      m_animation_discharging->increment();
+      broadcast();
+      framerate = m_animation_discharging->framerate();
     }
 
-    m_log.trace("%s: End of subthread", name());
+    m_reactor.set_timer(reactor::current(), chrono::milliseconds(framerate));
   }
 }  // namespace modules
 
@@ -138,12 +138,11 @@ namespace modules {
     }
   }
 
-  void bspwm_module::stop() {
+  void bspwm_module::teardown() {
     if (m_subscriber) {
       m_log.info("%s: Disconnecting from socket", name());
       m_subscriber->disconnect();
     }
-    event_module::stop();
   }
 
   bool bspwm_module::has_event() {
@@ -154,6 +153,10 @@ namespace modules {
     return m_subscriber->peek(1);
   }
 
+  vector<int> bspwm_module::get_poll_fds() {
+    return {m_subscriber->get_file_descriptor()};
+  }
+
   bool bspwm_module::update() {
     if (!m_subscriber) {
       return false;
@@ -377,8 +380,8 @@ namespace modules {
     return true;
   }
 
-  string bspwm_module::get_output() {
-    string output;
+  display_list bspwm_module::get_output() {
+    display_list output;
     for (m_index = 0U; m_index < m_monitors.size(); m_index++) {
       if (m_index > 0) {
         m_builder->space(m_formatter->get(DEFAULT_FORMAT)->spacing);
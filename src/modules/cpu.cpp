@@ -1,6 +1,3 @@
-#include <fstream>
-#include <istream>
-
 #include "modules/cpu.hpp"
 
 #include "drawtypes/label.hpp"
@@ -20,6 +17,8 @@ namespace modules {
 
     m_ramp_padding = m_conf.get<decltype(m_ramp_padding)>(name(), "ramp-coreload-spacing", 1);
 
+    m_stat = sampler::make().open(PATH_CPU_INFO);
+
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_LOAD, TAG_RAMP_LOAD, TAG_RAMP_LOAD_PER_CORE});
 
     // warmup cpu times
@@ -104,30 +103,11 @@ namespace modules {
 
   bool cpu_module::read_values() {
     m_cputimes_prev.swap(m_cputimes);
-    m_cputimes.clear();
 
     try {
-      std::ifstream in(PATH_CPU_INFO);
-      string str;
-
-      while (std::getline(in, str) && str.compare(0, 3, "cpu") == 0) {
-        // skip line with accumulated value
-        if (str.compare(0, 4, "cpu ") == 0) {
-          continue;
-        }
-
-        auto values = string_util::split(str, ' ');
-
-        m_cputimes.emplace_back(new cpu_time);
-        m_cputimes.back()->user = std::stoull(values[1], nullptr, 10);
-        m_cputimes.back()->nice = std::stoull(values[2], nullptr, 10);
-        m_cputimes.back()->system = std::stoull(values[3], nullptr, 10);
-        m_cputimes.back()->idle = std::stoull(values[4], nullptr, 10);
-        m_cputimes.back()->steal = std::stoull(values[8], nullptr, 10);
-        m_cputimes.back()->total = m_cputimes.back()->user + m_cputimes.back()->nice + m_cputimes.back()->system +
-                                   m_cputimes.back()->idle + m_cputimes.back()->steal;
-      }
-    } catch (const std::ios_base::failure& e) {
+      proc_util::parse_stat(m_stat->read(sample_age())->data, m_cputimes);
+    } catch (const std::exception& e) {
+      m_cputimes.clear();
       m_log.err("Failed to read CPU values (what: %s)", e.what());
     }
 
@@ -144,10 +124,10 @@ namespace modules {
     auto& last = m_cputimes[core];
     auto& prev = m_cputimes_prev[core];
 
-    auto last_idle = last->idle;
-    auto prev_idle = prev->idle;
+    auto last_idle = last.idle;
+    auto prev_idle = prev.idle;
 
-    auto diff = last->total - prev->total;
+    auto diff = last.total - prev.total;
 
     if (diff == 0) {
       return 0;
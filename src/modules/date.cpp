@@ -8,6 +8,26 @@ POLYBAR_NS
 namespace modules {
   template class module<date_module>;
 
+  namespace {
+    /**
+     * Check if the format contains a conversion that changes every second
+     */
+    bool has_seconds(const string& format) {
+      for (size_t i = 0; i < format.size(); i++) {
+        if (format[i] != '%') {
+          continue;
+        }
+        // Skip flags, field width and modifiers
+        while (++i < format.size() && (std::isdigit(format[i]) || strchr("_-0^#EO", format[i]) != nullptr)) {
+        }
+        if (i < format.size() && strchr("STsrXc+", format[i]) != nullptr) {
+          return true;
+        }
+      }
+      return false;
+    }
+  }  // namespace
+
   date_module::date_module(const bar_settings& bar, string name_) : timer_module<date_module>(bar, move(name_)) {
     if (!m_bar.locale.empty()) {
       datetime_stream.imbue(std::locale(m_bar.locale.c_str()));
@@ -24,6 +44,12 @@ namespace modules {
 
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 1s);
 
+    // Without seconds in the output it is enough to update on every full minute
+    if (m_align && m_interval < 60s && !has_seconds(m_dateformat) && !has_seconds(m_dateformat_alt) &&
+        !has_seconds(m_timeformat) && !has_seconds(m_timeformat_alt)) {
+      m_interval = 60s;
+    }
+
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_DATE});
 
     if (m_formatter->has(TAG_DATE)) {
@@ -1,23 +1,20 @@
+#include <fcntl.h>
 #include <sys/statvfs.h>
-#include <fstream>
 
 #include "drawtypes/label.hpp"
 #include "drawtypes/progressbar.hpp"
 #include "drawtypes/ramp.hpp"
 #include "modules/fs.hpp"
 #include "utils/factory.hpp"
+#include "utils/file.hpp"
 #include "utils/math.hpp"
+#include "utils/proc.hpp"
 #include "utils/string.hpp"
 
 #include "modules/meta/base.inl"
 
 POLYBAR_NS
 
-// Columns in /proc/self/mountinfo
-#define MOUNTINFO_DIR 4
-#define MOUNTINFO_TYPE 7
-#define MOUNTINFO_FSNAME 8
-
 namespace modules {
   template class module<fs_module>;
 
@@ -26,11 +23,18 @@ namespace modules {
    * setting up required components
    */
   fs_module::fs_module(const bar_settings& bar, string name_) : timer_module<fs_module>(bar, move(name_)) {
-    m_mountpoints = m_conf.get_list(name(), "mount");
+    for (auto&& mountpoint : m_conf.get_list(name(), "mount")) {
+      if (m_mountindex.find(mountpoint) == m_mountindex.end()) {
+        m_mounts.emplace_back(new fs_mount{mountpoint});
+        m_mountindex.emplace(mountpoint, m_mounts.back().get());
+      }
+    }
+
     m_remove_unmounted = m_conf.get(name(), "remove-unmounted", m_remove_unmounted);
     m_fixed = m_conf.get(name(), "fixed-values", m_fixed);
     m_spacing = m_conf.get(name(), "spacing", m_spacing);
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 30s);
+    m_mountinfo = sampler::make().open("/proc/self/mountinfo");
 
     // Add formats and elements
     m_formatter->add(
@@ -61,41 +65,102 @@ namespace modules {
   }
 
   /**
-   * Update mountpoints
+   * Watch the mount table, it's only parsed again once it changed
    */
-  bool fs_module::update() {
-    m_mounts.clear();
+  void fs_module::start() {
+    try {
+      m_mountwatch = file_util::make_file_descriptor("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+    } catch (const system_error& err) {
+      m_log.warn("%s: Failed to watch mount table, parsing it on every update (%s)", name(), err.what());
+    }
+
+    timer_module::start();
 
-    vector<vector<string>> mountinfo;
-    std::ifstream filestream("/proc/self/mountinfo");
-    string line;
+    if (m_mountwatch && !add_fd(*m_mountwatch, [this] { mounts_changed(); }, EPOLLPRI)) {
+      m_mountwatch.reset();
+    }
+  }
 
-    // Get details for mounted filesystems
-    while (std::getline(filestream, line)) {
-      auto cols = string_util::split(line, ' ');
-      if (std::find(m_mountpoints.begin(), m_mountpoints.end(), cols[MOUNTINFO_DIR]) != m_mountpoints.end()) {
-        mountinfo.emplace_back(move(cols));
+  void fs_module::teardown() {
+    m_mountwatch.reset();
+  }
+
+  /**
+   * Update the mounted filesystems right away if the mount table changed
+   */
+  void fs_module::mounts_changed() {
+    {
+      std::lock_guard<std::mutex> guard(m_updatelock);
+      m_mountschanged = true;
+    }
+    runner();
+  }
+
+  /**
+   * Look up the configured mountpoints in the mount table
+   */
+  void fs_module::update_mounts() {
+    for (auto&& mount : m_mounts) {
+      mount->mounted = false;
+    }
+
+    // The parsed entries point into the sample, take a fresh one after a change
+    auto sample = m_mountinfo->read();
+    proc_util::mountinfo_parser parser(sample->data);
+    proc_util::mount_entry entry;
+    string mountpoint;
+
+    while (parser.next(entry)) {
+      mountpoint.assign(entry.mountpoint.data, entry.mountpoint.size);
+      auto it = m_mountindex.find(mountpoint);
+
+      // The last entry of a mountpoint is the one on top
+      if (it != m_mountindex.end()) {
+        it->second->mounted = true;
+        it->second->type = entry.type.str();
+        it->second->fsname = entry.source.str();
       }
     }
 
-    // Get data for defined mountpoints
-    for (auto&& mountpoint : m_mountpoints) {
-      auto details = std::find_if(mountinfo.begin(), mountinfo.end(),
-          [&](const vector<string>& m) { return m.size() > 4 && m[4] == mountpoint; });
+    for (auto it = m_mounts.begin(); it != m_mounts.end();) {
+      auto& mount = *it;
+
+      if (mount->mounted) {
+        it++;
+        continue;
+      } else if (!m_remove_unmounted) {
+        m_log.warn("%s: Mountpoint %s is not mounted", name(), mount->mountpoint);
+        mount->bytes_free = mount->bytes_used = mount->bytes_avail = mount->bytes_total = 0;
+        mount->percentage_free = mount->percentage_used = 0;
+        it++;
+        continue;
+      }
+
+      m_log.info("%s: Removing mountpoint \"%s\" (reason: `remove-unmounted = true`)", name(), mount->mountpoint);
+      m_mountindex.erase(mount->mountpoint);
+      it = m_mounts.erase(it);
+    }
+  }
+
+  /**
+   * Update mountpoints
+   */
+  bool fs_module::update() {
+    // Without the watch the mount table has to be checked every time
+    if (m_mountschanged || !m_mountwatch) {
+      m_mountschanged = false;
+      update_mounts();
+    }
 
-      m_mounts.emplace_back(new fs_mount{mountpoint, details != mountinfo.end()});
+    // Get data for defined mountpoints
+    for (auto&& mount : m_mounts) {
       struct statvfs buffer {};
 
-      if (!m_mounts.back()->mounted) {
-        m_log.warn("%s: Mountpoint %s is not mounted", name(), mountpoint);
-      } else if (statvfs(mountpoint.c_str(), &buffer) == -1) {
+      if (!mount->mounted) {
+        continue;
+      } else if (statvfs(mount->mountpoint.c_str(), &buffer) == -1) {
         m_log.err("%s: Failed to query filesystem (statvfs() error: %s)", name(), strerror(errno));
       } else {
-        auto& mount = m_mounts.back();
-        mount->mountpoint = details->at(MOUNTINFO_DIR);
-        mount->type = details->at(MOUNTINFO_TYPE);
-        mount->fsname = details->at(MOUNTINFO_FSNAME);
-
         // see: https://en.cppreference.com/w/cpp/filesystem/space
         mount->bytes_total = static_cast<uint64_t>(buffer.f_frsize) * static_cast<uint64_t>(buffer.f_blocks);
         mount->bytes_free = static_cast<uint64_t>(buffer.f_frsize) * static_cast<uint64_t>(buffer.f_bfree);
@@ -107,25 +172,14 @@ namespace modules {
       }
     }
 
-    if (m_remove_unmounted) {
-      for (auto&& mount : m_mounts) {
-        if (!mount->mounted) {
-          m_log.info("%s: Removing mountpoint \"%s\" (reason: `remove-unmounted = true`)", name(), mount->mountpoint);
-          m_mountpoints.erase(
-              std::remove(m_mountpoints.begin(), m_mountpoints.end(), mount->mountpoint), m_mountpoints.end());
-          m_mounts.erase(std::remove(m_mounts.begin(), m_mounts.end(), mount), m_mounts.end());
-        }
-      }
-    }
-
     return true;
   }
 
   /**
    * Generate the module output
    */
-  string fs_module::get_output() {
-    string output;
+  display_list fs_module::get_output() {
+    display_list output;
 
     for (m_index = 0_z; m_index < m_mounts.size(); ++m_index) {
       if (!output.empty()) {
@@ -26,6 +26,9 @@ namespace modules {
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 60s);
     m_empty_notifications = m_conf.get(name(), "empty-notifications", m_empty_notifications);
 
+    // Requests can take up to the timeout of the downloader
+    set_blocking();
+
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL});
 
     if (m_formatter->has(TAG_LABEL)) {
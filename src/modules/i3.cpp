@@ -21,6 +21,7 @@ namespace modules {
     }
 
     m_ipc = factory_util::unique<i3ipc::connection>();
+    m_command = factory_util::unique<i3ipc::connection>();
 
     // Load configuration values
     m_click = m_conf.get(name(), "enable-click", m_click);
@@ -72,8 +73,10 @@ namespace modules {
             m_modelabel->reset_tokens();
             m_modelabel->replace_token("%mode%", mode.change);
           }
+          m_changed = true;
         };
       }
+      m_ipc->on_workspace_event = [this](const i3ipc::workspace_event_t& event) { on_workspace_event(event); };
       m_ipc->subscribe(i3ipc::ET_WORKSPACE | i3ipc::ET_MODE);
     } catch (const exception& err) {
       throw module_error(err.what());
@@ -84,7 +87,7 @@ namespace modules {
     return label && *label;
   }
 
-  void i3_module::stop() {
+  void i3_module::teardown() {
     try {
       if (m_ipc) {
         m_log.info("%s: Disconnecting from socket", name());
@@ -93,89 +96,210 @@ namespace modules {
       }
     } catch (...) {
     }
-
-    event_module::stop();
   }
 
   bool i3_module::has_event() {
     try {
+      m_changed = false;
       m_ipc->handle_event();
-      return true;
+      return m_changed || m_refresh;
     } catch (const exception& err) {
       try {
         m_log.warn("%s: Attempting to reconnect socket (reason: %s)", name(), err.what());
         m_ipc->connect_event_socket(true);
         m_log.info("%s: Reconnecting socket succeeded", name());
+        m_connected = true;
+
+        // Events might have been missed in the meantime
+        m_refresh = true;
       } catch (const exception& err) {
         m_log.err("%s: Failed to reconnect socket (reason: %s)", name(), err.what());
+        m_connected = false;
       }
       return false;
     }
   }
 
-  bool i3_module::update() {
-    /*
-     * update only populates m_workspaces and those are only needed when
-     * <label-state> appears in the format
-     */
-    if (!m_formatter->has(TAG_LABEL_STATE)) {
-      return true;
+  vector<int> i3_module::get_poll_fds() {
+    // Without a working socket has_event() is called periodically to reconnect
+    if (!m_connected) {
+      return {};
     }
-    m_workspaces.clear();
-    i3_util::connection_t ipc;
+    return {m_ipc->get_event_socket_fd()};
+  }
+
+  /**
+   * Run the query or command on the persistent connection
+   *
+   * The connection is opened again once if it broke, e.g. after i3 restarted
+   */
+  template <typename Func>
+  decltype(auto) i3_module::with_command(Func&& func) {
+    std::lock_guard<std::mutex> guard(m_commandlock);
 
     try {
-      vector<shared_ptr<i3_util::workspace_t>> workspaces;
+      return func(static_cast<const i3_util::connection_t&>(*m_command));
+    } catch (const exception& err) {
+      m_log.warn("%s: Reconnecting ipc connection (reason: %s)", name(), err.what());
+      m_command = factory_util::unique<i3ipc::connection>();
+      return func(static_cast<const i3_util::connection_t&>(*m_command));
+    }
+  }
 
-      if (m_pinworkspaces) {
-        workspaces = i3_util::workspaces(ipc, m_bar.monitor->name);
-      } else {
-        workspaces = i3_util::workspaces(ipc);
-      }
+  /**
+   * Apply the workspace event to the cached workspaces
+   *
+   * Events that can't be applied from their payload alone (e.g. a new or
+   * renamed workspace) cause the workspaces to be queried again
+   */
+  void i3_module::on_workspace_event(const i3ipc::workspace_event_t& event) {
+    m_changed = true;
 
-      if (m_indexsort) {
-        sort(workspaces.begin(), workspaces.end(), i3_util::ws_numsort);
-      }
+    workspace* current{event.current ? find_workspace(event.current->name) : nullptr};
 
-      for (auto&& ws : workspaces) {
-        state ws_state{state::NONE};
+    if (current == nullptr) {
+      m_refresh = true;
+      return;
+    }
 
-        if (ws->focused) {
-          ws_state = state::FOCUSED;
-        } else if (ws->urgent) {
-          ws_state = state::URGENT;
-        } else if (ws->visible) {
-          ws_state = state::VISIBLE;
-        } else {
-          ws_state = state::UNFOCUSED;
+    switch (event.type) {
+      case i3ipc::WorkspaceEventType::FOCUS:
+        // The focused workspace replaces the visible one of its output
+        for (auto&& ws : m_workspaces) {
+          ws->focused = false;
+          if (ws->output == current->output) {
+            ws->visible = false;
+          }
+        }
+        current->focused = true;
+        current->visible = true;
+        break;
+
+      case i3ipc::WorkspaceEventType::URGENT:
+        current->urgent = event.current->urgent;
+        break;
+
+      case i3ipc::WorkspaceEventType::EMPTY:
+        if (!current->visible) {
+          m_workspaces.erase(std::find_if(m_workspaces.begin(), m_workspaces.end(),
+              [&](const unique_ptr<workspace>& ws) { return ws.get() == current; }));
+          break;
         }
+        // The emptied workspace is still shown, e.g. it was focused again
+        m_refresh = true;
+        break;
+
+      default:
+        m_refresh = true;
+        break;
+    }
+  }
+
+  /**
+   * Query all workspaces and keep the cached ones that didn't change
+   */
+  void i3_module::refresh_workspaces() {
+    auto workspaces = with_command([](const i3_util::connection_t& conn) { return i3_util::workspaces(conn); });
+
+    if (m_indexsort) {
+      sort(workspaces.begin(), workspaces.end(), i3_util::ws_numsort);
+    }
+
+    vector<unique_ptr<workspace>> cached;
+    std::swap(cached, m_workspaces);
+
+    for (auto&& ws : workspaces) {
+      auto it = std::find_if(cached.begin(), cached.end(), [&](const unique_ptr<workspace>& w) {
+        return w && w->name == ws->name && w->output == ws->output && w->num == ws->num;
+      });
+
+      if (it != cached.end()) {
+        m_workspaces.emplace_back(move(*it));
+      } else {
+        m_workspaces.emplace_back(factory_util::unique<workspace>(ws->name, ws->output, ws->num));
+        auto& entry = m_workspaces.back();
 
-        string ws_name{ws->name};
+        entry->display_name = ws->name;
 
         // Remove workspace numbers "0:"
         if (m_strip_wsnumbers) {
-          ws_name.erase(0, string_util::find_nth(ws_name, 0, ":", 1) + 1);
+          entry->display_name.erase(0, string_util::find_nth(entry->display_name, 0, ":", 1) + 1);
         }
 
         // Trim leading and trailing whitespace
-        ws_name = string_util::trim(move(ws_name), ' ');
+        entry->display_name = string_util::trim(move(entry->display_name), ' ');
+        entry->icon = m_icons->get(ws->name, DEFAULT_WS_ICON, m_fuzzy_match);
+      }
 
-        auto icon = m_icons->get(ws->name, DEFAULT_WS_ICON, m_fuzzy_match);
-        auto label = m_statelabels.find(ws_state)->second->clone();
+      m_workspaces.back()->focused = ws->focused;
+      m_workspaces.back()->urgent = ws->urgent;
+      m_workspaces.back()->visible = ws->visible;
+    }
 
-        label->reset_tokens();
-        label->replace_token("%output%", ws->output);
-        label->replace_token("%name%", ws_name);
-        label->replace_token("%icon%", icon->get());
-        label->replace_token("%index%", to_string(ws->num));
-        m_workspaces.emplace_back(factory_util::unique<workspace>(ws->name, ws_state, move(label)));
-      }
+    m_refresh = false;
+  }
 
+  bool i3_module::update() {
+    /*
+     * update only populates m_workspaces and those are only needed when
+     * <label-state> appears in the format
+     */
+    if (!m_formatter->has(TAG_LABEL_STATE)) {
       return true;
+    }
+
+    try {
+      if (m_refresh) {
+        refresh_workspaces();
+      }
     } catch (const exception& err) {
       m_log.err("%s: %s", name(), err.what());
       return false;
     }
+
+    for (auto&& ws : m_workspaces) {
+      update_label(*ws);
+    }
+
+    return true;
+  }
+
+  /**
+   * Create the label of the workspace if its state changed
+   */
+  void i3_module::update_label(workspace& ws) {
+    state ws_state{state::NONE};
+
+    if (ws.focused) {
+      ws_state = state::FOCUSED;
+    } else if (ws.urgent) {
+      ws_state = state::URGENT;
+    } else if (ws.visible) {
+      ws_state = state::VISIBLE;
+    } else {
+      ws_state = state::UNFOCUSED;
+    }
+
+    if (ws.label && ws.state == ws_state) {
+      return;
+    }
+
+    ws.state = ws_state;
+    ws.label = m_statelabels.find(ws_state)->second->clone();
+    ws.label->reset_tokens();
+    ws.label->replace_token("%output%", ws.output);
+    ws.label->replace_token("%name%", ws.display_name);
+    ws.label->replace_token("%icon%", ws.icon->get());
+    ws.label->replace_token("%index%", to_string(ws.num));
+  }
+
+  i3_module::workspace* i3_module::find_workspace(const string& name) const {
+    for (auto&& ws : m_workspaces) {
+      if (ws->name == name) {
+        return ws.get();
+      }
+    }
+    return nullptr;
   }
 
   bool i3_module::build(builder* builder, const string& tag) const {
@@ -189,6 +313,10 @@ namespace modules {
 
       bool first = true;
       for (auto&& ws : m_workspaces) {
+        if (m_pinworkspaces && ws->output != m_bar.monitor->name) {
+          continue;
+        }
+
         /*
          * The separator should only be inserted in between the workspaces, so
          * we insert it in front of all workspaces except the first one.
@@ -226,12 +354,10 @@ namespace modules {
     }
 
     try {
-      const i3_util::connection_t conn{};
-
       if (cmd.compare(0, strlen(EVENT_CLICK), EVENT_CLICK) == 0) {
         cmd.erase(0, strlen(EVENT_CLICK));
         m_log.info("%s: Sending workspace focus command to ipc handler", name());
-        conn.send_command(make_workspace_command(cmd));
+        with_command([&](const i3_util::connection_t& conn) { return conn.send_command(make_workspace_command(cmd)); });
         return true;
       }
 
@@ -245,7 +371,8 @@ namespace modules {
         return false;
       }
 
-      auto workspaces = i3_util::workspaces(conn, m_bar.monitor->name);
+      auto workspaces = with_command(
+          [&](const i3_util::connection_t& conn) { return i3_util::workspaces(conn, m_bar.monitor->name); });
       auto current_ws = find_if(workspaces.begin(), workspaces.end(),
                                 [](auto ws) { return ws->visible; });
 
@@ -255,19 +382,21 @@ namespace modules {
       }
 
       if (scrolldir == "next" && (m_wrap || next(current_ws) != workspaces.end())) {
+        string command{"workspace next_on_output"};
         if (!(*current_ws)->focused) {
           m_log.info("%s: Sending workspace focus command to ipc handler", name());
-          conn.send_command(make_workspace_command((*current_ws)->name));
+          command = make_workspace_command((*current_ws)->name) + ";" + command;
         }
         m_log.info("%s: Sending workspace next_on_output command to ipc handler", name());
-        conn.send_command("workspace next_on_output");
+        with_command([&](const i3_util::connection_t& conn) { return conn.send_command(command); });
       } else if (scrolldir == "prev" && (m_wrap || current_ws != workspaces.begin())) {
+        string command{"workspace prev_on_output"};
         if (!(*current_ws)->focused) {
           m_log.info("%s: Sending workspace focus command to ipc handler", name());
-          conn.send_command(make_workspace_command((*current_ws)->name));
+          command = make_workspace_command((*current_ws)->name) + ";" + command;
         }
         m_log.info("%s: Sending workspace prev_on_output command to ipc handler", name());
-        conn.send_command("workspace prev_on_output");
+        with_command([&](const i3_util::connection_t& conn) { return conn.send_command(command); });
       }
 
     } catch (const exception& err) {
@@ -59,22 +59,23 @@ namespace modules {
    * Start module and run first defined hook if configured to
    */
   void ipc_module::start() {
-    if (m_initial) {
-      auto command = command_util::make_command<output_policy::REDIRECTED>(m_hooks.at(m_initial - 1)->command);
-      command->exec(false);
-      command->tail([this](string line) { m_output = line; });
-    }
+    m_pending = m_initial;
+    m_runner = add_timer(0s, 0s, [this] { run_hook(); });
     static_module::start();
   }
 
+  void ipc_module::teardown() {
+    m_command.reset();
+  }
+
   /**
    * Wrap the output with defined mouse actions
    */
-  string ipc_module::get_output() {
+  display_list ipc_module::get_output() {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapper
     // with the cmd handlers
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     for (auto&& action : m_actions) {
       if (!action.second.empty()) {
@@ -101,30 +102,151 @@ namespace modules {
   /**
    * Map received message hook to the ones
    * configured from the user config and
-   * execute its command
+   * schedule its command
    */
   void ipc_module::on_message(const string& message) {
-    for (auto&& hook : m_hooks) {
-      if (hook->payload != message) {
-        continue;
+    for (size_t i = 0; i < m_hooks.size(); i++) {
+      if (m_hooks[i]->payload == message) {
+        m_log.info("%s: Found matching hook (%s)", name(), message);
+        m_pending = i + 1;
+        m_reactor.trigger(m_runner);
+        return;
       }
+    }
+  }
 
-      m_log.info("%s: Found matching hook (%s)", name(), hook->payload);
+  /**
+   * Run the last requested hook
+   */
+  void ipc_module::run_hook() {
+    size_t index{m_pending.exchange(0)};
 
-      try {
-        // Clear the output in case the command produces no output
-        m_output.clear();
-        auto command = command_util::make_command<output_policy::REDIRECTED>(hook->command);
-        command->exec(false);
-        command->tail([this](string line) { m_output = line; });
-      } catch (const exception& err) {
-        m_log.err("%s: Failed to execute hook command (err: %s)", err.what());
-        m_output.clear();
+    if (index == 0) {
+      return;
+    }
+
+    cancel_hook();
+
+    std::lock_guard<std::mutex> guard(m_updatelock);
+
+    if (!running()) {
+      return;
+    }
+
+    try {
+      m_lastline.clear();
+      m_command = command_util::make_command<output_policy::REDIRECTED>(m_hooks.at(index - 1)->command);
+      m_command->exec(false);
+      m_lines = factory_util::unique<io_util::line_reader>(m_command->get_stdout(PIPE_READ));
+
+      // Without pidfds, only the threads of the module wait for the hook to exit
+      if (m_command->get_pidfd() == -1) {
+        set_blocking();
       }
 
+      m_reader = add_fd(m_command->get_stdout(PIPE_READ), [this] { read_output(); });
+    } catch (const exception& err) {
+      m_log.err("%s: Failed to execute hook command (err: %s)", name(), err.what());
+      m_command.reset();
+      {
+        std::lock_guard<std::mutex> build_guard(m_buildlock);
+        m_output.clear();
+      }
       broadcast();
     }
   }
+
+  /**
+   * Terminate the hook that is still running, its output is discarded
+   */
+  void ipc_module::cancel_hook() {
+    unique_ptr<command<output_policy::REDIRECTED>> command;
+    reactor::handle_t reader{0};
+    reactor::handle_t exit{0};
+
+    {
+      std::lock_guard<std::mutex> guard(m_updatelock);
+      command = move(m_command);
+      std::swap(reader, m_reader);
+      std::swap(exit, m_exit);
+    }
+
+    // Wait for the sources outside of the lock, they take the lock themselves
+    if (reader) {
+      remove_source(reader);
+    }
+    if (exit) {
+      remove_source(exit);
+    }
+    if (command && command->is_running()) {
+      m_log.info("%s: Cancelling previous hook", name());
+      command->terminate();
+    }
+  }
+
+  /**
+   * Read the available output of the hook, the last line
+   * is used as the module content once the hook closes its output
+   */
+  void ipc_module::read_output() {
+    std::unique_lock<std::mutex> guard(m_updatelock);
+
+    if (!m_command || reactor::current() != m_reader) {
+      return;
+    }
+
+    bool open{m_lines->read()};
+    m_lines->latest(m_lastline);
+
+    if (open) {
+      return;
+    }
+
+    // The hook closed its output
+    remove_source(m_reader);
+    m_reader = 0;
+    m_lines.reset();
+
+    {
+      std::lock_guard<std::mutex> build_guard(m_buildlock);
+      m_output = move(m_lastline);
+    }
+
+    // The hook may keep running, it is reaped by read_exit() so that neither
+    // the worker nor the lock are held until it exits and a newer message can
+    // still cancel it
+    unique_ptr<command<output_policy::REDIRECTED>> command;
+    int pidfd = m_command->get_pidfd();
+    if (pidfd != -1) {
+      m_exit = add_fd(pidfd, [this] { read_exit(); });
+    } else {
+      command = move(m_command);
+    }
+
+    guard.unlock();
+    broadcast();
+
+    // Without pidfds, this runs on a thread of the module (see run_hook())
+    if (command) {
+      command->wait();
+    }
+  }
+
+  /**
+   * Reap the hook once it has exited
+   */
+  void ipc_module::read_exit() {
+    std::lock_guard<std::mutex> guard(m_updatelock);
+
+    if (!m_command || reactor::current() != m_exit) {
+      return;
+    }
+
+    remove_source(m_exit);
+    m_exit = 0;
+    m_command->wait();
+    m_command.reset();
+  }
 }  // namespace modules
 
 POLYBAR_NS_END
@@ -9,10 +9,10 @@ POLYBAR_NS
 namespace modules {
   // module_format {{{
 
-  string module_format::decorate(builder* builder, string output) {
+  display_list module_format::decorate(builder* builder, const display_list& output) {
     if (output.empty()) {
       builder->flush();
-      return "";
+      return {};
     }
     if (offset != 0) {
       builder->offset(offset);
@@ -54,7 +54,7 @@ namespace modules {
       builder->overline(ol);
     }
 
-    builder->append(move(output));
+    builder->append(output);
     builder->node(suffix);
 
     if (padding > 0) {
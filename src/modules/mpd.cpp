@@ -19,6 +19,9 @@ namespace modules {
     m_pass = m_conf.get(name(), "password", m_pass);
     m_synctime = m_conf.get(name(), "interval", m_synctime);
 
+    // Connecting to the server blocks until it answers
+    set_blocking();
+
     // Add formats and elements {{{
     auto format_online = m_conf.get<string>(name(), FORMAT_ONLINE, TAG_LABEL_SONG);
     for (auto&& format : {FORMAT_PLAYING, FORMAT_PAUSED, FORMAT_STOPPED}) {
@@ -141,13 +144,34 @@ namespace modules {
     return m_mpd && m_mpd->connected();
   }
 
-  void mpd_module::idle() {
+  /**
+   * Put the connection in idle mode, the server answers once something changes
+   */
+  vector<int> mpd_module::get_poll_fds() {
     if (connected()) {
-      m_quick_attempts = 0;
-      sleep(80ms);
-    } else {
-      sleep(m_quick_attempts++ < 5 ? 0.5s : 2s);
+      try {
+        m_mpd->idle();
+        return {m_mpd->get_fd()};
+      } catch (const mpd_exception& err) {
+        m_log.err("%s: %s", name(), err.what());
+        m_mpd.reset();
+      }
+    }
+    return {};
+  }
+
+  chrono::duration<double> mpd_module::get_poll_timeout() {
+    if (!connected()) {
+      return m_quick_attempts++ < 5 ? 0.5s : 2s;
+    }
+
+    m_quick_attempts = 0;
+
+    // Refresh the elapsed time while playing
+    if ((m_label_time || m_bar_progress) && m_status && m_status->match_state(mpdstate::PLAYING)) {
+      return chrono::duration<double>{m_synctime};
     }
+    return chrono::duration<double>::zero();
   }
 
   bool mpd_module::has_event() {
@@ -302,10 +326,10 @@ namespace modules {
     }
   }
 
-  string mpd_module::get_output() {
+  display_list mpd_module::get_output() {
     if (m_status && m_status->get_queuelen() == 0) {
       m_log.info("%s: Hiding module since queue is empty", name());
-      return "";
+      return {};
     } else {
       return event_module::get_output();
     }
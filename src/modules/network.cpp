@@ -20,6 +20,9 @@ namespace modules {
     m_udspeed_minwidth = m_conf.get(name(), "udspeed-minwidth", m_udspeed_minwidth);
     m_accumulate = m_conf.get(name(), "accumulate-stats", m_accumulate);
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 1s);
+    m_ping_host = m_conf.get(name(), "ping-host", string{CONNECTION_TEST_IP});
+    auto ping_port = m_conf.get<unsigned short>(name(), "ping-port", 0);
+    m_ping_timeout = m_conf.get<decltype(m_interval)>(name(), "ping-timeout", 2s);
     m_unknown_up = m_conf.get<bool>(name(), "unknown-as-up", false);
 
     m_conf.warn_deprecated(name(), "udspeed-minwidth", "%downspeed:min:max% and %upspeed:min:max%");
@@ -58,6 +61,14 @@ namespace modules {
       if (m_formatter->has(TAG_ANIMATION_PACKETLOSS, FORMAT_PACKETLOSS)) {
         m_animation_packetloss = load_animation(m_conf, name(), TAG_ANIMATION_PACKETLOSS);
       }
+
+      // The result is reused until the next check is due
+      try {
+        m_probe = factory_util::unique<net::probe>(
+            m_ping_host, ping_port, m_interface, m_ping_timeout, m_interval * m_ping_nth_update);
+      } catch (const net::probe_error& err) {
+        throw module_error("Invalid ping-host: " + string{err.what()});
+      }
     }
 
     // Get an intstance of the network interface
@@ -68,21 +79,55 @@ namespace modules {
       m_wired = factory_util::unique<net::wired_network>(m_interface);
       m_wired->set_unknown_up(m_unknown_up);
     };
+  }
+
+  void network_module::start() {
+    this->timer_module::start();
+
+    // Update right away when the interface goes up or down or its addresses change
+    add_fd(get_network()->get_file_descriptor(),
+        [this] { process_events([this] { return get_network()->process_events(); }); });
+
+#if WITH_LIBNL
+    // ... and when the wireless interface connects to or roams between access points
+    if (m_wireless && m_wireless->get_nl80211_descriptor() != -1) {
+      add_fd(m_wireless->get_nl80211_descriptor(),
+          [this] { process_events([this] { return m_wireless->process_nl80211_events(); }); });
+    }
+#endif
 
-    // We only need to start the subthread if the packetloss animation is used
+    // We only need the animation timer if the packetloss animation is used
     if (m_animation_packetloss) {
-      m_threads.emplace_back(thread(&network_module::subthread_routine, this));
+      const chrono::milliseconds framerate{m_animation_packetloss->framerate()};
+      add_timer(0s, framerate, [this] { animate_packetloss(); });
     }
   }
 
   void network_module::teardown() {
+    m_probe.reset();
     m_wireless.reset();
     m_wired.reset();
   }
 
+  /**
+   * Handle the change notifications of the interface
+   */
+  void network_module::process_events(const function<bool()>& handler) {
+    std::unique_lock<std::mutex> guard(m_updatelock);
+    bool changed{handler()};
+    guard.unlock();
+
+    if (changed) {
+      runner();
+    }
+  }
+
+  net::network* network_module::get_network() const {
+    return m_wireless ? static_cast<net::network*>(m_wireless.get()) : static_cast<net::network*>(m_wired.get());
+  }
+
   bool network_module::update() {
-    net::network* network =
-        m_wireless ? static_cast<net::network*>(m_wireless.get()) : static_cast<net::network*>(m_wired.get());
+    net::network* network{get_network()};
 
     if (!network->query(m_accumulate)) {
       m_log.warn("%s: Failed to query interface '%s'", name(), m_interface);
@@ -99,14 +144,15 @@ namespace modules {
       m_log.warn("%s: Error getting interface data (%s)", name(), err.what());
     }
 
-    m_connected = network->connected();
+    bool connected{network->connected()};
+    if (m_probe && connected && !m_connected) {
+      // Check again right away after the interface (re)connected
+      m_probe->invalidate();
+    }
+    m_connected = connected;
 
-    // Ignore the first run
-    if (m_counter == -1) {
-      m_counter = 0;
-    } else if (m_ping_nth_update > 0 && m_connected && (++m_counter % m_ping_nth_update) == 0) {
-      m_packetloss = !network->ping();
-      m_counter = 0;
+    if (m_ping_nth_update > 0 && m_connected) {
+      check_connectivity(network);
     }
 
     auto upspeed = network->upspeed(m_udspeed_minwidth);
@@ -130,6 +176,22 @@ namespace modules {
       }
     };
 
+    // Only redraw if one of the displayed values changed
+    vector<string> values{m_connected ? "1" : "0", m_packetloss ? "1" : "0", network->ip(), network->ip6(), upspeed,
+        downspeed};
+    if (m_wired) {
+      values.emplace_back(m_wired->linkspeed());
+    } else if (m_wireless) {
+      values.emplace_back(m_wireless->essid());
+      values.emplace_back(to_string(m_signal));
+      values.emplace_back(to_string(m_quality));
+    }
+
+    if (values == m_values) {
+      return false;
+    }
+    m_values = move(values);
+
     if (m_label[connection_state::CONNECTED]) {
       replace_tokens(m_label[connection_state::CONNECTED]);
     }
@@ -143,6 +205,75 @@ namespace modules {
     return true;
   }
 
+  /**
+   * Start a connectivity check if the last result expired
+   *
+   * Must be called with m_updatelock locked
+   */
+  void network_module::check_connectivity(net::network* network) {
+    if (m_probe) {
+      try {
+        if (m_probe->start()) {
+          m_probesource = add_fd(m_probe->get_file_descriptor(), [this] { finish_probe(); }, m_probe->get_events());
+          m_probetimer = add_timer(m_probe->timeout(), 0s, [this] { finish_probe(); });
+        } else if (!m_probe->running()) {
+          m_packetloss = !m_probe->online();
+        }
+        return;
+      } catch (const net::probe_error& err) {
+        m_log.warn("%s: %s, falling back to the ping command", name(), err.what());
+        m_probe.reset();
+
+        // The command blocks for up to a few seconds
+        set_blocking();
+      }
+    }
+
+    // Ignore the first run
+    if (m_counter == -1) {
+      m_counter = 0;
+    } else if ((++m_counter % m_ping_nth_update) == 0) {
+      m_packetloss = !network->ping(m_ping_host, m_ping_timeout);
+      m_counter = 0;
+    }
+  }
+
+  /**
+   * Collect the result of the connectivity check once it completed or timed out
+   */
+  void network_module::finish_probe() {
+    reactor::handle_t source{0};
+    reactor::handle_t timer{0};
+
+    {
+      std::lock_guard<std::mutex> guard(m_updatelock);
+      if (!m_probe || !m_probe->process()) {
+        return;
+      }
+      std::swap(source, m_probesource);
+      std::swap(timer, m_probetimer);
+    }
+
+    if (!source && !timer) {
+      return;
+    }
+
+    // Not with m_updatelock held, the other source might wait for it
+    remove_source(source);
+    remove_source(timer);
+
+    bool packetloss{false};
+    {
+      std::lock_guard<std::mutex> guard(m_updatelock);
+      m_probe->close();
+      packetloss = !m_probe->online();
+    }
+
+    if (m_packetloss.exchange(packetloss) != packetloss) {
+      broadcast();
+    }
+  }
+
   string network_module::get_format() const {
     if (!m_connected) {
       return FORMAT_DISCONNECTED;
@@ -172,21 +303,11 @@ namespace modules {
     return true;
   }
 
-  void network_module::subthread_routine() {
-    const chrono::milliseconds framerate{m_animation_packetloss->framerate()};
-
-    while (running()) {
-      auto now = chrono::steady_clock::now();
-      if (m_connected && m_packetloss) {
-        m_animation_packetloss->increment();
-        broadcast();
-      }
-
-      now += framerate;
-      this_thread::sleep_until(now);
+  void network_module::animate_packetloss() {
+    if (m_connected && m_packetloss) {
+      m_animation_packetloss->increment();
+      broadcast();
     }
-
-    m_log.trace("%s: Reached end of network subthread", name());
   }
 }
 
@@ -60,6 +60,10 @@ namespace modules {
     return false;
   }
 
+  vector<int> pulseaudio_module::get_poll_fds() {
+    return {m_pulseaudio->get_event_fd()};
+  }
+
   bool pulseaudio_module::update() {
     // Consume pending events
     m_pulseaudio->process_events();
@@ -99,11 +103,11 @@ namespace modules {
     return m_muted ? FORMAT_MUTED : FORMAT_VOLUME;
   }
 
-  string pulseaudio_module::get_output() {
+  display_list pulseaudio_module::get_output() {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapper
     // with the cmd handlers
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     if (m_handle_events) {
       auto click_middle = m_conf.get(name(), "click-middle", ""s);
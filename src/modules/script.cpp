@@ -26,6 +26,7 @@ namespace modules {
 
               try {
                 m_command->exec(false);
+                m_lines = factory_util::unique<io_util::line_reader>(m_command->get_stdout(PIPE_READ));
               } catch (const exception& err) {
                 m_log.err("%s: %s", name(), err.what());
                 throw module_error("Failed to execute command, stopping module...");
@@ -33,22 +34,12 @@ namespace modules {
             }
 
             int fd = m_command->get_stdout(PIPE_READ);
-            while (!m_stopping && fd != -1 && m_command->is_running() && !io_util::poll(fd, POLLHUP, 0)) {
-              if (!io_util::poll_read(fd, 25)) {
-                continue;
-              } else if ((m_output = m_command->readline()) != m_prev) {
-                m_prev = m_output;
-                broadcast();
-              }
-            }
-
-            if (m_stopping) {
-              return chrono::duration<double>{0};
-            } else if (m_command && !m_command->is_running()) {
-              return std::max(m_command->get_exit_status() == 0 ? m_interval : 1s, m_interval);
-            } else {
+            if (fd == -1 || !add_fd(fd, [this] { read_tail(); })) {
               return m_interval;
             }
+
+            // The command is restarted by read_tail() once it exits
+            return chrono::duration<double>{0};
           };
         }
 
@@ -60,23 +51,22 @@ namespace modules {
             auto exec = string_util::replace_all(m_exec, "%counter%", to_string(++m_counter));
             m_log.info("%s: Invoking shell command: \"%s\"", name(), exec);
             m_command = command_util::make_command<output_policy::REDIRECTED>(exec);
-            m_command->exec(true);
+            m_command->exec(false);
           } catch (const exception& err) {
             m_log.err("%s: %s", name(), err.what());
             throw module_error("Failed to execute command, stopping module...");
           }
 
-          int fd = m_command->get_stdout(PIPE_READ);
-          if (fd != -1 && io_util::poll_read(fd) && (m_output = m_command->readline()) != m_prev) {
-            broadcast();
-            m_prev = m_output;
-          } else if (m_command->get_exit_status() != 0) {
-            m_output.clear();
-            m_prev.clear();
-            broadcast();
+          // Don't block a reactor worker while the command runs, read_exit() continues once it exited
+          int pidfd = m_command->get_pidfd();
+          if (pidfd != -1 && add_fd(pidfd, [this] { read_exit(); })) {
+            return chrono::duration<double>{0};
           }
 
-          return std::max(m_command->get_exit_status() == 0 ? m_interval : 1s, m_interval);
+          // Without pidfds, only the threads of the module wait for the command
+          set_blocking();
+          m_command->wait();
+          return read_output();
         };
 
         // }}}
@@ -86,6 +76,12 @@ namespace modules {
     m_exec_if = m_conf.get(name(), "exec-if", m_exec_if);
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 5s);
 
+    // Limit how often a chatty tail command redraws the bar, 0 means no limit
+    auto rate = m_conf.get(name(), "max-update-rate", 0U);
+    if (rate > 0) {
+      m_updateinterval = chrono::duration<double>{1.0 / rate};
+    }
+
     // Load configured click handlers
     m_actions[mousebtn::LEFT] = m_conf.get(name(), "click-left", ""s);
     m_actions[mousebtn::MIDDLE] = m_conf.get(name(), "click-middle", ""s);
@@ -104,24 +100,13 @@ namespace modules {
   }
 
   /**
-   * Start the module worker
+   * Schedule the first run of the command
    */
   void script_module::start() {
-    m_mainthread = thread([&] {
-      try {
-        while (running() && !m_stopping) {
-          if (check_condition()) {
-            sleep(process(m_handler));
-          } else if (m_interval > 1s) {
-            sleep(m_interval);
-          } else {
-            sleep(1s);
-          }
-        }
-      } catch (const exception& err) {
-        halt(err.what());
-      }
-    });
+    if (m_tail && m_updateinterval.count() > 0) {
+      m_publisher = add_timer(m_updateinterval, 0s, [this] { publish(); });
+    }
+    add_timer(0s, 0s, [this] { run(); });
   }
 
   /**
@@ -129,28 +114,200 @@ namespace modules {
    */
   void script_module::stop() {
     m_stopping = true;
-    wakeup();
+    module::stop();
+  }
 
+  void script_module::teardown() {
     std::lock_guard<decltype(m_handler)> guard(m_handler);
-
     m_command.reset();
-    module::stop();
+    m_condition.reset();
+    m_lines.reset();
   }
 
   /**
-   * Check if defined condition is met
+   * Check the exec-if condition and run the command
+   *
+   * Like the command, the condition is watched through its pidfd so that it
+   * doesn't block a reactor worker, read_condition() continues once it exited
    */
-  bool script_module::check_condition() {
+  void script_module::run() {
+    m_timer = reactor::current();
+
     if (m_exec_if.empty()) {
-      return true;
-    } else if (command_util::make_command<output_policy::IGNORED>(m_exec_if)->exec(true) == 0) {
-      return true;
-    } else if (!m_output.empty()) {
+      execute(true);
+      return;
+    }
+
+    try {
+      std::unique_lock<decltype(m_handler)> guard(m_handler);
+      m_condition = command_util::make_command<output_policy::IGNORED>(m_exec_if);
+      m_condition->exec(false);
+
+      int pidfd = m_condition->get_pidfd();
+      if (pidfd != -1 && add_fd(pidfd, [this] { read_condition(); })) {
+        return;
+      }
+
+      // Without pidfds, only the threads of the module wait for the condition
+      set_blocking();
+      bool condition{m_condition->wait() == 0};
+      guard.unlock();
+
+      execute(condition);
+    } catch (const exception& err) {
+      halt(err.what());
+    }
+  }
+
+  /**
+   * Run the command once the exec-if condition exited
+   */
+  void script_module::read_condition() {
+    remove_source(reactor::current());
+
+    try {
+      std::unique_lock<decltype(m_handler)> guard(m_handler);
+      if (!m_condition) {
+        return;
+      }
+      bool condition{m_condition->wait() == 0};
+      guard.unlock();
+
+      execute(condition);
+    } catch (const exception& err) {
+      halt(err.what());
+    }
+  }
+
+  /**
+   * Run the command if the condition is met and schedule the next run
+   */
+  void script_module::execute(bool condition) {
+    try {
+      chrono::duration<double> next{std::max<chrono::duration<double>>(m_interval, 1s)};
+      if (condition) {
+        next = process(m_handler);
+      } else if (!m_output.empty()) {
+        m_output.clear();
+        m_prev.clear();
+        broadcast();
+      }
+      if (next.count() > 0 && !m_stopping) {
+        m_reactor.set_timer(m_timer, next);
+      }
+    } catch (const exception& err) {
+      halt(err.what());
+    }
+  }
+
+  /**
+   * Read the output of the tail command and restart it once it exits
+   *
+   * Only the latest line is kept, everything the command printed in between is dropped
+   */
+  void script_module::read_tail() {
+    chrono::duration<double> next{m_interval};
+
+    {
+      std::lock_guard<decltype(m_handler)> guard(m_handler);
+
+      if (!m_stopping && m_lines) {
+        bool open{m_lines->read()};
+        if (m_lines->latest(m_latest)) {
+          publish_latest();
+        }
+        if (open) {
+          return;
+        }
+      }
+
+      if (m_command && !m_command->is_running()) {
+        next = std::max(m_command->get_exit_status() == 0 ? m_interval : 1s, m_interval);
+      }
+    }
+
+    remove_source(reactor::current());
+
+    if (!m_stopping) {
+      m_reactor.set_timer(m_timer, next);
+    }
+  }
+
+  /**
+   * Publish the line that was held back by the update rate limit
+   */
+  void script_module::publish() {
+    std::lock_guard<decltype(m_handler)> guard(m_handler);
+    m_deferred = false;
+    publish_latest();
+  }
+
+  /**
+   * Publish the latest line of the tail command or, if the previous
+   * update was too recent, schedule it for later
+   *
+   * Must be called with m_handler locked
+   */
+  void script_module::publish_latest() {
+    if (m_latest == m_prev || m_deferred) {
+      return;
+    }
+
+    auto now = chrono::steady_clock::now();
+    if (m_publisher && now < m_nextupdate) {
+      m_deferred = true;
+      m_reactor.set_timer(m_publisher, m_nextupdate - now);
+      return;
+    }
+
+    m_nextupdate = now + chrono::duration_cast<chrono::steady_clock::duration>(m_updateinterval);
+    m_output = m_latest;
+    m_prev = m_latest;
+    broadcast();
+  }
+
+  /**
+   * Read the output of the command once it exited and schedule the next run
+   */
+  void script_module::read_exit() {
+    chrono::duration<double> next{m_interval};
+
+    remove_source(reactor::current());
+
+    try {
+      std::lock_guard<decltype(m_handler)> guard(m_handler);
+      if (!m_command) {
+        return;
+      }
+      m_command->wait();
+      next = read_output();
+    } catch (const exception& err) {
+      halt(err.what());
+      return;
+    }
+
+    if (!m_stopping) {
+      m_reactor.set_timer(m_timer, next);
+    }
+  }
+
+  /**
+   * Update the output from the finished command
+   *
+   * Returns the time until the next run
+   */
+  chrono::duration<double> script_module::read_output() {
+    int fd = m_command->get_stdout(PIPE_READ);
+    if (fd != -1 && io_util::poll_read(fd) && (m_output = m_command->readline()) != m_prev) {
       broadcast();
+      m_prev = m_output;
+    } else if (m_command->get_exit_status() != 0) {
       m_output.clear();
       m_prev.clear();
+      broadcast();
     }
-    return false;
+
+    return std::max(m_command->get_exit_status() == 0 ? m_interval : 1s, m_interval);
   }
 
   /**
@@ -164,9 +321,9 @@ namespace modules {
   /**
    * Generate module output
    */
-  string script_module::get_output() {
+  display_list script_module::get_output() {
     if (m_output.empty()) {
-      return "";
+      return {};
     }
 
     if (m_label) {
@@ -175,7 +332,7 @@ namespace modules {
     }
 
     string cnt{to_string(m_counter)};
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     for (auto btn : {mousebtn::LEFT, mousebtn::MIDDLE, mousebtn::RIGHT,
                      mousebtn::DOUBLE_LEFT, mousebtn::DOUBLE_MIDDLE,
@@ -19,11 +19,11 @@ namespace modules {
     return "content";
   }
 
-  string text_module::get_output() {
+  display_list text_module::get_output() {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapper
     // with the cmd handlers
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     auto click_left = m_conf.get(name(), "click-left", ""s);
     auto click_middle = m_conf.get(name(), "click-middle", ""s);
@@ -109,11 +109,11 @@ namespace modules {
   /**
    * Generate the module output
    */
-  string xbacklight_module::get_output() {
+  display_list xbacklight_module::get_output() {
     // Get the module output early so that
     // the format prefix/suffix also gets wrapped
     // with the cmd handlers
-    string output{module::get_output()};
+    display_list output{module::get_output()};
 
     if (m_scroll) {
       m_builder->cmd(mousebtn::SCROLL_UP, EVENT_SCROLLUP);
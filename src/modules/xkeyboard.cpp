@@ -168,8 +168,8 @@ namespace modules {
    * Build module output and wrap it in a click handler use
    * to cycle between configured layout groups
    */
-  string xkeyboard_module::get_output() {
-    string output{module::get_output()};
+  display_list xkeyboard_module::get_output() {
+    display_list output{module::get_output()};
 
     if (m_keyboard && m_keyboard->size() > 1) {
       m_builder->cmd(mousebtn::LEFT, EVENT_SWITCH);
@@ -309,13 +309,13 @@ namespace modules {
   /**
    * Generate module output
    */
-  string xworkspaces_module::get_output() {
+  display_list xworkspaces_module::get_output() {
     std::unique_lock<std::mutex> lock(m_workspace_mutex);
 
     // Get the module output early so that
     // the format prefix/suffix also gets wrapped
     // with the cmd handlers
-    string output;
+    display_list output;
     for (m_index = 0; m_index < m_viewports.size(); m_index++) {
       if (m_index > 0) {
         m_builder->space(m_formatter->get(DEFAULT_FORMAT)->spacing);
@@ -17,7 +17,7 @@ const char* const PATH_BACKLIGHT{"@SETTING_PATH_BACKLIGHT@"};
 const char* const PATH_BATTERY{"@SETTING_PATH_BATTERY@"};
 const char* const PATH_CPU_INFO{"@SETTING_PATH_CPU_INFO@"};
 const char* const PATH_MEMORY_INFO{"@SETTING_PATH_MEMORY_INFO@"};
-const char* const PATH_MESSAGING_FIFO{"@SETTING_PATH_MESSAGING_FIFO@"};
+const char* const PATH_MESSAGING_SOCKET{"@SETTING_PATH_MESSAGING_SOCKET@"};
 const char* const PATH_TEMPERATURE_INFO{"@SETTING_PATH_TEMPERATURE_INFO@"};
 const char* const WIRELESS_LIB{"@WIRELESS_LIB@"};
 
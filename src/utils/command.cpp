@@ -1,3 +1,4 @@
+#include <fcntl.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include <csignal>
@@ -10,13 +11,6 @@
 #include "utils/io.hpp"
 #include "utils/process.hpp"
 
-#ifndef STDOUT_FILENO
-#define STDOUT_FILENO 1
-#endif
-#ifndef STDERR_FILENO
-#define STDERR_FILENO 2
-#endif
-
 POLYBAR_NS
 
 command<output_policy::IGNORED>::command(const logger& logger, string cmd) : m_log(logger), m_cmd(move(cmd)) {}
@@ -25,28 +19,24 @@ command<output_policy::IGNORED>::~command() {
   if (is_running()) {
     terminate();
   }
+  if (m_pidfd != -1) {
+    close(m_pidfd);
+  }
 }
 
 /**
  * Execute the command
  */
 int command<output_policy::IGNORED>::exec(bool wait_for_completion) {
-  if ((m_forkpid = fork()) == -1) {
-    throw system_error("Failed to fork process");
-  }
+  m_forkpid = process_util::spawn(m_cmd);
 
-  if (process_util::in_forked_process(m_forkpid)) {
-    setpgid(m_forkpid, 0);
-    process_util::redirect_process_output_to_dev_null();
-    process_util::exec_sh(m_cmd.c_str());
-  } else {
-    if (wait_for_completion) {
-      auto status = wait();
-      m_forkpid = -1;
-      return status;
-    }
+  if (wait_for_completion) {
+    auto status = wait();
+    m_forkpid = -1;
+    return status;
   }
 
+  m_pidfd = process_util::open_pidfd(m_forkpid);
   return EXIT_SUCCESS;
 }
 
@@ -107,12 +97,22 @@ int command<output_policy::IGNORED>::get_exit_status() {
   return m_forkstatus;
 }
 
+/**
+ * Get a file descriptor that becomes readable once the command has exited
+ *
+ * Only available after exec(false), returns -1 if pidfds are not supported
+ */
+int command<output_policy::IGNORED>::get_pidfd() {
+  return m_pidfd;
+}
+
 command<output_policy::REDIRECTED>::command(const polybar::logger& logger, std::string cmd)
     : command<output_policy::IGNORED>(logger, move(cmd)) {
-  if (pipe(m_stdin) != 0) {
+  // The pipes are duplicated onto the standard streams of the child, no other process should inherit them
+  if (pipe2(m_stdin, O_CLOEXEC) != 0) {
     throw command_error("Failed to allocate input stream");
   }
-  if (pipe(m_stdout) != 0) {
+  if (pipe2(m_stdout, O_CLOEXEC) != 0) {
     throw command_error("Failed to allocate output stream");
   }
 }
@@ -136,53 +136,23 @@ command<output_policy::REDIRECTED>::~command() {
  * Execute the command
  */
 int command<output_policy::REDIRECTED>::exec(bool wait_for_completion) {
-  if ((m_forkpid = fork()) == -1) {
-    throw system_error("Failed to fork process");
-  }
-
-  if (process_util::in_forked_process(m_forkpid)) {
-    if (dup2(m_stdin[PIPE_READ], STDIN_FILENO) == -1) {
-      throw command_error("Failed to redirect stdin in child process");
-    }
-    if (dup2(m_stdout[PIPE_WRITE], STDOUT_FILENO) == -1) {
-      throw command_error("Failed to redirect stdout in child process");
-    }
-    if (dup2(m_stdout[PIPE_WRITE], STDERR_FILENO) == -1) {
-      throw command_error("Failed to redirect stderr in child process");
-    }
-
-    // Close file descriptors that won't be used by the child
-    if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1) {
-      throw command_error("Failed to close fd");
-    }
-    if ((m_stdin[PIPE_WRITE] = close(m_stdin[PIPE_WRITE])) == -1) {
-      throw command_error("Failed to close fd");
-    }
-    if ((m_stdout[PIPE_READ] = close(m_stdout[PIPE_READ])) == -1) {
-      throw command_error("Failed to close fd");
-    }
-    if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1) {
-      throw command_error("Failed to close fd");
-    }
+  m_forkpid = process_util::spawn(m_cmd, m_stdin[PIPE_READ], m_stdout[PIPE_WRITE]);
 
-    setpgid(m_forkpid, 0);
-    process_util::exec_sh(m_cmd.c_str());
-  } else {
-    // Close file descriptors that won't be used by the parent
-    if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1) {
-      throw command_error("Failed to close fd");
-    }
-    if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1) {
-      throw command_error("Failed to close fd");
-    }
+  // Close file descriptors that won't be used by the parent
+  if ((m_stdin[PIPE_READ] = close(m_stdin[PIPE_READ])) == -1) {
+    throw command_error("Failed to close fd");
+  }
+  if ((m_stdout[PIPE_WRITE] = close(m_stdout[PIPE_WRITE])) == -1) {
+    throw command_error("Failed to close fd");
+  }
 
-    if (wait_for_completion) {
-      auto status = wait();
-      m_forkpid = -1;
-      return status;
-    }
+  if (wait_for_completion) {
+    auto status = wait();
+    m_forkpid = -1;
+    return status;
   }
 
+  m_pidfd = process_util::open_pidfd(m_forkpid);
   return EXIT_SUCCESS;
 }
 
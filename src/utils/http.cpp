@@ -10,10 +10,14 @@
 
 POLYBAR_NS
 
-http_downloader::http_downloader(int connection_timeout) {
+/**
+ * Create a downloader, requests fail if they take longer than the timeout in seconds
+ */
+http_downloader::http_downloader(int connection_timeout, int timeout) {
   m_curl = curl_easy_init();
   curl_easy_setopt(m_curl, CURLOPT_ACCEPT_ENCODING, "deflate");
   curl_easy_setopt(m_curl, CURLOPT_CONNECTTIMEOUT, connection_timeout);
+  curl_easy_setopt(m_curl, CURLOPT_TIMEOUT, timeout);
   curl_easy_setopt(m_curl, CURLOPT_FOLLOWLOCATION, true);
   curl_easy_setopt(m_curl, CURLOPT_NOSIGNAL, true);
   curl_easy_setopt(m_curl, CURLOPT_USERAGENT, ("polybar/" + string{APP_VERSION}).c_str());
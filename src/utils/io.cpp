@@ -91,6 +91,93 @@ namespace io_util {
       throw system_error("Failed to set O_NONBLOCK");
     }
   }
+
+  /**
+   * Construct reader, the descriptor is switched to non-blocking mode
+   */
+  line_reader::line_reader(int fd) : m_fd(fd) {
+    set_nonblock(m_fd);
+  }
+
+  /**
+   * Read the available data
+   *
+   * Returns false once the end of the output is reached,
+   * an unterminated last line is then used as the latest line
+   */
+  bool line_reader::read() {
+    char buffer[BUFSIZ];
+
+    // Bounded, so a process that writes faster than we read can't keep us here
+    for (int i = 0; i < 16; i++) {
+      ssize_t bytes{::read(m_fd, buffer, sizeof(buffer))};
+
+      if (bytes > 0) {
+        append(buffer, bytes);
+      } else if (bytes == -1 && errno == EINTR) {
+        continue;
+      } else if (bytes == -1) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+      } else {
+        if (!m_partial.empty()) {
+          m_line.swap(m_partial);
+          m_partial.clear();
+          m_changed = true;
+        }
+        return false;
+      }
+
+      if (static_cast<size_t>(bytes) < sizeof(buffer)) {
+        break;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Move the latest complete line into the given string
+   *
+   * Returns false if no line was completed since the last call
+   */
+  bool line_reader::latest(string& line) {
+    if (!m_changed) {
+      return false;
+    }
+    line.swap(m_line);
+    m_changed = false;
+    return true;
+  }
+
+  void line_reader::append(const char* data, size_t size) {
+    const char* end{data + size};
+    const char* last{end};
+
+    while (last != data && *(last - 1) != '\n') {
+      last--;
+    }
+
+    if (last == data) {
+      m_partial.append(data, size);
+      return;
+    }
+
+    // Only the text between the last two newlines is of interest
+    const char* first{last - 1};
+    while (first != data && *(first - 1) != '\n') {
+      first--;
+    }
+
+    if (first == data) {
+      m_line.swap(m_partial);
+      m_line.append(data, last - 1);
+    } else {
+      m_line.assign(first, last - 1);
+    }
+
+    m_partial.assign(last, end);
+    m_changed = true;
+  }
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,245 @@
+#include "utils/proc.hpp"
+
+#include <cstring>
+
+POLYBAR_NS
+
+namespace proc_util {
+  namespace {
+    /**
+     * End of the line that starts at pos, without the newline
+     */
+    const char* line_end(const char* pos, const char* end) {
+      auto newline = static_cast<const char*>(memchr(pos, '\n', end - pos));
+      return newline ? newline : end;
+    }
+
+    /**
+     * Get the next space separated field of the line
+     */
+    bool next_field(const char*& pos, const char* end, field& f) {
+      while (pos != end && (*pos == ' ' || *pos == '\t')) {
+        pos++;
+      }
+      if (pos == end) {
+        return false;
+      }
+
+      f.data = pos;
+      while (pos != end && *pos != ' ' && *pos != '\t') {
+        pos++;
+      }
+      f.size = pos - f.data;
+      return true;
+    }
+
+    /**
+     * Parse the next unsigned number of the line
+     */
+    bool next_number(const char*& pos, const char* end, unsigned long long& value) {
+      while (pos != end && (*pos == ' ' || *pos == '\t')) {
+        pos++;
+      }
+      if (pos == end || *pos < '0' || *pos > '9') {
+        return false;
+      }
+
+      value = 0;
+      while (pos != end && *pos >= '0' && *pos <= '9') {
+        value = value * 10 + (*pos++ - '0');
+      }
+      return true;
+    }
+
+    struct meminfo_key {
+      const char* name;
+      size_t size;
+      unsigned long long meminfo::*value;
+    };
+
+#define MEMINFO_KEY(name, member) meminfo_key{name, sizeof(name) - 1, &meminfo::member}
+
+    const meminfo_key meminfo_keys[]{
+        MEMINFO_KEY("MemTotal", total),
+        MEMINFO_KEY("MemFree", free),
+        MEMINFO_KEY("MemAvailable", available),
+        MEMINFO_KEY("Buffers", buffers),
+        MEMINFO_KEY("Cached", cached),
+        MEMINFO_KEY("SReclaimable", sreclaimable),
+        MEMINFO_KEY("Shmem", shmem),
+        MEMINFO_KEY("SwapTotal", swap_total),
+        MEMINFO_KEY("SwapFree", swap_free),
+    };
+
+#undef MEMINFO_KEY
+  }  // namespace
+
+  bool field::operator==(const string& other) const {
+    return size == other.size() && memcmp(data, other.data(), size) == 0;
+  }
+
+  bool field::operator!=(const string& other) const {
+    return !(*this == other);
+  }
+
+  string field::str() const {
+    return {data, size};
+  }
+
+  /**
+   * Parse the times of each core from /proc/stat
+   *
+   * The line with the accumulated times of all cores is skipped
+   */
+  bool parse_stat(const string& data, vector<cpu_time>& cores) {
+    const char* pos{data.data()};
+    const char* end{pos + data.size()};
+
+    cores.clear();
+
+    // The cpu lines come first
+    while (pos != end && end - pos > 3 && memcmp(pos, "cpu", 3) == 0) {
+      const char* eol{line_end(pos, end)};
+      pos += 3;
+
+      if (*pos >= '0' && *pos <= '9') {
+        unsigned long long id{0};
+        unsigned long long values[8]{};
+        size_t count{0};
+
+        next_number(pos, eol, id);
+        while (count < 8 && next_number(pos, eol, values[count])) {
+          count++;
+        }
+
+        if (count < 4) {
+          return false;
+        }
+
+        cores.emplace_back();
+        auto& core = cores.back();
+        core.user = values[0];
+        core.nice = values[1];
+        core.system = values[2];
+        core.idle = values[3];
+        core.steal = values[7];
+        core.total = core.user + core.nice + core.system + core.idle + core.steal;
+      }
+
+      pos = eol == end ? end : eol + 1;
+    }
+
+    return !cores.empty();
+  }
+
+  /**
+   * Parse the values used by the memory module from /proc/meminfo
+   */
+  bool parse_meminfo(const string& data, meminfo& info) {
+    const char* pos{data.data()};
+    const char* end{pos + data.size()};
+
+    info = meminfo{};
+
+    while (pos != end) {
+      const char* eol{line_end(pos, end)};
+      auto colon = static_cast<const char*>(memchr(pos, ':', eol - pos));
+
+      if (colon) {
+        size_t size = colon - pos;
+        for (auto&& key : meminfo_keys) {
+          if (key.size == size && memcmp(key.name, pos, size) == 0) {
+            const char* value{colon + 1};
+            if (next_number(value, eol, info.*key.value) && key.value == &meminfo::available) {
+              info.has_available = true;
+            }
+            break;
+          }
+        }
+      }
+
+      pos = eol == end ? end : eol + 1;
+    }
+
+    return info.total != 0;
+  }
+
+  /**
+   * Sum up the bytes received and transmitted by all interfaces in /proc/net/dev
+   */
+  bool parse_net_dev(const string& data, unsigned long long& received, unsigned long long& transmitted) {
+    const char* pos{data.data()};
+    const char* end{pos + data.size()};
+    bool found{false};
+
+    received = 0;
+    transmitted = 0;
+
+    while (pos != end) {
+      const char* eol{line_end(pos, end)};
+      auto colon = static_cast<const char*>(memchr(pos, ':', eol - pos));
+
+      // The two header lines don't contain a colon
+      if (colon) {
+        const char* value{colon + 1};
+        unsigned long long values[9]{};
+        size_t count{0};
+
+        while (count < 9 && next_number(value, eol, values[count])) {
+          count++;
+        }
+
+        if (count == 9) {
+          received += values[0];
+          transmitted += values[8];
+          found = true;
+        }
+      }
+
+      pos = eol == end ? end : eol + 1;
+    }
+
+    return found;
+  }
+
+  mountinfo_parser::mountinfo_parser(const string& data) : m_pos(data.data()), m_end(data.data() + data.size()) {}
+
+  /**
+   * Parse the next entry, returns false once all entries are parsed
+   *
+   * Lines that don't match the format are skipped
+   */
+  bool mountinfo_parser::next(mount_entry& entry) {
+    while (m_pos != m_end) {
+      const char* pos{m_pos};
+      const char* eol{line_end(pos, m_end)};
+      m_pos = eol == m_end ? m_end : eol + 1;
+
+      // mount id, parent id, major:minor, root, mountpoint, mount options
+      field f;
+      int index{0};
+      for (; index < 6 && next_field(pos, eol, f); index++) {
+        if (index == 4) {
+          entry.mountpoint = f;
+        }
+      }
+      if (index < 6) {
+        continue;
+      }
+
+      // Optional fields, terminated by a single hyphen
+      bool separator{false};
+      while (!separator && next_field(pos, eol, f)) {
+        separator = f.size == 1 && *f.data == '-';
+      }
+
+      if (separator && next_field(pos, eol, entry.type) && next_field(pos, eol, entry.source)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+}  // namespace proc_util
+
+POLYBAR_NS_END
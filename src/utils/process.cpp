@@ -1,11 +1,16 @@
 #include "utils/process.hpp"
 
 #include <fcntl.h>
+#include <spawn.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <csignal>
+
 #include "errors.hpp"
 #include "utils/env.hpp"
+#include "utils/scope.hpp"
 #include "utils/string.hpp"
 
 POLYBAR_NS
@@ -59,6 +64,111 @@ namespace process_util {
     }
   }
 
+  /**
+   * Split a command into its arguments if it can be run without a shell
+   *
+   * Returns false if the command contains anything the shell would
+   * interpret, e.g. quotes, expansions, redirections or pipes
+   */
+  bool split_command(const string& cmd, vector<string>& args) {
+    static constexpr const char* metacharacters{"|&;<>()$`\\\"'*?[]{}#~=!\n"};
+
+    if (cmd.find_first_of(metacharacters) != string::npos) {
+      return false;
+    }
+
+    args = string_util::split(string_util::replace_all(cmd, "\t", " "), ' ');
+    return !args.empty();
+  }
+
+  /**
+   * Start the command in a new process group
+   *
+   * Commands without shell syntax are executed directly, everything else
+   * (and commands that can't be found, e.g. shell builtins) is passed to
+   * the shell. The process is created with posix_spawn, which doesn't
+   * copy the page tables of polybar like fork() does.
+   *
+   * \param stdin_fd Used as stdin of the process, inherited if -1
+   * \param stdout_fd Used as stdout and stderr of the process, /dev/null if -1
+   */
+  pid_t spawn(const string& cmd, int stdin_fd, int stdout_fd) {
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attr);
+
+    auto cleanup = scope_util::make_exit_handler<>([&] {
+      posix_spawn_file_actions_destroy(&actions);
+      posix_spawnattr_destroy(&attr);
+    });
+
+    if (stdin_fd != -1) {
+      posix_spawn_file_actions_adddup2(&actions, stdin_fd, STDIN_FILENO);
+    }
+    if (stdout_fd != -1) {
+      posix_spawn_file_actions_adddup2(&actions, stdout_fd, STDOUT_FILENO);
+      posix_spawn_file_actions_adddup2(&actions, stdout_fd, STDERR_FILENO);
+    } else {
+      posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+      posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    }
+
+    // Don't pass the signal setup of polybar on to the command
+    sigset_t mask;
+    sigemptyset(&mask);
+    posix_spawnattr_setsigmask(&attr, &mask);
+    for (auto&& sig : {SIGPIPE, SIGCHLD, SIGINT, SIGQUIT, SIGTERM, SIGHUP, SIGUSR1, SIGALRM}) {
+      sigaddset(&mask, sig);
+    }
+    posix_spawnattr_setsigdefault(&attr, &mask);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    const auto run = [&](const vector<string>& args) {
+      vector<char*> argv;
+      for (auto&& arg : args) {
+        argv.emplace_back(const_cast<char*>(arg.c_str()));
+      }
+      argv.emplace_back(nullptr);
+
+      pid_t pid{-1};
+      int err{posix_spawnp(&pid, argv[0], &actions, &attr, argv.data(), environ)};
+      return err == 0 ? pid : -err;
+    };
+
+    vector<string> args;
+    pid_t pid{-ENOENT};
+
+    if (split_command(cmd, args)) {
+      pid = run(args);
+    }
+    if (pid < 0) {
+      static const string shell{env_util::get("POLYBAR_SHELL", "/bin/sh")};
+      pid = run({shell, "-c", cmd});
+    }
+    if (pid < 0) {
+      errno = -pid;
+      throw system_error("Failed to spawn process");
+    }
+
+    return pid;
+  }
+
+  /**
+   * Get a file descriptor that becomes readable once the process has exited
+   *
+   * Returns -1 if pidfds are not supported by the kernel
+   */
+  int open_pidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+    (void)pid;
+    return -1;
+#endif
+  }
+
   /**
    * Wait for child process
    */
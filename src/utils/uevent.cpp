@@ -0,0 +1,124 @@
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "errors.hpp"
+#include "utils/uevent.hpp"
+
+POLYBAR_NS
+
+/**
+ * Get the value of the property, empty if the event doesn't have it
+ */
+string uevent::property(const string& key) const {
+  auto it = properties.find(key);
+  return it != properties.end() ? it->second : "";
+}
+
+/**
+ * Open the socket and subscribe to the kernel events
+ */
+uevent_socket::uevent_socket() {
+  if ((m_fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT)) == -1) {
+    throw system_error("Failed to open uevent socket");
+  }
+
+  // Group 1 carries the kernel events, group 2 the ones forwarded by udev
+  sockaddr_nl addr{};
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = 1;
+
+  if (bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+    close(m_fd);
+    throw system_error("Failed to subscribe to uevents");
+  }
+
+  m_buffer.resize(8192);
+}
+
+uevent_socket::~uevent_socket() {
+  close(m_fd);
+}
+
+/**
+ * Receive the next pending event without blocking
+ *
+ * Returns false if there are no more events. If the kernel dropped events
+ * because the socket buffer was full, returns true with an empty action
+ */
+bool uevent_socket::receive(uevent& event) {
+  while (true) {
+    sockaddr_nl addr{};
+    iovec iov{m_buffer.data(), m_buffer.size()};
+    msghdr msg{};
+    msg.msg_name = &addr;
+    msg.msg_namelen = sizeof(addr);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    ssize_t bytes{recvmsg(m_fd, &msg, 0)};
+
+    if (bytes == -1 && errno == EINTR) {
+      continue;
+    } else if (bytes == -1 && errno == ENOBUFS) {
+      event = uevent{};
+      return true;
+    } else if (bytes <= 0) {
+      return false;
+    } else if (addr.nl_pid != 0) {
+      // Only trust messages sent by the kernel
+      continue;
+    } else if (uevent_util::parse(m_buffer.data(), bytes, event)) {
+      return true;
+    }
+  }
+}
+
+int uevent_socket::get_file_descriptor() const {
+  return m_fd;
+}
+
+namespace uevent_util {
+  /**
+   * Parse a kernel event, "action@devpath" followed by KEY=VALUE pairs,
+   * all separated by null characters
+   */
+  bool parse(const char* data, size_t size, uevent& event) {
+    const char* pos{data};
+    const char* end{data + size};
+
+    event = uevent{};
+
+    auto next = [&] {
+      auto null = static_cast<const char*>(memchr(pos, '\0', end - pos));
+      const char* field{pos};
+      pos = null ? null + 1 : end;
+      return string{field, static_cast<size_t>((null ? null : end) - field)};
+    };
+
+    string header{next()};
+    size_t at{header.find('@')};
+
+    if (at == string::npos || at == 0) {
+      return false;
+    }
+
+    event.action = header.substr(0, at);
+    event.devpath = header.substr(at + 1);
+
+    while (pos != end) {
+      string property{next()};
+      size_t equals{property.find('=')};
+
+      if (equals != string::npos) {
+        event.properties.emplace(property.substr(0, equals), property.substr(equals + 1));
+      }
+    }
+
+    return true;
+  }
+}  // namespace uevent_util
+
+POLYBAR_NS_END
@@ -11,8 +11,11 @@
 
 POLYBAR_NS
 
-background_manager& background_manager::make() {
-  return *factory_util::singleton<background_manager>(connection::make(), signal_emitter::make(), logger::make());
+/**
+ * Create instance
+ */
+background_manager::make_type background_manager::make(connection& conn, signal_emitter& sig) {
+  return factory_util::unique<background_manager>(conn, sig, logger::make());
 }
 
 background_manager::background_manager(
@@ -25,7 +28,7 @@ background_manager::background_manager(
 
 background_manager::~background_manager() {
   m_sig.detach(this);
-  free_resources();
+  deactivate();
 }
 
 std::shared_ptr<bg_slice> background_manager::observe(xcb_rectangle_t rect, xcb_window_t window) {
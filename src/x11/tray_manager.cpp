@@ -39,12 +39,14 @@ POLYBAR_NS
 /**
  * Create instance
  */
-tray_manager::make_type tray_manager::make() {
-  return factory_util::unique<tray_manager>(connection::make(), signal_emitter::make(), logger::make(), background_manager::make());
+tray_manager::make_type tray_manager::make(
+    connection& conn, signal_emitter& emitter, const config& conf, background_manager& back) {
+  return factory_util::unique<tray_manager>(conn, emitter, logger::make(), conf, back);
 }
 
-tray_manager::tray_manager(connection& conn, signal_emitter& emitter, const logger& logger, background_manager& back)
-  : m_connection(conn), m_sig(emitter), m_log(logger), m_background_manager(back) {
+tray_manager::tray_manager(
+    connection& conn, signal_emitter& emitter, const logger& logger, const config& conf, background_manager& back)
+  : m_connection(conn), m_sig(emitter), m_log(logger), m_conf(conf), m_background_manager(back) {
   m_connection.attach_sink(this, SINK_PRIORITY_TRAY);
 }
 
@@ -57,12 +59,11 @@ tray_manager::~tray_manager() {
 }
 
 void tray_manager::setup(const bar_settings& bar_opts) {
-  const config& conf = config::make();
-  auto bs = conf.section();
+  auto bs = m_conf.section();
   string position;
 
   try {
-    position = conf.get(bs, "tray-position");
+    position = m_conf.get(bs, "tray-position");
   } catch (const key_error& err) {
     return m_log.info("Disabling tray manager (reason: missing `tray-position`)");
   }
@@ -79,7 +80,7 @@ void tray_manager::setup(const bar_settings& bar_opts) {
     return;
   }
 
-  m_opts.detached = conf.get(bs, "tray-detached", false);
+  m_opts.detached = m_conf.get(bs, "tray-detached", false);
   m_opts.height = bar_opts.size.h;
   m_opts.height -= bar_opts.borders.at(edge::BOTTOM).size;
   m_opts.height -= bar_opts.borders.at(edge::TOP).size;
@@ -89,7 +90,7 @@ void tray_manager::setup(const bar_settings& bar_opts) {
     m_opts.height--;
   }
 
-  auto maxsize = conf.get<unsigned int>(bs, "tray-maxsize", 16);
+  auto maxsize = m_conf.get<unsigned int>(bs, "tray-maxsize", 16);
   if (m_opts.height > maxsize) {
     m_opts.spacing += (m_opts.height - maxsize) / 2;
     m_opts.height = maxsize;
@@ -100,7 +101,7 @@ void tray_manager::setup(const bar_settings& bar_opts) {
   m_opts.orig_y = bar_opts.pos.y + bar_opts.borders.at(edge::TOP).size;
 
   // Apply user-defined scaling
-  auto scale = conf.get(bs, "tray-scale", 1.0);
+  auto scale = m_conf.get(bs, "tray-scale", 1.0);
   m_opts.width *= scale;
   m_opts.height_fill *= scale;
 
@@ -120,12 +121,12 @@ void tray_manager::setup(const bar_settings& bar_opts) {
       break;
   }
 
-  if (conf.has(bs, "tray-transparent")) {
+  if (m_conf.has(bs, "tray-transparent")) {
     m_log.warn("tray-transparent is deprecated, the tray always uses pseudo-transparency. Please remove it.");
   }
 
   // Set user-defined background color
-  auto bg = conf.get(bs, "tray-background", ""s);
+  auto bg = m_conf.get(bs, "tray-background", ""s);
 
   if (!bg.empty()) {
     m_opts.background = color_util::parse(bg);
@@ -139,11 +140,11 @@ void tray_manager::setup(const bar_settings& bar_opts) {
   }
 
   // Add user-defined padding
-  m_opts.spacing += conf.get<unsigned int>(bs, "tray-padding", 0);
+  m_opts.spacing += m_conf.get<unsigned int>(bs, "tray-padding", 0);
 
   // Add user-defiend offset
-  auto offset_x_def = conf.get(bs, "tray-offset-x", ""s);
-  auto offset_y_def = conf.get(bs, "tray-offset-y", ""s);
+  auto offset_x_def = m_conf.get(bs, "tray-offset-x", ""s);
+  auto offset_y_def = m_conf.get(bs, "tray-offset-y", ""s);
 
   auto offset_x = strtol(offset_x_def.c_str(), nullptr, 10);
   auto offset_y = strtol(offset_y_def.c_str(), nullptr, 10);
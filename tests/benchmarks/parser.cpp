@@ -0,0 +1,49 @@
+#include "common/bench.hpp"
+#include "components/display_list.hpp"
+#include "components/parser.hpp"
+#include "components/types.hpp"
+
+using namespace polybar;
+
+/**
+ * Builds a bar string made of `modules` formatted modules, similar to what
+ * the controller passes to the bar
+ */
+static string make_input(size_t modules) {
+  string data{"%{l}"};
+
+  for (size_t i = 0; i < modules; i++) {
+    if (i == modules / 3) {
+      data += "%{c}";
+    } else if (i == modules / 3 * 2) {
+      data += "%{r}";
+    }
+
+    data += "%{B#ff282a2e}%{F#ffc5c8c6}%{+u}%{u#ff0a81f5} ";
+    data += "%{A1:polybar-msg hook module " + to_string(i) + ":}%{A3:notify-send \\:right\\::}";
+    data += "module-" + to_string(i) + " %{T2}42%%{T-} ";
+    data += "%{A}%{A}%{-u}%{F-}%{B-}%{O10}";
+  }
+
+  return data;
+}
+
+int main() {
+  parser p;
+  display_list output;
+  bar_settings bar{};
+
+  for (size_t modules : {4, 16, 64, 256, 1024}) {
+    auto data = make_input(modules);
+    bench::run("parse/" + to_string(modules) + " modules (" + to_string(data.size()) + " bytes)",
+        [&] {
+          output.clear();
+          p.parse(bar, data, output);
+        },
+        data.size());
+  }
+
+  bench::do_not_optimize(output.size());
+
+  return 0;
+}
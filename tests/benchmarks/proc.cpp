@@ -0,0 +1,94 @@
+#include <map>
+#include <sstream>
+
+#include "common/bench.hpp"
+#include "utils/file.hpp"
+#include "utils/proc.hpp"
+#include "utils/string.hpp"
+
+using namespace polybar;
+using namespace proc_util;
+
+/**
+ * Line based parsing as done by the modules before, for comparison
+ */
+static size_t parse_stat_lines(const string& data) {
+  std::istringstream in(data);
+  vector<unique_ptr<cpu_time>> cores;
+  string line;
+
+  while (std::getline(in, line) && line.compare(0, 3, "cpu") == 0) {
+    if (line.compare(0, 4, "cpu ") == 0) {
+      continue;
+    }
+    auto values = string_util::split(line, ' ');
+    cores.emplace_back(new cpu_time);
+    cores.back()->user = std::stoull(values[1], nullptr, 10);
+    cores.back()->idle = std::stoull(values[4], nullptr, 10);
+  }
+  return cores.size();
+}
+
+static size_t parse_meminfo_lines(const string& data) {
+  std::istringstream in(data);
+  std::map<string, unsigned long long> parsed;
+  string line;
+
+  while (std::getline(in, line)) {
+    size_t sep = line.find(':');
+    size_t value = line.find_first_of("123456789", sep);
+    if (sep != string::npos && value != string::npos) {
+      parsed[line.substr(0, sep)] = std::strtoull(&line[value], nullptr, 10);
+    }
+  }
+  return parsed["MemTotal"];
+}
+
+static size_t parse_mountinfo_lines(const string& data) {
+  std::istringstream in(data);
+  vector<vector<string>> mounts;
+  string line;
+
+  while (std::getline(in, line)) {
+    mounts.emplace_back(string_util::split(line, ' '));
+  }
+  return mounts.size();
+}
+
+/**
+ * Parses procfs fixtures of a 128 core host with 2000 overlay mounts
+ */
+int main() {
+  auto stat = file_util::contents(FIXTURES_DIR "/proc/stat");
+  auto meminfo = file_util::contents(FIXTURES_DIR "/proc/meminfo");
+  auto mountinfo = file_util::contents(FIXTURES_DIR "/proc/mountinfo");
+
+  size_t lines{0};
+  bench::run("lines/stat", [&] { lines += parse_stat_lines(stat); }, stat.size());
+  bench::run("lines/meminfo", [&] { lines += parse_meminfo_lines(meminfo); }, meminfo.size());
+  bench::run("lines/mountinfo", [&] { lines += parse_mountinfo_lines(mountinfo); }, mountinfo.size());
+
+  vector<cpu_time> cores;
+  bench::run("parse_stat/128 cores", [&] { parse_stat(stat, cores); }, stat.size());
+
+  proc_util::meminfo info;
+  bench::run("parse_meminfo", [&] { parse_meminfo(meminfo, info); }, meminfo.size());
+
+  size_t mounts{0};
+  bench::run("mountinfo_parser/2014 mounts",
+      [&] {
+        mountinfo_parser parser(mountinfo);
+        mount_entry entry;
+        while (parser.next(entry)) {
+          mounts++;
+        }
+      },
+      mountinfo.size());
+
+  bench::do_not_optimize(lines);
+  bench::do_not_optimize(cores.size());
+  bench::do_not_optimize(info.total);
+  bench::do_not_optimize(mounts);
+
+  return 0;
+}
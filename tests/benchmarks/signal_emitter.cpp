@@ -0,0 +1,84 @@
+#include "common/bench.hpp"
+#include "events/signal.hpp"
+#include "events/signal_emitter.hpp"
+#include "events/signal_receiver.hpp"
+
+using namespace polybar;
+
+/**
+ * Receiver listening to a few signals, similar to the bar components
+ */
+template <int Priority>
+class receiver : public signal_receiver<Priority, signals::ui::tick, signals::ui::changed,
+                     signals::eventqueue::notify_change, signals::ipc::hook> {
+ public:
+  bool on(const signals::ui::tick&) override {
+    count++;
+    return false;
+  }
+  bool on(const signals::ui::changed&) override {
+    count++;
+    return false;
+  }
+  bool on(const signals::eventqueue::notify_change&) override {
+    count++;
+    return true;
+  }
+  bool on(const signals::ipc::hook& evt) override {
+    count += evt.cast().size();
+    return false;
+  }
+
+  size_t count{0};
+};
+
+int main() {
+  static constexpr size_t signals_per_iteration{1000};
+
+  auto& sig = signal_emitter::make();
+  receiver<1> r1;
+  receiver<2> r2;
+  receiver<3> r3;
+  receiver<4> r4;
+  receiver<5> r5;
+
+  sig.attach(&r1);
+  sig.attach(&r2);
+  sig.attach(&r3);
+  sig.attach(&r4);
+  sig.attach(&r5);
+
+  bench::run("emit/tick (5 receivers)", [&] {
+    for (size_t i = 0; i < signals_per_iteration; i++) {
+      sig.emit(signals::ui::tick{});
+    }
+  });
+
+  bench::run("emit/notify_change (5 receivers, handled)", [&] {
+    for (size_t i = 0; i < signals_per_iteration; i++) {
+      sig.emit(signals::eventqueue::notify_change{});
+    }
+  });
+
+  bench::run("emit/hook (5 receivers, string payload)", [&] {
+    for (size_t i = 0; i < signals_per_iteration; i++) {
+      sig.emit(signals::ipc::hook{"hook"});
+    }
+  });
+
+  bench::run("emit/unattached signal", [&] {
+    for (size_t i = 0; i < signals_per_iteration; i++) {
+      sig.emit(signals::ui::shade_window{});
+    }
+  });
+
+  bench::do_not_optimize(r1.count + r2.count + r3.count + r4.count + r5.count);
+
+  sig.detach(&r1);
+  sig.detach(&r2);
+  sig.detach(&r3);
+  sig.detach(&r4);
+  sig.detach(&r5);
+
+  return 0;
+}
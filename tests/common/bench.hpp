@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+/**
+ * Minimal benchmark harness
+ *
+ * Runs the given function repeatedly until at least `min_duration` has
+ * passed and reports the mean time per iteration
+ */
+namespace bench {
+  using clock = std::chrono::steady_clock;
+
+  /**
+   * Prevent the compiler from optimizing away the given value
+   */
+  template <typename T>
+  inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+  }
+
+  inline double run(const std::string& name, const std::function<void()>& fn, size_t bytes = 0,
+      std::chrono::milliseconds min_duration = std::chrono::milliseconds{500}) {
+    // Warm up
+    fn();
+
+    size_t iterations{0};
+    auto start = clock::now();
+    auto elapsed = clock::duration::zero();
+
+    do {
+      fn();
+      iterations++;
+      elapsed = clock::now() - start;
+    } while (elapsed < min_duration);
+
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+
+    if (bytes) {
+      std::printf("%-40s %12.0f ns/iter %10.1f MB/s %10zu iterations\n", name.c_str(), ns, bytes / ns * 1e3, iterations);
+    } else {
+      std::printf("%-40s %12.0f ns/iter %10zu iterations\n", name.c_str(), ns, iterations);
+    }
+
+    return ns;
+  }
+}
@@ -1,3 +1,19 @@
 #pragma once
 
+#include <chrono>
+#include <thread>
+
 #include "gtest/gtest.h"
+
+namespace test_util {
+  /**
+   * Wait until the predicate holds or a second has passed
+   */
+  template <typename Predicate>
+  inline bool wait_for(Predicate pred) {
+    for (int i = 0; i < 1000 && !pred(); i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    return pred();
+  }
+}  // namespace test_util
@@ -0,0 +1,56 @@
+#include "adapters/net.hpp"
+
+#include <cstdlib>
+
+#include "common/test.hpp"
+
+using namespace polybar;
+
+class Network : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Creating a network interface needs CAP_NET_ADMIN
+    if (system("ip link add pbtest0 type veth peer name pbtest1 2>/dev/null") != 0) {
+      GTEST_SKIP() << "Can't create network interfaces";
+    }
+    m_created = true;
+  }
+
+  void TearDown() override {
+    if (m_created) {
+      system("ip link del pbtest0 2>/dev/null");
+    }
+  }
+
+  static void recreate() {
+    ASSERT_EQ(0, system("ip link del pbtest0 && ip link add pbtest0 type veth peer name pbtest1"));
+  }
+
+  bool m_created{false};
+};
+
+TEST_F(Network, recreatedInterface) {
+  net::wired_network network{"pbtest0"};
+  EXPECT_TRUE(network.query());
+
+  recreate();
+
+  // The new index is picked up from the link announcement
+  EXPECT_TRUE(network.process_events());
+  EXPECT_TRUE(network.query());
+  EXPECT_TRUE(network.query());
+}
+
+TEST_F(Network, removedInterface) {
+  net::wired_network network{"pbtest0"};
+  EXPECT_TRUE(network.query());
+
+  ASSERT_EQ(0, system("ip link del pbtest0"));
+  EXPECT_TRUE(network.process_events());
+  EXPECT_FALSE(network.query());
+
+  // The request for the old index fails, the interface is looked up again by its name
+  ASSERT_EQ(0, system("ip link add pbtest0 type veth peer name pbtest1"));
+  EXPECT_TRUE(network.query());
+  EXPECT_TRUE(network.query());
+}
@@ -0,0 +1,121 @@
+#include "adapters/probe.hpp"
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "common/test.hpp"
+
+using namespace polybar;
+using namespace std::chrono_literals;
+
+/**
+ * Wait for the probe like the reactor would
+ */
+static bool wait(net::probe& p) {
+  while (!p.process()) {
+    pollfd pfd{p.get_file_descriptor(), static_cast<short>(p.get_events()), 0};
+    poll(&pfd, 1, 100);
+  }
+  p.close();
+  return p.online();
+}
+
+class Probe : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    m_listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_NE(-1, m_listener);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len{sizeof(addr)};
+
+    ASSERT_EQ(0, bind(m_listener, reinterpret_cast<sockaddr*>(&addr), len));
+    ASSERT_EQ(0, listen(m_listener, 4));
+    ASSERT_EQ(0, getsockname(m_listener, reinterpret_cast<sockaddr*>(&addr), &len));
+    m_port = ntohs(addr.sin_port);
+  }
+
+  void TearDown() override {
+    close(m_listener);
+  }
+
+  int m_listener{-1};
+  unsigned short m_port{0};
+};
+
+TEST_F(Probe, tcp) {
+  net::probe p{"127.0.0.1", m_port, "", 2s, 0s};
+
+  EXPECT_FALSE(p.online());
+  EXPECT_TRUE(p.start());
+  EXPECT_TRUE(p.running());
+  EXPECT_NE(-1, p.get_file_descriptor());
+  EXPECT_TRUE(wait(p));
+  EXPECT_FALSE(p.running());
+  EXPECT_EQ(-1, p.get_file_descriptor());
+}
+
+TEST_F(Probe, tcpRefused) {
+  close(m_listener);
+  m_listener = -1;
+
+  // The host answered, even though nothing listens on the port
+  net::probe p{"127.0.0.1", m_port, "", 2s, 0s};
+  if (p.start()) {
+    EXPECT_TRUE(wait(p));
+  } else {
+    EXPECT_TRUE(p.online());
+  }
+}
+
+TEST_F(Probe, cached) {
+  net::probe p{"127.0.0.1", m_port, "", 2s, 1h};
+
+  EXPECT_TRUE(p.start());
+  EXPECT_TRUE(wait(p));
+
+  // Still valid, no new probe
+  EXPECT_FALSE(p.start());
+  EXPECT_FALSE(p.running());
+  EXPECT_TRUE(p.online());
+
+  p.invalidate();
+  EXPECT_TRUE(p.start());
+  EXPECT_TRUE(wait(p));
+}
+
+TEST_F(Probe, hostName) {
+  // Looking up the name would block
+  EXPECT_THROW((net::probe{"localhost", 80, "", 2s, 0s}), net::probe_error);
+  EXPECT_THROW((net::probe{"", 80, "", 2s, 0s}), net::probe_error);
+  EXPECT_NO_THROW((net::probe{"::1", 80, "", 2s, 0s}));
+}
+
+TEST_F(Probe, timeout) {
+  // TEST-NET-1 address that never answers, unless there is no route at all
+  net::probe p{"192.0.2.1", 80, "", 0s, 0s};
+
+  if (p.start()) {
+    EXPECT_TRUE(p.process());
+    EXPECT_TRUE(p.running());
+    p.close();
+  }
+  EXPECT_FALSE(p.running());
+  EXPECT_FALSE(p.online());
+}
+
+TEST_F(Probe, icmp) {
+  net::probe p{"127.0.0.1", 0, "", 2s, 0s};
+
+  try {
+    ASSERT_TRUE(p.start());
+  } catch (const net::probe_error&) {
+    GTEST_SKIP() << "Unprivileged ICMP sockets are not permitted";
+  }
+
+  EXPECT_TRUE(wait(p));
+}
@@ -0,0 +1,54 @@
+#include "cairo/utils.hpp"
+#include "common/test.hpp"
+
+using namespace polybar;
+using namespace cairo;
+
+TEST(Utf8ToUcs4, offsets) {
+  utils::unicode_charlist chars;
+  EXPECT_TRUE(utils::utf8_to_ucs4((const unsigned char*)"a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80", chars));
+
+  ASSERT_EQ(4, chars.size());
+  EXPECT_EQ(0x61, chars[0].codepoint);
+  EXPECT_EQ(0xe9, chars[1].codepoint);
+  EXPECT_EQ(0x20ac, chars[2].codepoint);
+  EXPECT_EQ(0x1f600, chars[3].codepoint);
+  EXPECT_EQ(6, chars[3].offset);
+  EXPECT_EQ(4, chars[3].length);
+}
+
+TEST(UnicodeCoverage, add) {
+  utils::unicode_coverage coverage;
+  EXPECT_TRUE(coverage.empty());
+  EXPECT_FALSE(coverage.has(0x61));
+
+  coverage.add(0x61);
+  coverage.add(0x1f600);
+
+  EXPECT_FALSE(coverage.empty());
+  EXPECT_TRUE(coverage.has(0x61));
+  EXPECT_FALSE(coverage.has(0x62));
+  EXPECT_TRUE(coverage.has(0x1f600));
+  EXPECT_FALSE(coverage.has(0x2f600));
+  EXPECT_FALSE(coverage.has(0x110000));
+}
+
+TEST(UnicodeCoverage, charset) {
+  auto charset = FcCharSetCreate();
+  FcCharSetAddChar(charset, 0x20);
+  FcCharSetAddChar(charset, 0x3f);
+  FcCharSetAddChar(charset, 0xe000);
+  FcCharSetAddChar(charset, 0x10ffff);
+
+  utils::unicode_coverage coverage;
+  coverage.add(charset);
+  FcCharSetDestroy(charset);
+
+  EXPECT_TRUE(coverage.has(0x20));
+  EXPECT_TRUE(coverage.has(0x3f));
+  EXPECT_TRUE(coverage.has(0xe000));
+  EXPECT_TRUE(coverage.has(0x10ffff));
+  EXPECT_FALSE(coverage.has(0x21));
+  EXPECT_FALSE(coverage.has(0x40));
+  EXPECT_FALSE(coverage.has(0xe001));
+}
@@ -0,0 +1,52 @@
+#include "common/test.hpp"
+#include "components/builder.hpp"
+
+using namespace polybar;
+
+class Builder : public ::testing::Test {
+ protected:
+  bar_settings m_bar{};
+  builder m_builder{m_bar};
+};
+
+TEST_F(Builder, closesOpenTags) {
+  m_builder.node("a");
+  m_builder.color("#f00");
+  m_builder.font(2);
+  m_builder.node("b");
+
+  EXPECT_EQ("a%{F#ffff0000}%{T2}b%{F-}%{T-}", m_builder.flush().to_string());
+  EXPECT_TRUE(m_builder.flush().empty());
+}
+
+TEST_F(Builder, cmd) {
+  m_builder.cmd(mousebtn::RIGHT, "echo a:b");
+  m_builder.node("x");
+
+  auto output = m_builder.flush();
+  auto action = output.begin();
+
+  EXPECT_EQ(display_op::ACTION_BEGIN, action->op);
+  EXPECT_EQ("echo a:b", output.str(*action));
+  EXPECT_EQ("%{A3:echo a\\:b:}x%{A}", output.to_string());
+}
+
+TEST_F(Builder, rawTags) {
+  m_builder.node("%{F#f00}a%{F-} %{A1:x:}");
+  m_builder.node("b");
+  m_builder.append("%{A}");
+
+  EXPECT_EQ("%{F#ffff0000}a%{F-} %{A1:x:}b%{A}", m_builder.flush().to_string());
+}
+
+TEST_F(Builder, removeTrailingSpace) {
+  m_builder.node("a");
+  m_builder.space(2);
+  m_builder.remove_trailing_space(2);
+  m_builder.underline("#fff");
+  m_builder.space(1);
+  m_builder.remove_trailing_space(1);
+  m_builder.underline_close();
+
+  EXPECT_EQ("a%{u#ffffffff}%{+u}%{-u}%{u-}", m_builder.flush().to_string());
+}
@@ -0,0 +1,73 @@
+#include "common/test.hpp"
+#include "components/display_list.hpp"
+
+using namespace polybar;
+
+TEST(DisplayList, textRunsAreJoined) {
+  display_list list;
+  list.text("ab");
+  list.text(2, ' ');
+  list.text("cd");
+
+  EXPECT_EQ(1, list.size());
+  EXPECT_EQ("ab  cd", list.str(*list.begin()));
+}
+
+TEST(DisplayList, append) {
+  display_list a;
+  a.text("a");
+
+  display_list b;
+  b.text("b");
+  b.action_begin(mousebtn::LEFT, "cmd");
+  b.text("c");
+  b.action_end();
+
+  a += b;
+
+  EXPECT_EQ(4, a.size());
+  EXPECT_EQ("ab%{A1:cmd:}c%{A}", a.to_string());
+}
+
+TEST(DisplayList, removeTrailing) {
+  display_list list;
+  list.text("a  ");
+
+  EXPECT_FALSE(list.remove_trailing(3, ' '));
+  EXPECT_TRUE(list.remove_trailing(2, ' '));
+  EXPECT_EQ("a", list.to_string());
+
+  list.font(2);
+  list.text(1, ' ');
+  EXPECT_TRUE(list.remove_trailing(1, ' '));
+  EXPECT_FALSE(list.remove_trailing(1, ' '));
+  EXPECT_EQ("a%{T2}", list.to_string());
+}
+
+TEST(DisplayList, equality) {
+  display_list a;
+  display_list b;
+  a.color(display_op::FOREGROUND, 0xffff0000);
+  a.text("a");
+  b.color(display_op::FOREGROUND, 0xffff0000);
+  b.text("a");
+
+  EXPECT_EQ(a, b);
+
+  b.text("b");
+  EXPECT_NE(a, b);
+}
+
+TEST(DisplayList, toString) {
+  display_list list;
+  list.align(alignment::RIGHT);
+  list.color(display_op::BACKGROUND, 0xff000000, true);
+  list.color(display_op::UNDERLINE, 0x80ffffff);
+  list.attr(display_op::ATTRIBUTE_SET, attribute::UNDERLINE);
+  list.attr(display_op::ATTRIBUTE_TOGGLE, attribute::OVERLINE);
+  list.offset(-3);
+  list.reverse();
+  list.control(controltag::R);
+
+  EXPECT_EQ("%{r}%{B-}%{u#80ffffff}%{+u}%{!o}%{O-3}%{R}%{PR}", list.to_string());
+}
@@ -0,0 +1,150 @@
+#include "components/ipc.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "common/test.hpp"
+#include "components/logger.hpp"
+#include "events/signal.hpp"
+#include "events/signal_emitter.hpp"
+#include "events/signal_receiver.hpp"
+
+using namespace polybar;
+
+class receiver : public signal_receiver<0, signals::ipc::command, signals::ipc::hook, signals::ipc::stats> {
+ public:
+  bool on(const signals::ipc::command& evt) override {
+    commands.emplace_back(evt.cast());
+    return evt.cast() != "invalid";
+  }
+  bool on(const signals::ipc::hook& evt) override {
+    hooks.emplace_back(evt.cast());
+    return true;
+  }
+  bool on(const signals::ipc::stats& evt) override {
+    evt.cast()->snapshot = "{}";
+    return true;
+  }
+
+  vector<string> commands;
+  vector<string> hooks;
+};
+
+class Ipc : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    m_sig.attach(&m_receiver);
+  }
+
+  void TearDown() override {
+    m_sig.detach(&m_receiver);
+    for (auto&& fd : m_clients) {
+      close(fd);
+    }
+  }
+
+  int connect_client() {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", m_path.c_str());
+
+    int fd{socket(AF_UNIX, SOCK_SEQPACKET, 0)};
+    EXPECT_EQ(0, connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)));
+    m_clients.emplace_back(fd);
+    return fd;
+  }
+
+  /**
+   * Send the request and run the server until the reply has arrived
+   */
+  string request(int fd, const string& data) {
+    EXPECT_EQ(static_cast<ssize_t>(data.size()), send(fd, data.data(), data.size(), 0));
+
+    char buffer[BUFSIZ];
+    for (int i = 0; i < 100; i++) {
+      m_ipc.receive_message();
+      ssize_t bytes{recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)};
+      if (bytes > 0) {
+        return string{buffer, static_cast<size_t>(bytes)};
+      }
+    }
+    return "";
+  }
+
+  signal_emitter& m_sig{signal_emitter::make()};
+  receiver m_receiver;
+  string m_path{"/tmp/polybar_ipc_test." + to_string(getpid())};
+  ipc m_ipc{m_sig, logger::make(), "example", m_path};
+  vector<int> m_clients;
+};
+
+TEST_F(Ipc, reply) {
+  int fd{connect_client()};
+
+  EXPECT_EQ("ok", request(fd, "cmd:toggle"));
+  EXPECT_EQ("error:not handled", request(fd, "cmd:invalid"));
+  EXPECT_EQ("error:unknown message type", request(fd, "foo:bar"));
+  EXPECT_EQ("ok:{}", request(fd, "stats"));
+  EXPECT_EQ(vector<string>({"toggle", "invalid"}), m_receiver.commands);
+}
+
+TEST_F(Ipc, batch) {
+  int fd{connect_client()};
+
+  EXPECT_EQ("ok\nok\nok", request(fd, "hook:module/a1\nhook:module/b2\ncmd:hide\n"));
+  EXPECT_EQ(vector<string>({"module/a1", "module/b2"}), m_receiver.hooks);
+  EXPECT_EQ(vector<string>({"hide"}), m_receiver.commands);
+}
+
+TEST_F(Ipc, barName) {
+  int fd{connect_client()};
+
+  EXPECT_EQ("skip", request(fd, "bar:other\ncmd:hide"));
+  EXPECT_EQ("ok", request(fd, "bar:example\ncmd:show"));
+  EXPECT_EQ(vector<string>({"show"}), m_receiver.commands);
+}
+
+TEST_F(Ipc, severalBars) {
+  signal_emitter first_sig{};
+  signal_emitter second_sig{};
+  receiver first;
+  receiver second;
+  first_sig.attach(&first);
+  second_sig.attach(&second);
+
+  m_ipc.add_bar("example", first_sig);
+  m_ipc.add_bar("other", second_sig);
+  int fd{connect_client()};
+
+  EXPECT_EQ("ok\nok", request(fd, "bar:other\ncmd:hide\nhook:module/a1"));
+  EXPECT_EQ("ok", request(fd, "cmd:show"));
+  EXPECT_EQ("ok:{}", request(fd, "stats"));
+  EXPECT_EQ("skip", request(fd, "bar:unknown\ncmd:show"));
+
+  // Commands reach the addressed bar or all of them, hooks go to the modules
+  EXPECT_EQ(vector<string>({"show"}), first.commands);
+  EXPECT_EQ(vector<string>({"hide", "show"}), second.commands);
+  EXPECT_EQ(vector<string>({"module/a1"}), m_receiver.hooks);
+  EXPECT_TRUE(m_receiver.commands.empty());
+  EXPECT_TRUE(first.hooks.empty() && second.hooks.empty());
+
+  first_sig.detach(&first);
+  second_sig.detach(&second);
+}
+
+TEST_F(Ipc, concurrentClients) {
+  int a{connect_client()};
+  int b{connect_client()};
+
+  // Requests of separate clients are never merged
+  ASSERT_EQ(7, send(a, "hook:a1", 7, 0));
+  ASSERT_EQ(7, send(b, "hook:b1", 7, 0));
+  EXPECT_EQ("ok", request(a, "hook:a2"));
+  EXPECT_EQ("ok", request(b, "hook:b2"));
+
+  std::sort(m_receiver.hooks.begin(), m_receiver.hooks.end());
+  EXPECT_EQ(vector<string>({"a1", "a2", "b1", "b2"}), m_receiver.hooks);
+}
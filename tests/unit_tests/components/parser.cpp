@@ -1,6 +1,7 @@
 #include "common/test.hpp"
-#include "events/signal_emitter.hpp"
+#include "components/display_list.hpp"
 #include "components/parser.hpp"
+#include "components/types.hpp"
 
 using namespace polybar;
 
@@ -11,7 +12,7 @@ class TestableParser : public parser {
 
 class Parser : public ::testing::Test {
   protected:
-    TestableParser m_parser{signal_emitter::make()};
+    TestableParser m_parser{};
 };
 /**
  * The first element of the pair is the expected return text, the second element
@@ -35,3 +36,38 @@ TEST_P(ParseActionCmd, correctness) {
   auto result = m_parser.parse_action_cmd(std::move(input));
   EXPECT_EQ(GetParam().first, result);
 }
+
+/**
+ * \brief Class for parameterized tests on parse
+ *
+ * The first element of the pair is the expected display list in the tag
+ * syntax, the second element is the input to parse
+ */
+class ParseDisplayList : public Parser, public ::testing::WithParamInterface<pair<string, string>> {
+ protected:
+  bar_settings m_bar{};
+};
+
+vector<pair<string, string>> parse_display_list_list = {
+    {"abc def", "abc def"},
+    {"a%{F#ffff0000}%{O-5}b%{+u}c", "a%{F#ff0000 O-5}b%{+u}c"},
+    {"%{F#ff00ff00}a%{F-}%{T2}b%{T-}", "%{F#0f0}a%{F-}%{T2}b%{T-}"},
+    {"%{A1:cmd\\:a:}%{A3:b:}x%{A3}%{A1}", "%{A1:cmd\\:a: A3:b:}x%{A A}"},
+    {"%{A1:a:}x%{A1}", "%{A:a:}x%{A}"},
+    {"x%{A}", "x%{A}"},
+    {"%{l}a%{c}b%{r}c", "%{l}a%{c}b%{r}c"},
+    {"a%{F#fff", "a%{F#fff"},
+};
+
+INSTANTIATE_TEST_SUITE_P(Inst, ParseDisplayList, ::testing::ValuesIn(parse_display_list_list));
+
+TEST_P(ParseDisplayList, correctness) {
+  display_list output;
+  m_parser.parse(m_bar, GetParam().second, output);
+  EXPECT_EQ(GetParam().first, output.to_string());
+}
+
+TEST_F(Parser, unrecognizedToken) {
+  display_list output;
+  EXPECT_THROW(m_parser.parse(bar_settings{}, "%{Z}", output), unrecognized_token);
+}
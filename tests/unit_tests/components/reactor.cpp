@@ -0,0 +1,165 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "common/test.hpp"
+#include "components/logger.hpp"
+#include "components/reactor.hpp"
+
+using namespace polybar;
+using test_util::wait_for;
+
+class Reactor : public ::testing::Test {
+ protected:
+  reactor m_reactor{logger::make(), 2};
+};
+
+TEST_F(Reactor, timer) {
+  std::atomic<int> count{0};
+  auto handle = m_reactor.add_timer(0s, 5ms, [&] { count++; });
+
+  EXPECT_TRUE(wait_for([&] { return count >= 3; }));
+
+  m_reactor.remove(handle);
+  int stopped{count};
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(stopped, count);
+}
+
+TEST_F(Reactor, oneshotTimer) {
+  std::atomic<int> count{0};
+  auto handle = m_reactor.add_timer(0s, 0s, [&] { count++; });
+
+  EXPECT_TRUE(wait_for([&] { return count == 1; }));
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(1, count);
+
+  m_reactor.set_timer(handle, 1ms);
+  EXPECT_TRUE(wait_for([&] { return count == 2; }));
+
+  m_reactor.remove(handle);
+}
+
+TEST_F(Reactor, trigger) {
+  std::atomic<int> count{0};
+  auto handle = m_reactor.add_timer(1h, 0s, [&] { count++; });
+
+  m_reactor.trigger(handle);
+  EXPECT_TRUE(wait_for([&] { return count == 1; }));
+
+  m_reactor.remove(handle);
+}
+
+TEST_F(Reactor, fd) {
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+
+  std::atomic<int> bytes{0};
+  auto handle = m_reactor.add_fd(fds[0], [&] {
+    char buf[16];
+    bytes += read(fds[0], buf, sizeof(buf));
+  });
+
+  ASSERT_EQ(3, write(fds[1], "abc", 3));
+  EXPECT_TRUE(wait_for([&] { return bytes == 3; }));
+  ASSERT_EQ(2, write(fds[1], "de", 2));
+  EXPECT_TRUE(wait_for([&] { return bytes == 5; }));
+
+  m_reactor.remove(handle);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST_F(Reactor, noConcurrentCallbacks) {
+  std::atomic<int> running{0};
+  std::atomic<int> overlaps{0};
+  std::atomic<int> count{0};
+
+  auto handle = m_reactor.add_timer(0s, 1ms, [&] {
+    if (running++) {
+      overlaps++;
+    }
+    std::this_thread::sleep_for(3ms);
+    running--;
+    count++;
+  });
+
+  for (int i = 0; i < 10; i++) {
+    m_reactor.trigger(handle);
+  }
+
+  EXPECT_TRUE(wait_for([&] { return count >= 5; }));
+  m_reactor.remove(handle);
+  EXPECT_EQ(0, overlaps);
+  EXPECT_EQ(0, running);
+}
+
+TEST_F(Reactor, removeFromCallback) {
+  std::atomic<int> count{0};
+  std::atomic<reactor::handle_t> handle{0};
+
+  handle = m_reactor.add_timer(10ms, 1ms, [&] {
+    count++;
+    m_reactor.remove(handle);
+  });
+
+  EXPECT_TRUE(wait_for([&] { return count == 1; }));
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(1, count);
+}
+
+TEST_F(Reactor, blockingSources) {
+  std::atomic<bool> release{false};
+  std::atomic<int> blocked{0};
+  std::atomic<int> count{0};
+  vector<reactor::handle_t> handles;
+
+  // More blocking callbacks than shared workers
+  for (int i = 0; i < 4; i++) {
+    handles.emplace_back(m_reactor.add_timer(1h, 0s, [&] {
+      blocked++;
+      while (!release) {
+        std::this_thread::sleep_for(1ms);
+      }
+    }));
+    m_reactor.set_blocking(handles.back());
+    m_reactor.trigger(handles.back());
+  }
+
+  EXPECT_TRUE(wait_for([&] { return blocked == 4; }));
+
+  auto handle = m_reactor.add_timer(0s, 1ms, [&] { count++; });
+  EXPECT_TRUE(wait_for([&] { return count >= 3; }));
+
+  release = true;
+  m_reactor.remove(handle);
+  for (auto&& h : handles) {
+    m_reactor.remove(h);
+  }
+}
+
+TEST_F(Reactor, alignedTimer) {
+  std::mutex lock;
+  vector<long> offsets;
+  auto handle = m_reactor.add_aligned_timer(50ms, [&] {
+    auto now = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch());
+    std::lock_guard<std::mutex> guard(lock);
+    offsets.push_back((now % 50ms).count());
+  });
+
+  EXPECT_TRUE(wait_for([&] {
+    std::lock_guard<std::mutex> guard(lock);
+    return offsets.size() >= 5;
+  }));
+  m_reactor.remove(handle);
+
+  // Single firings may be delayed by the scheduler, but most of them have
+  // to land shortly after a boundary of the wall clock
+  std::lock_guard<std::mutex> guard(lock);
+  ASSERT_LE(5U, offsets.size());
+  std::sort(offsets.begin(), offsets.end());
+  EXPECT_GT(25000, offsets[offsets.size() / 2]);
+}
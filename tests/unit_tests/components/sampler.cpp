@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+#include "common/test.hpp"
+#include "components/sampler.hpp"
+#include "errors.hpp"
+
+using namespace polybar;
+using namespace std::chrono_literals;
+
+class Sampler : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char path[] = "/tmp/polybar_sampler.XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(-1, fd);
+    close(fd);
+    m_path = path;
+  }
+
+  void TearDown() override {
+    remove(m_path.c_str());
+  }
+
+  void write(const string& contents) {
+    std::ofstream out(m_path, std::ios::trunc);
+    out << contents;
+  }
+
+  string m_path;
+  sampler m_sampler{};
+};
+
+TEST_F(Sampler, sharedFile) {
+  auto a = m_sampler.open(m_path);
+  auto b = m_sampler.open(m_path);
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(m_path, a->path());
+}
+
+TEST_F(Sampler, missingFile) {
+  EXPECT_THROW(m_sampler.open(m_path + ".missing"), system_error);
+}
+
+TEST_F(Sampler, reread) {
+  auto file = m_sampler.open(m_path);
+
+  write("first");
+  EXPECT_EQ("first", file->read()->data);
+
+  write("second value");
+  EXPECT_EQ("second value", file->read()->data);
+
+  write("");
+  EXPECT_EQ("", file->read()->data);
+}
+
+TEST_F(Sampler, maxAge) {
+  auto file = m_sampler.open(m_path);
+
+  write("first");
+  auto a = file->read(1h);
+  write("second");
+  auto b = file->read(1h);
+
+  EXPECT_EQ(a, b);
+  EXPECT_EQ("first", b->data);
+  EXPECT_EQ("second", file->read()->data);
+}
+
+TEST_F(Sampler, immutableSnapshot) {
+  auto file = m_sampler.open(m_path);
+
+  write("first");
+  auto held = file->read();
+  write("second");
+  auto next = file->read();
+
+  EXPECT_NE(held, next);
+  EXPECT_EQ("first", held->data);
+  EXPECT_EQ("second", next->data);
+}
+
+TEST_F(Sampler, largeFile) {
+  auto file = m_sampler.open(m_path);
+
+  string contents;
+  for (int i = 0; i < 10000; i++) {
+    contents += "cpu" + to_string(i) + " 1 2 3 4 5 6 7 8 9 10\n";
+  }
+  write(contents);
+
+  EXPECT_EQ(contents, file->read()->data);
+  EXPECT_EQ(contents, file->read()->data);
+}
+
+TEST_F(Sampler, removedDevice) {
+  // Creating a network interface needs CAP_NET_ADMIN
+  if (system("ip link add pbtest0 type veth peer name pbtest1 2>/dev/null") != 0) {
+    GTEST_SKIP() << "Can't create network interfaces";
+  }
+
+  auto file = m_sampler.open("/sys/class/net/pbtest0/statistics/rx_bytes");
+  EXPECT_EQ("0\n", file->read()->data);
+
+  // The open attribute of a removed device fails with ENODEV, the new one is read instead
+  EXPECT_EQ(0, system("ip link del pbtest0 && ip link add pbtest0 type veth peer name pbtest1"));
+  EXPECT_EQ("0\n", file->read()->data);
+
+  EXPECT_EQ(0, system("ip link del pbtest0"));
+  EXPECT_THROW(file->read(), system_error);
+}
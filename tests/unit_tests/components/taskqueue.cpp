@@ -0,0 +1,89 @@
+#include <atomic>
+#include <thread>
+
+#include "common/test.hpp"
+#include "components/taskqueue.hpp"
+
+using namespace polybar;
+using test_util::wait_for;
+
+class TaskQueue : public ::testing::Test {
+ protected:
+  taskqueue m_queue;
+};
+
+TEST_F(TaskQueue, defer) {
+  std::atomic<int> count{0};
+  m_queue.defer("task", 5ms, [&](size_t remaining) {
+    EXPECT_EQ(0, remaining);
+    count++;
+  });
+
+  EXPECT_TRUE(m_queue.exist("task"));
+  EXPECT_TRUE(wait_for([&] { return count == 1; }));
+  EXPECT_FALSE(m_queue.exist("task"));
+}
+
+TEST_F(TaskQueue, repeat) {
+  std::atomic<int> count{0};
+  std::atomic<size_t> last{99};
+  m_queue.defer("task", 1ms, [&](size_t remaining) {
+    last = remaining;
+    count++;
+  }, 0ms, 3);
+
+  EXPECT_TRUE(wait_for([&] { return count == 3; }));
+  EXPECT_EQ(0, last);
+  std::this_thread::sleep_for(10ms);
+  EXPECT_EQ(3, count);
+  EXPECT_FALSE(m_queue.exist("task"));
+}
+
+TEST_F(TaskQueue, order) {
+  std::mutex lock;
+  vector<string> order;
+  const auto add = [&](string id) {
+    std::lock_guard<std::mutex> guard(lock);
+    order.emplace_back(move(id));
+  };
+
+  m_queue.defer("late", 30ms, [&](size_t) { add("late"); });
+  m_queue.defer("early", 5ms, [&](size_t) { add("early"); });
+
+  EXPECT_TRUE(wait_for([&] { return !m_queue.exist("late"); }));
+  std::lock_guard<std::mutex> guard(lock);
+  EXPECT_EQ((vector<string>{"early", "late"}), order);
+}
+
+TEST_F(TaskQueue, purge) {
+  std::atomic<int> count{0};
+  m_queue.defer("task", 10ms, [&](size_t) { count++; });
+  m_queue.defer("task", 10ms, [&](size_t) { count++; });
+
+  EXPECT_TRUE(m_queue.purge("task"));
+  EXPECT_FALSE(m_queue.exist("task"));
+  EXPECT_FALSE(m_queue.purge("task"));
+
+  std::this_thread::sleep_for(30ms);
+  EXPECT_EQ(0, count);
+}
+
+TEST_F(TaskQueue, deferUnique) {
+  std::atomic<int> first{0};
+  std::atomic<int> second{0};
+  m_queue.defer_unique("task", 10ms, [&](size_t) { first++; });
+  m_queue.defer_unique("task", 1ms, [&](size_t) { second++; });
+
+  EXPECT_TRUE(wait_for([&] { return second == 1; }));
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(0, first);
+}
+
+TEST_F(TaskQueue, deferFromCallback) {
+  std::atomic<int> count{0};
+  m_queue.defer("outer", 1ms, [&](size_t) {
+    m_queue.defer("inner", 1ms, [&](size_t) { count++; });
+  });
+
+  EXPECT_TRUE(wait_for([&] { return count == 1; }));
+}
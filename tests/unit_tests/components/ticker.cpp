@@ -0,0 +1,87 @@
+#include <atomic>
+#include <thread>
+
+#include "common/test.hpp"
+#include "components/logger.hpp"
+#include "components/ticker.hpp"
+#include "events/signal.hpp"
+#include "events/signal_emitter.hpp"
+#include "events/signal_receiver.hpp"
+
+using namespace polybar;
+using test_util::wait_for;
+
+class change_receiver : public signal_receiver<0, signals::eventqueue::notify_change> {
+ public:
+  bool on(const signals::eventqueue::notify_change&) override {
+    count++;
+    return false;
+  }
+
+  std::atomic<int> count{0};
+};
+
+class Ticker : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    m_sig.attach(&m_receiver);
+  }
+
+  void TearDown() override {
+    m_sig.detach(&m_receiver);
+  }
+
+  reactor m_reactor{logger::make(), 2};
+  signal_emitter m_sig{};
+  change_receiver m_receiver;
+  ticker m_ticker{m_reactor, m_sig};
+};
+
+TEST_F(Ticker, notifiesOncePerTick) {
+  std::atomic<int> a{0};
+  std::atomic<int> b{0};
+
+  auto ha = m_ticker.add(20ms, [&] { return ++a > 0; });
+  auto hb = m_ticker.add(20ms, [&] { return ++b > 0; });
+
+  EXPECT_TRUE(wait_for([&] { return a >= 3; }));
+  m_ticker.remove(ha);
+  m_ticker.remove(hb);
+
+  // Both callbacks run on the same tick
+  EXPECT_LE(std::abs(a - b), 1);
+  EXPECT_LE(m_receiver.count, std::max<int>(a, b));
+  EXPECT_GE(m_receiver.count, std::min<int>(a, b));
+}
+
+TEST_F(Ticker, unchanged) {
+  std::atomic<int> count{0};
+  auto handle = m_ticker.add(5ms, [&] {
+    count++;
+    return false;
+  });
+
+  EXPECT_TRUE(wait_for([&] { return count >= 2; }));
+  m_ticker.remove(handle);
+  EXPECT_EQ(0, m_receiver.count);
+}
+
+TEST_F(Ticker, removeFromCallback) {
+  std::atomic<int> count{0};
+  std::atomic<ticker::handle_t> handle{0};
+
+  handle = m_ticker.add(5ms, [&] {
+    if (handle) {
+      count++;
+      m_ticker.remove(handle);
+    }
+    return false;
+  });
+
+  EXPECT_TRUE(wait_for([&] { return count == 1; }));
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(1, count);
+
+  // Removing it again is a no-op
+  m_ticker.remove(handle);
+}
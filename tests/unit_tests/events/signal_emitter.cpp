@@ -0,0 +1,116 @@
+#include "common/test.hpp"
+#include "events/signal.hpp"
+#include "events/signal_emitter.hpp"
+#include "events/signal_receiver.hpp"
+
+using namespace polybar;
+
+static vector<int> calls;
+
+template <int Priority, bool Handled = false>
+class receiver : public signal_receiver<Priority, signals::ui::tick, signals::ipc::hook> {
+ public:
+  bool on(const signals::ui::tick&) override {
+    calls.push_back(Priority);
+    return Handled;
+  }
+  bool on(const signals::ipc::hook& evt) override {
+    hook = evt.cast();
+    return true;
+  }
+
+  string hook;
+};
+
+class SignalEmitter : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    calls.clear();
+  }
+
+  signal_emitter& m_sig{signal_emitter::make()};
+};
+
+TEST_F(SignalEmitter, priorityOrder) {
+  receiver<3> r3;
+  receiver<1> r1;
+  receiver<2> r2;
+  receiver<1> r1b;
+
+  m_sig.attach(&r3);
+  m_sig.attach(&r1);
+  m_sig.attach(&r2);
+  m_sig.attach(&r1b);
+
+  EXPECT_FALSE(m_sig.emit(signals::ui::tick{}));
+  EXPECT_EQ(vector<int>({1, 1, 2, 3}), calls);
+
+  m_sig.detach(&r1);
+  m_sig.detach(&r1b);
+  m_sig.detach(&r2);
+  m_sig.detach(&r3);
+}
+
+TEST_F(SignalEmitter, handledReachesAll) {
+  receiver<1> r1;
+  receiver<2, true> r2;
+  receiver<3> r3;
+
+  m_sig.attach(&r1);
+  m_sig.attach(&r2);
+  m_sig.attach(&r3);
+
+  EXPECT_TRUE(m_sig.emit(signals::ui::tick{}));
+  EXPECT_EQ(vector<int>({1, 2, 3}), calls);
+
+  m_sig.detach(&r1);
+  m_sig.detach(&r2);
+  m_sig.detach(&r3);
+}
+
+TEST_F(SignalEmitter, detach) {
+  receiver<1> r1;
+  receiver<2> r2;
+
+  m_sig.attach(&r1);
+  m_sig.attach(&r2);
+  m_sig.detach(&r1);
+
+  EXPECT_FALSE(m_sig.emit(signals::ui::tick{}));
+  EXPECT_EQ(vector<int>({2}), calls);
+
+  m_sig.detach(&r2);
+
+  EXPECT_FALSE(m_sig.emit(signals::ui::tick{}));
+  EXPECT_EQ(vector<int>({2}), calls);
+}
+
+TEST_F(SignalEmitter, separateEmitters) {
+  signal_emitter other;
+  receiver<1, true> r1;
+  receiver<2, true> r2;
+
+  m_sig.attach(&r1);
+  other.attach(&r2);
+
+  EXPECT_TRUE(m_sig.emit(signals::ui::tick{}));
+  EXPECT_EQ(vector<int>({1}), calls);
+
+  EXPECT_TRUE(other.emit(signals::ui::tick{}));
+  EXPECT_EQ(vector<int>({1, 2}), calls);
+
+  m_sig.detach(&r1);
+  other.detach(&r2);
+}
+
+TEST_F(SignalEmitter, value) {
+  receiver<1> r1;
+
+  m_sig.attach(&r1);
+
+  EXPECT_TRUE(m_sig.emit(signals::ipc::hook{"hook:module/foo1"}));
+  EXPECT_EQ("hook:module/foo1", r1.hook);
+  EXPECT_FALSE(m_sig.emit(signals::ipc::command{"quit"}));
+
+  m_sig.detach(&r1);
+}
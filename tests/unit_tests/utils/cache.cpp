@@ -0,0 +1,44 @@
+#include "common/test.hpp"
+#include "utils/cache.hpp"
+
+using namespace polybar;
+
+TEST(LruCache, findAndInsert) {
+  lru_cache<string, int> cache{2};
+
+  EXPECT_EQ(nullptr, cache.find(1));
+
+  cache.insert(1, "one");
+  ASSERT_NE(nullptr, cache.find(1));
+  EXPECT_EQ("one", *cache.find(1));
+
+  cache.insert(1, "uno");
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ("uno", *cache.find(1));
+}
+
+TEST(LruCache, evictsLeastRecentlyUsed) {
+  lru_cache<string, int> cache{2};
+
+  cache.insert(1, "one");
+  cache.insert(2, "two");
+
+  // Mark 1 as recently used so that 2 is evicted
+  cache.find(1);
+  cache.insert(3, "three");
+
+  EXPECT_EQ(2, cache.size());
+  EXPECT_NE(nullptr, cache.find(1));
+  EXPECT_EQ(nullptr, cache.find(2));
+  EXPECT_NE(nullptr, cache.find(3));
+}
+
+TEST(LruCache, clear) {
+  lru_cache<string, int> cache{2};
+
+  cache.insert(1, "one");
+  cache.clear();
+
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(nullptr, cache.find(1));
+}
@@ -1,6 +1,9 @@
 #include "utils/command.hpp"
 #include "common/test.hpp"
+#include "utils/process.hpp"
 
+#include <poll.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 using namespace polybar;
@@ -55,3 +58,50 @@ TEST(Command, readline) {
 
   EXPECT_EQ(str, "polybar");
 }
+
+TEST(Command, splitCommand) {
+  vector<string> args;
+
+  EXPECT_TRUE(process_util::split_command("notify-send  -t 100\tpolybar", args));
+  EXPECT_EQ(vector<string>({"notify-send", "-t", "100", "polybar"}), args);
+
+  EXPECT_FALSE(process_util::split_command("echo $HOME", args));
+  EXPECT_FALSE(process_util::split_command("echo a | cat", args));
+  EXPECT_FALSE(process_util::split_command("echo 'a b'", args));
+  EXPECT_FALSE(process_util::split_command("FOO=bar env", args));
+  EXPECT_FALSE(process_util::split_command("", args));
+}
+
+TEST(Command, withoutShell) {
+  auto cmd = command_util::make_command<output_policy::REDIRECTED>("echo polybar   bar");
+  EXPECT_EQ(EXIT_SUCCESS, cmd->exec());
+  EXPECT_EQ("polybar bar", cmd->readline());
+}
+
+TEST(Command, shellBuiltin) {
+  // Not found as an executable, the shell runs it instead
+  auto cmd = command_util::make_command<output_policy::IGNORED>("exit 3");
+  int status = cmd->exec();
+
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(3, WEXITSTATUS(status));
+}
+
+TEST(Command, pidfd) {
+  auto cmd = command_util::make_command<output_policy::IGNORED>("sleep 0.05");
+  cmd->exec(false);
+
+  int fd = cmd->get_pidfd();
+  if (fd == -1) {
+    // Not supported by the kernel
+    cmd->wait();
+    return;
+  }
+
+  pollfd pfd{fd, POLLIN, 0};
+  EXPECT_EQ(0, poll(&pfd, 1, 0));
+  EXPECT_EQ(1, poll(&pfd, 1, 5000));
+
+  cmd->wait();
+  EXPECT_EQ(EXIT_SUCCESS, cmd->get_exit_status());
+}
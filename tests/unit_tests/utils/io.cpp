@@ -0,0 +1,105 @@
+#include "utils/io.hpp"
+#include "common/test.hpp"
+
+#include <unistd.h>
+
+using namespace polybar;
+
+class LineReader : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(0, pipe(fds));
+  }
+
+  void TearDown() override {
+    close(fds[0]);
+    if (fds[1] != -1) {
+      close(fds[1]);
+    }
+  }
+
+  void write(const string& data) {
+    ASSERT_EQ(static_cast<ssize_t>(data.size()), ::write(fds[1], data.data(), data.size()));
+  }
+
+  void close_writer() {
+    close(fds[1]);
+    fds[1] = -1;
+  }
+
+  int fds[2];
+};
+
+TEST_F(LineReader, empty) {
+  io_util::line_reader reader(fds[0]);
+  string line;
+
+  EXPECT_TRUE(reader.read());
+  EXPECT_FALSE(reader.latest(line));
+}
+
+TEST_F(LineReader, latest) {
+  io_util::line_reader reader(fds[0]);
+  string line;
+
+  write("first\nsecond\nthird\n");
+  EXPECT_TRUE(reader.read());
+  EXPECT_TRUE(reader.latest(line));
+  EXPECT_EQ("third", line);
+  EXPECT_FALSE(reader.latest(line));
+  EXPECT_EQ("third", line);
+}
+
+TEST_F(LineReader, partial) {
+  io_util::line_reader reader(fds[0]);
+  string line;
+
+  write("first\nsec");
+  EXPECT_TRUE(reader.read());
+  EXPECT_TRUE(reader.latest(line));
+  EXPECT_EQ("first", line);
+
+  write("ond");
+  EXPECT_TRUE(reader.read());
+  EXPECT_FALSE(reader.latest(line));
+
+  write("\nthi");
+  EXPECT_TRUE(reader.read());
+  EXPECT_TRUE(reader.latest(line));
+  EXPECT_EQ("second", line);
+
+  // The unterminated line is used once the output is closed
+  write("rd");
+  close_writer();
+  while (reader.read()) {
+  }
+  EXPECT_TRUE(reader.latest(line));
+  EXPECT_EQ("third", line);
+}
+
+TEST_F(LineReader, emptyLine) {
+  io_util::line_reader reader(fds[0]);
+  string line{"previous"};
+
+  write("first\n\n");
+  EXPECT_TRUE(reader.read());
+  EXPECT_TRUE(reader.latest(line));
+  EXPECT_EQ("", line);
+}
+
+TEST_F(LineReader, largeOutput) {
+  io_util::line_reader reader(fds[0]);
+  string line;
+
+  string data;
+  for (int i = 0; i < 1000; i++) {
+    data += "line " + to_string(i) + "\n";
+  }
+  write(data);
+  close_writer();
+
+  while (reader.read()) {
+  }
+  EXPECT_TRUE(reader.latest(line));
+  EXPECT_EQ("line 999", line);
+}
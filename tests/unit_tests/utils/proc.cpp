@@ -0,0 +1,161 @@
+#include "utils/proc.hpp"
+#include "common/test.hpp"
+#include "utils/file.hpp"
+
+using namespace polybar;
+using namespace proc_util;
+
+TEST(Proc, parseStat) {
+  vector<cpu_time> cores;
+
+  string data{
+      "cpu  30 2 20 400 5 0 1 8 0 0\n"
+      "cpu0 10 1 5 100 2 0 1 3 0 0\n"
+      "cpu1 20 1 15 300 3 0 0 5 0 0\n"
+      "intr 12345 0 0\n"
+      "ctxt 123\n"};
+
+  EXPECT_TRUE(parse_stat(data, cores));
+  ASSERT_EQ(2, cores.size());
+  EXPECT_EQ(10, cores[0].user);
+  EXPECT_EQ(1, cores[0].nice);
+  EXPECT_EQ(5, cores[0].system);
+  EXPECT_EQ(100, cores[0].idle);
+  EXPECT_EQ(3, cores[0].steal);
+  EXPECT_EQ(119, cores[0].total);
+  EXPECT_EQ(341, cores[1].total);
+}
+
+TEST(Proc, parseStatOldKernel) {
+  vector<cpu_time> cores;
+
+  // Kernels before 2.6.11 don't report the steal time
+  EXPECT_TRUE(parse_stat("cpu 1 2 3 4\ncpu0 1 2 3 4", cores));
+  ASSERT_EQ(1, cores.size());
+  EXPECT_EQ(0, cores[0].steal);
+  EXPECT_EQ(10, cores[0].total);
+}
+
+TEST(Proc, parseStatInvalid) {
+  vector<cpu_time> cores;
+
+  EXPECT_FALSE(parse_stat("", cores));
+  EXPECT_FALSE(parse_stat("intr 1 2 3\n", cores));
+  EXPECT_FALSE(parse_stat("cpu0 1 2\n", cores));
+}
+
+TEST(Proc, parseStatReusesVector) {
+  vector<cpu_time> cores;
+  auto data = file_util::contents(FIXTURES_DIR "/proc/stat");
+
+  EXPECT_TRUE(parse_stat(data, cores));
+  EXPECT_EQ(128, cores.size());
+
+  auto capacity = cores.capacity();
+  auto storage = cores.data();
+  EXPECT_TRUE(parse_stat(data, cores));
+  EXPECT_EQ(capacity, cores.capacity());
+  EXPECT_EQ(storage, cores.data());
+}
+
+TEST(Proc, parseMeminfo) {
+  meminfo info;
+
+  string data{
+      "MemTotal:       16318004 kB\n"
+      "MemFree:         8123456 kB\n"
+      "MemAvailable:   12345678 kB\n"
+      "Buffers:          123456 kB\n"
+      "Cached:          2345678 kB\n"
+      "SwapCached:            0 kB\n"
+      "Shmem:             98765 kB\n"
+      "SReclaimable:     234567 kB\n"
+      "SwapTotal:       2097148 kB\n"
+      "SwapFree:        2000000 kB\n"};
+
+  EXPECT_TRUE(parse_meminfo(data, info));
+  EXPECT_EQ(16318004, info.total);
+  EXPECT_EQ(8123456, info.free);
+  EXPECT_EQ(12345678, info.available);
+  EXPECT_TRUE(info.has_available);
+  EXPECT_EQ(123456, info.buffers);
+  EXPECT_EQ(2345678, info.cached);
+  EXPECT_EQ(98765, info.shmem);
+  EXPECT_EQ(234567, info.sreclaimable);
+  EXPECT_EQ(2097148, info.swap_total);
+  EXPECT_EQ(2000000, info.swap_free);
+}
+
+TEST(Proc, parseMeminfoOldKernel) {
+  meminfo info;
+
+  EXPECT_TRUE(parse_meminfo("MemTotal: 1000 kB\nMemFree: 500 kB\n", info));
+  EXPECT_FALSE(info.has_available);
+  EXPECT_EQ(0, info.available);
+
+  EXPECT_FALSE(parse_meminfo("", info));
+}
+
+TEST(Proc, parseNetDev) {
+  string data{
+      "Inter-|   Receive                                                |  Transmit\n"
+      " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+      "    lo:  123456     100    0    0    0     0          0         0   123456     100    0    0    0     0       0          0\n"
+      "  eth0:4294967296 5000    0    0    0     0          0        12 1000000    4000    0    0    0     0       0          0\n"};
+
+  unsigned long long received{0};
+  unsigned long long transmitted{0};
+
+  EXPECT_TRUE(parse_net_dev(data, received, transmitted));
+  EXPECT_EQ(4294967296ULL + 123456, received);
+  EXPECT_EQ(1000000ULL + 123456, transmitted);
+
+  EXPECT_FALSE(parse_net_dev("Inter-|   Receive\n face |bytes\n", received, transmitted));
+  EXPECT_EQ(0, received);
+  EXPECT_EQ(0, transmitted);
+}
+
+TEST(Proc, mountinfo) {
+  string data{
+      "28 1 259:2 / / rw,relatime shared:1 - ext4 /dev/nvme0n1p2 rw\n"
+      "41 28 8:17 / /mnt/backup\\040disk rw,relatime shared:32 master:3 - ext4 /dev/sdb1 rw\n"
+      "invalid line\n"
+      "42 28 0:32 / /mnt/nfs rw,relatime - nfs4 server:/export rw,vers=4.2"};
+
+  mountinfo_parser parser(data);
+  mount_entry entry;
+
+  ASSERT_TRUE(parser.next(entry));
+  EXPECT_EQ("/", entry.mountpoint.str());
+  EXPECT_EQ("ext4", entry.type.str());
+  EXPECT_EQ("/dev/nvme0n1p2", entry.source.str());
+
+  ASSERT_TRUE(parser.next(entry));
+  EXPECT_TRUE(entry.mountpoint == "/mnt/backup\\040disk");
+  EXPECT_EQ("/dev/sdb1", entry.source.str());
+
+  ASSERT_TRUE(parser.next(entry));
+  EXPECT_TRUE(entry.mountpoint == "/mnt/nfs");
+  EXPECT_TRUE(entry.type == "nfs4");
+  EXPECT_TRUE(entry.source != "/dev/sdb1");
+
+  EXPECT_FALSE(parser.next(entry));
+}
+
+TEST(Proc, mountinfoFixture) {
+  auto data = file_util::contents(FIXTURES_DIR "/proc/mountinfo");
+  mountinfo_parser parser(data);
+  mount_entry entry;
+
+  size_t count{0};
+  size_t overlays{0};
+  while (parser.next(entry)) {
+    count++;
+    if (entry.type == "overlay") {
+      overlays++;
+    }
+  }
+
+  EXPECT_EQ(2014, count);
+  EXPECT_EQ(2000, overlays);
+}
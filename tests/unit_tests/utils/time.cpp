@@ -0,0 +1,43 @@
+#include <thread>
+
+#include "common/test.hpp"
+#include "utils/time.hpp"
+
+using namespace polybar;
+using namespace std::chrono_literals;
+
+TEST(Time, stopwatchWallTime) {
+  std::atomic<uint64_t> counter{0};
+  {
+    time_util::stopwatch watch{counter};
+    std::this_thread::sleep_for(10ms);
+  }
+  EXPECT_LE(10000000U, counter);
+
+  uint64_t first{counter};
+  {
+    time_util::stopwatch watch{counter};
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_LE(first + 1000000U, counter);
+}
+
+TEST(Time, stopwatchCpuTime) {
+  std::atomic<uint64_t> counter{0};
+  {
+    time_util::stopwatch watch{counter, true};
+    std::this_thread::sleep_for(20ms);
+  }
+  // Sleeping doesn't use any CPU time
+  EXPECT_GT(10000000U, counter);
+
+  volatile uint64_t sum{0};
+  {
+    time_util::stopwatch watch{counter, true};
+    auto start = time_util::thread_cputime();
+    while (time_util::thread_cputime() - start < 5ms) {
+      sum = sum + 1;
+    }
+  }
+  EXPECT_LE(5000000U, counter);
+}
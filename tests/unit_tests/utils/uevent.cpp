@@ -0,0 +1,65 @@
+#include "utils/uevent.hpp"
+
+#include "common/test.hpp"
+#include "errors.hpp"
+
+using namespace polybar;
+
+TEST(Uevent, parse) {
+  string data{
+      "change@/devices/LNXSYSTM:00/LNXSYBUS:00/ACPI0003:00/power_supply/AC\0"
+      "ACTION=change\0"
+      "DEVPATH=/devices/LNXSYSTM:00/LNXSYBUS:00/ACPI0003:00/power_supply/AC\0"
+      "SUBSYSTEM=power_supply\0"
+      "POWER_SUPPLY_NAME=AC\0"
+      "POWER_SUPPLY_ONLINE=1\0"
+      "SEQNUM=4242\0"s};
+
+  uevent event;
+  EXPECT_TRUE(uevent_util::parse(data.data(), data.size(), event));
+  EXPECT_EQ("change", event.action);
+  EXPECT_EQ("/devices/LNXSYSTM:00/LNXSYBUS:00/ACPI0003:00/power_supply/AC", event.devpath);
+  EXPECT_EQ("power_supply", event.property("SUBSYSTEM"));
+  EXPECT_EQ("AC", event.property("POWER_SUPPLY_NAME"));
+  EXPECT_EQ("1", event.property("POWER_SUPPLY_ONLINE"));
+  EXPECT_EQ("", event.property("DEVNAME"));
+}
+
+TEST(Uevent, parseWithoutTrailingNull) {
+  string data{"add@/module/foo\0SUBSYSTEM=module"s};
+
+  uevent event;
+  EXPECT_TRUE(uevent_util::parse(data.data(), data.size(), event));
+  EXPECT_EQ("add", event.action);
+  EXPECT_EQ("/module/foo", event.devpath);
+  EXPECT_EQ("module", event.property("SUBSYSTEM"));
+}
+
+TEST(Uevent, parseInvalid) {
+  uevent event;
+  event.action = "stale";
+
+  // Messages forwarded by udev start with a "libudev" header
+  string data{"libudev\0\xfe\xed\xca\xfe"s};
+  EXPECT_FALSE(uevent_util::parse(data.data(), data.size(), event));
+  EXPECT_EQ("", event.action);
+
+  EXPECT_FALSE(uevent_util::parse("", 0, event));
+  EXPECT_FALSE(uevent_util::parse("@/devices\0", 10, event));
+}
+
+TEST(Uevent, socket) {
+  unique_ptr<uevent_socket> socket;
+
+  try {
+    socket = uevent_util::make_socket();
+  } catch (const system_error&) {
+    GTEST_SKIP() << "Kernel events are not available";
+  }
+
+  // Nothing pending, doesn't block
+  uevent event;
+  EXPECT_NE(-1, socket->get_file_descriptor());
+  while (socket->receive(event)) {
+  }
+}